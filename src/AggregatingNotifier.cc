@@ -0,0 +1,213 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "AggregatingNotifier.h"
+
+#include "foreach.h"
+
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// FNV-1a, so that hashes in the state file stay valid across builds
+boost::uint64_t textHash(const std::string& text)
+{
+    boost::uint64_t h = 14695981039346656037ULL;
+    foreach(const char c, text) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// keys for the station in messages like "[stationid=180 AND ...]" and
+// Redistribution's "HQC: station=180 date_to=..."
+const char* const STATION_KEYS[] = { "stationid=", "station=", 0 };
+
+} // anonymous namespace
+
+// ========================================================================
+
+AggregatingNotifier::AggregatingNotifier(Notifier* target, int maxRepeats, const std::string& stateFile)
+    : mTarget(target)
+    , mMaxRepeats(maxRepeats)
+    , mStateFile(stateFile)
+    , mRunning(false)
+    , mUnchanged(0)
+{
+    setLevel(mTarget->level());
+    readState();
+}
+
+// ------------------------------------------------------------------------
+
+AggregatingNotifier::~AggregatingNotifier()
+{
+    endRun();
+}
+
+// ------------------------------------------------------------------------
+
+std::string AggregatingNotifier::fingerprint(Message::Level level, const std::string& message)
+{
+    std::string fp(1, char('0' + level));
+    fp += '|';
+    bool inNumber = false;
+    for(std::string::const_iterator it = message.begin(); it != message.end() && *it != '['; ++it) {
+        if( std::isdigit(static_cast<unsigned char>(*it)) ) {
+            if( !inNumber )
+                fp += '#';
+            inNumber = true;
+        } else {
+            fp += *it;
+            inNumber = false;
+        }
+    }
+
+    for(int k=0; STATION_KEYS[k]; ++k) {
+        const std::string key = STATION_KEYS[k];
+        const std::string::size_type s = message.find(key);
+        if( s == std::string::npos )
+            continue;
+        const std::string::size_type b = s + key.size();
+        std::string::size_type e = b;
+        while( e < message.size() && std::isdigit(static_cast<unsigned char>(message[e])) )
+            e += 1;
+        fp += '|';
+        fp += message.substr(b, e - b);
+        break;
+    }
+    return fp;
+}
+
+// ------------------------------------------------------------------------
+
+void AggregatingNotifier::sendText(Message::Level level, const std::string& message)
+{
+    if( level >= Message::ERROR ) {
+        mTarget->sendText(level, message);
+        return;
+    }
+
+    boost::mutex::scoped_lock lock(mMutex);
+    if( !mStateFile.empty() ) {
+        const boost::uint64_t h = textHash(message);
+        mThisRun.insert(h);
+        RunTexts::const_iterator p = mPreviousRuns.find(mRunKey);
+        if( p != mPreviousRuns.end() && p->second.count(h) ) {
+            mUnchanged += 1;
+            return;
+        }
+    }
+
+    if( mMaxRepeats > 0 ) {
+        Count& c = mCounts[fingerprint(level, message)];
+        c.seen += 1;
+        if( c.seen == 1 ) {
+            c.level = level;
+            c.first = message;
+        }
+        if( c.seen > mMaxRepeats )
+            return;
+    }
+    mTarget->sendText(level, message);
+}
+
+// ------------------------------------------------------------------------
+
+void AggregatingNotifier::beginRun(const std::string& key)
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    mRunKey = key;
+    mRunning = true;
+}
+
+// ------------------------------------------------------------------------
+
+void AggregatingNotifier::endRun()
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    foreach(const Counts::value_type& fc, mCounts) {
+        const Count& c = fc.second;
+        if( c.seen <= mMaxRepeats )
+            continue;
+        std::ostringstream msg;
+        msg << (c.seen - mMaxRepeats) << " more messages like '" << c.first << "' suppressed";
+        mTarget->sendText(c.level, msg.str());
+    }
+    mCounts.clear();
+
+    if( mStateFile.empty() || !mRunning )
+        return;
+    mRunning = false;
+    if( mUnchanged > 0 ) {
+        std::ostringstream msg;
+        msg << mUnchanged << " messages unchanged since the previous run of '" << mRunKey << "' not repeated";
+        mTarget->sendText(Message::INFO, msg.str());
+    }
+    mUnchanged = 0;
+    mPreviousRuns[mRunKey].swap(mThisRun);
+    mThisRun.clear();
+    writeState();
+}
+
+// ------------------------------------------------------------------------
+
+void AggregatingNotifier::readState()
+{
+    if( mStateFile.empty() )
+        return;
+    std::ifstream in(mStateFile.c_str());
+    std::string key;
+    boost::uint64_t h;
+    while( std::getline(in, key, '\t') && (in >> h) ) {
+        mPreviousRuns[key].insert(h);
+        in.ignore(1); // newline
+    }
+}
+
+// ------------------------------------------------------------------------
+
+void AggregatingNotifier::writeState() const
+{
+    const std::string tmp = mStateFile + ".new";
+    {
+        std::ofstream out(tmp.c_str());
+        foreach(const RunTexts::value_type& rt, mPreviousRuns) {
+            foreach(const boost::uint64_t h, rt.second)
+                out << rt.first << '\t' << h << '\n';
+        }
+        if( !out )
+            return;
+    }
+    std::rename(tmp.c_str(), mStateFile.c_str());
+}
@@ -0,0 +1,109 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef AggregatingNotifier_H
+#define AggregatingNotifier_H
+
+#include "Notifier.h"
+
+#include <boost/thread/mutex.hpp>
+#include <boost/cstdint.hpp>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+/**
+ * \brief Collapses repetitive user messages before passing them on.
+ *
+ * Messages are grouped by a fingerprint made of level, the message
+ * text up to the first '[' with all numbers replaced by '#' (the
+ * category is at the start of the text), and the first
+ * "stationid=..." or, if there is none, "station=..." in the text.
+ * Only the first few messages per
+ * fingerprint are passed on, and endRun() sends a count of the
+ * suppressed ones. Errors are always passed on.
+ *
+ * With a state file, texts sent in a run are remembered for the next
+ * run with the same key, and identical texts are then only counted
+ * as unchanged. The state file keeps this over restarts.
+ */
+class AggregatingNotifier : public Notifier
+{
+public:
+    /**
+     * Takes ownership of target, and uses its level. maxRepeats <= 0
+     * means no limit per fingerprint; an empty stateFile means no
+     * suppression of texts from the previous run.
+     */
+    AggregatingNotifier(Notifier* target, int maxRepeats, const std::string& stateFile = "");
+
+    ~AggregatingNotifier();
+
+    virtual void sendText(Message::Level level, const std::string& message);
+
+    /** Start a run; key identifies runs to compare with, e.g. the configuration file. */
+    void beginRun(const std::string& key);
+
+    /** Send summaries for this run and, if begun with beginRun(), remember its texts. */
+    void endRun();
+
+    static std::string fingerprint(Message::Level level, const std::string& message);
+
+private:
+    void readState();
+    void writeState() const;
+
+private:
+    struct Count {
+        Count() : level(Message::DEBUG), seen(0) { }
+        Message::Level level;
+        std::string first;
+        int seen;
+    };
+    typedef std::map<std::string, Count> Counts;
+
+    typedef std::set<boost::uint64_t> TextHashes;
+    typedef std::map<std::string, TextHashes> RunTexts;
+
+    std::unique_ptr<Notifier> mTarget;
+    const int mMaxRepeats;
+    const std::string mStateFile;
+
+    boost::mutex mMutex;
+    Counts mCounts;
+    std::string mRunKey;
+    bool mRunning;
+    TextHashes mThisRun;
+    RunTexts mPreviousRuns;
+    int mUnchanged;
+};
+
+#endif
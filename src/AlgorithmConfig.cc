@@ -188,6 +188,9 @@ void AlgorithmConfig::ParseStreamThrow(std::istream& input)
 
     RunAtMinute = c.get("RunAtMinute").convert<int>(0, 0); // Minute at which to run the algorithm
     RunAtHour   = c.get("RunAtHour")  .convert<int>(0, 2); // Hour at which to run the algorithm
+    RunBudgetSeconds = c.get("RunBudgetSeconds").convert<int>(0, 0); // Stop the algorithm early after this time, 0 = no limit
+    WriteBatchRows   = c.get("WriteBatchRows").convert<int>(0, 500); // Write updates in transactions of up to this many rows, 1 = each at once
+    WriteBatchMilliseconds = c.get("WriteBatchMilliseconds").convert<int>(0, 5000); // ... or after queueing them for this time
 
     UT1 = UT0 = now;
 
@@ -201,6 +204,7 @@ void AlgorithmConfig::ParseStreamThrow(std::istream& input)
         extractTime(c, "Start", UT0);
         extractTime(c, "End",   UT1);
     }
+    UT0lookback = UT0;
 
     Algorithm          = c.get("Algorithm")    .convert<std::string>(0, "NotSet"); // Algorithm Name
     CFAILED_STRING     = c.get("CfailedString").convert<std::string>(0, ""); // Value to add to CFAILED if the algorithm runs and writes data back to the database
@@ -62,11 +62,17 @@ public:
     kvtime::time UT0;
     kvtime::time UT1;
 
+    /** Start of the whole run when UT0..UT1 is one backfill chunk of it, see Qc2Algorithm::UT0lookback. */
+    kvtime::time UT0lookback;
+
     std::string Algorithm;
     std::string CFAILED_STRING;
 
     int RunAtMinute;
     int RunAtHour;
+    int RunBudgetSeconds;
+    int WriteBatchRows;
+    int WriteBatchMilliseconds;
 
     float missing;
     float rejected;
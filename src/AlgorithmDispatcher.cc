@@ -48,11 +48,12 @@
 #include "DBInterface.h"
 #include "foreach.h"
 #include "Qc2App.h"
+#include "RunControl.h"
 
 #include <milog/milog.h>
 
 AlgorithmDispatcher::AlgorithmDispatcher()
-    : mBroadcaster(0), mDatabase(0), mNotifier(0)
+    : mBroadcaster(0), mDatabase(0), mNotifier(0), mFindings(0)
 {
     Qc2Algorithm* algorithms[] = {
 #ifdef ENABLE_AGGREGATORLIMITS
@@ -86,10 +87,11 @@ AlgorithmDispatcher::~AlgorithmDispatcher()
 
 // ------------------------------------------------------------------------
 
-int AlgorithmDispatcher::select(const AlgorithmConfig& params)
+int AlgorithmDispatcher::select(const AlgorithmConfig& params, RunControl* control)
 {
     std::string algorithm = params.Algorithm;
     algorithms_t::iterator a = mAlgorithms.find(algorithm);
+    int status = 0;
     if( a != mAlgorithms.end() ) {
         LOGINFO("Running '" << algorithm << "' (" << params.filename() << ")");
         try {
@@ -99,19 +101,47 @@ int AlgorithmDispatcher::select(const AlgorithmConfig& params)
                 LOGERROR("Configuration error: " << errors.format("; "));
                 return 1;
             }
+            a->second->setRunControl(control);
             a->second->run();
-            LOGINFO(algorithm + " Completed");
+            a->second->flushWrites();
+            if( control && control->stopped() )
+                LOGINFO(algorithm + " Stopped early");
+            else
+                LOGINFO(algorithm + " Completed");
         } catch(DBException& dbe) {
             LOGERROR(algorithm + ": Database exception: " + dbe.what());
+            status = 1;
         } catch(ConfigException& ce) {
             LOGERROR(algorithm + ": Configuration exception: " + ce.what());
+            status = 1;
         } catch(...) {
             LOGERROR(algorithm + ": Exception -- please report bug in https://kvoss.bugs.met.no");
+            status = 1;
         }
+        if( status != 0 ) {
+            // keep the updates made before the error, as if they had been written at once
+            try {
+                a->second->flushWrites();
+            } catch(std::exception&) {
+            }
+        }
+        const std::size_t lost = a->second->discardWrites();
+        if( lost > 0 )
+            LOGERROR(algorithm << ": " << lost << " updates could not be written, they are checked again in the next run");
+        a->second->setRunControl(0);
     } else {
         LOGINFO("Unknown algorithm '" << algorithm << "' specified");
+        status = 1;
     }
-    return 0;
+    return status;
+}
+
+// ------------------------------------------------------------------------
+
+bool AlgorithmDispatcher::canSplitStations(const AlgorithmConfig& params) const
+{
+    const algorithms_t::const_iterator a = mAlgorithms.find(params.Algorithm);
+    return a == mAlgorithms.end() || a->second->canSplitStations();
 }
 
 // ------------------------------------------------------------------------
@@ -140,3 +170,12 @@ void AlgorithmDispatcher::setNotifier(Notifier* n)
     foreach(algorithms_t::value_type& a, mAlgorithms)
         a.second->setNotifier(n);
 }
+
+// ------------------------------------------------------------------------
+
+void AlgorithmDispatcher::setFindingsWriter(FindingsWriter* f)
+{
+    mFindings = f;
+    foreach(algorithms_t::value_type& a, mAlgorithms)
+        a.second->setFindingsWriter(f);
+}
@@ -37,9 +37,11 @@
 class AlgorithmConfig;
 class Broadcaster;
 class DBInterface;
+class FindingsWriter;
 class Notifier;
 class Qc2App;
 class Qc2Algorithm;
+class RunControl;
 
 ///Handles the interface to different processing algorithms.
 
@@ -49,7 +51,11 @@ public:
     AlgorithmDispatcher();
     ~AlgorithmDispatcher();
 
-    int select(const AlgorithmConfig& params);
+    /** Run the algorithm selected in params, with an optional run control; returns 0 if it ran without errors. */
+    int select(const AlgorithmConfig& params, RunControl* control = 0);
+
+    /** If the algorithm selected in params may run its stations in separate shards. */
+    bool canSplitStations(const AlgorithmConfig& params) const;
 
     void setBroadcaster(Broadcaster* b);
 
@@ -57,6 +63,8 @@ public:
 
     void setNotifier(Notifier* n);
 
+    void setFindingsWriter(FindingsWriter* f);
+
 private:
     typedef std::map<std::string, Qc2Algorithm*> algorithms_t;
     algorithms_t mAlgorithms;
@@ -64,6 +72,7 @@ private:
     Broadcaster* mBroadcaster;
     DBInterface* mDatabase;
     Notifier* mNotifier;
+    FindingsWriter* mFindings;
 };
 
 #endif
@@ -29,16 +29,26 @@
 
 #include "AlgorithmRunner.h"
 
+#include "AggregatingNotifier.h"
 #include "AlgorithmConfig.h"
 #include "AlgorithmDispatcher.h"
+#include "AsyncNotifier.h"
+#include "Findings.h"
 #include "foreach.h"
+#include "InitLogger.h"
 #include "KvalobsDB.h"
 #include "KvServicedBroadcaster.h"
+#include "LeasedBackfillWork.h"
 #include "LogfileNotifier.h"
 #include "Qc2App.h"
 
+#include <kvalobs/kvPath.h>
 #include <milog/milog.h>
 
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
 #include <map>
 
 #define NDEBUG 1
@@ -48,12 +58,24 @@ AlgorithmRunner::AlgorithmRunner(Qc2App& app_)
     : app(app_)
     , database(new KvalobsDB(app))
     , broadcaster(new KvServicedBroadcaster(app))
-    , notifier(new LogfileNotifier)
+    , aggregator(new AggregatingNotifier(new AsyncNotifier(new LogfileNotifier),
+                    LoggerMaxRepeats(), LoggerRepeatStateFile()))
+    , notifier(aggregator)
+    , resumePoints(kvPath("rundir") + "/kvqc2d.resume")
 {
     dispatcher.setDatabase(database.get());
     dispatcher.setBroadcaster(broadcaster.get());
     dispatcher.setNotifier(notifier.get());
 
+    if( !app.findingsFile().empty() ) {
+        std::unique_ptr<JsonLinesFindingsWriter> jf(new JsonLinesFindingsWriter(app.findingsFile()));
+        if( jf->is_open() )
+            findings = std::move(jf);
+        else
+            LOGERROR("Cannot open findings file '" << app.findingsFile() << "'");
+    }
+    dispatcher.setFindingsWriter(findings.get());
+
 }
 
 AlgorithmRunner::~AlgorithmRunner()
@@ -98,6 +120,8 @@ void AlgorithmRunner::runAlgorithms()
 
         // run queued algorithms
         foreach(queue_t::value_type tc, queue) {
+            if( app.isShuttingDown() )
+                break;
             params.Parse( tc.second );
             if( tc.first < now )
                 LOGINFO("Algorithm " << params.Algorithm << " scheduled for "
@@ -121,10 +145,122 @@ void AlgorithmRunner::runOneAlgorithm(const std::string& config)
     runAlgorithmFromConfig(params);
 }
 
+void AlgorithmRunner::runBackfill(const std::string& config, int chunkDays, int nThreads, const std::string& stateFile,
+        int nShards, int leaseSeconds)
+{
+    AlgorithmConfig params;
+    params.Parse(config);
+
+    BackfillChunks chunks;
+    if( chunkDays > 0 ) {
+        chunks = makeBackfillChunks(params.UT0, params.UT1, chunkDays);
+    } else {
+        const BackfillChunk all = { params.UT0, params.UT1 };
+        chunks.push_back(all);
+    }
+
+    std::unique_ptr<BackfillCheckpoint> checkpoint;
+    std::unique_ptr<DBInterface> leaseDatabase;
+    std::unique_ptr<BackfillWork> work;
+    std::size_t nItems;
+    if( nShards <= 0 ) {
+        checkpoint.reset(new BackfillCheckpoint(stateFile.empty() ? config + ".backfill" : stateFile,
+                        config, params.UT0, params.UT1, chunkDays));
+        CheckpointBackfillWork* cw = new CheckpointBackfillWork(chunks, *checkpoint);
+        work.reset(cw);
+        nItems = cw->size();
+        LOGINFO("Backfill of '" << config << "': " << nItems << " of " << chunks.size()
+                << " chunks of " << chunkDays << " days to run");
+    } else {
+        if( nShards > 1 && !dispatcher.canSplitStations(params) ) {
+            LOGWARN("Algorithm '" << params.Algorithm << "' of '" << config
+                    << "' cannot run stations in separate shards, only chunks are shared");
+            nShards = 1;
+        }
+        // leases are renewed from a heartbeat thread, which needs its own connection
+        leaseDatabase.reset(database->newConnection());
+        if( !leaseDatabase ) {
+            LOGERROR("Cannot open a database connection for work leases, backfill of '" << config << "' not run");
+            return;
+        }
+        try {
+            work.reset(new LeasedBackfillWork(leaseDatabase.get(), config, chunks, nShards, leaseSeconds,
+                            boost::bind(&Qc2App::isShuttingDown, &app)));
+        } catch (std::exception& ex) {
+            LOGERROR("Cannot set up work leases for '" << config << "': " << ex.what());
+            return;
+        }
+        nItems = chunks.size() * nShards;
+        LOGINFO("Backfill of '" << config << "': " << chunks.size() << " chunks with " << nShards
+                << " station shards, shared with other processes");
+    }
+
+    // extra workers have their own algorithms, database connection and broadcaster
+    struct Worker {
+        std::unique_ptr<DBInterface> database;
+        std::unique_ptr<Broadcaster> broadcaster;
+        AlgorithmDispatcher dispatcher;
+    };
+    std::vector<std::shared_ptr<Worker> > workers;
+    const int nWorkers = std::min<std::size_t>(nThreads, nItems);
+    while( (int)workers.size() + 1 < nWorkers ) {
+        DBInterface* db = database->newConnection();
+        if( !db )
+            break;
+        std::shared_ptr<Worker> w = std::make_shared<Worker>();
+        w->database.reset(db);
+        w->broadcaster.reset(new KvServicedBroadcaster(app));
+        w->dispatcher.setDatabase(w->database.get());
+        w->dispatcher.setBroadcaster(w->broadcaster.get());
+        w->dispatcher.setNotifier(notifier.get());
+        w->dispatcher.setFindingsWriter(findings.get());
+        workers.push_back(w);
+    }
+
+    aggregator->beginRun(config);
+    boost::thread_group threads;
+    foreach(std::shared_ptr<Worker>& w, workers)
+        threads.create_thread(boost::bind(&AlgorithmRunner::runBackfillItems, this, &w->dispatcher, params, work.get()));
+    runBackfillItems(&dispatcher, params, work.get());
+    threads.join_all();
+    aggregator->endRun();
+    if( findings )
+        findings->flush();
+}
+
+void AlgorithmRunner::runBackfillItems(AlgorithmDispatcher* d, AlgorithmConfig params, BackfillWork* work)
+{
+    try {
+        BackfillItem item;
+        while( !app.isShuttingDown() && work->next(item) ) {
+            params.UT0 = item.chunk.UT0;
+            params.UT1 = item.chunk.UT1;
+
+            RunControl control;
+            control.setCancelled(boost::bind(&Qc2App::isShuttingDown, &app));
+            control.setShard(item.shard, item.nShards);
+            LOGINFO("Backfill chunk " << kvtime::iso(item.chunk.UT0) << " -- " << kvtime::iso(item.chunk.UT1)
+                    << " shard " << item.shard << '/' << item.nShards);
+            const bool done = (d->select(params, &control) == 0 && !control.stopped());
+            work->finished(item, done);
+        }
+    } catch (std::exception& ex) {
+        LOGERROR("Backfill worker stopped: " << ex.what());
+    }
+}
+
 void AlgorithmRunner::runAlgorithmFromConfig(const AlgorithmConfig& params)
 {
+    RunControl control;
+    control.setCancelled(boost::bind(&Qc2App::isShuttingDown, &app));
+    control.setBudget(params.RunBudgetSeconds);
+    control.setResumeStation(resumePoints.find(params));
+    if( control.resumeStation() >= 0 )
+        LOGINFO("Resuming '" << params.filename() << "' at station " << control.resumeStation());
+
+    aggregator->beginRun(params.filename());
     try {
-        dispatcher.select(params);
+        dispatcher.select(params, &control);
     } catch (dnmi::db::SQLException& ex) {
         LOGERROR("SQL Exception: " << ex.what());
     } catch (std::exception& ex) {
@@ -132,4 +268,10 @@ void AlgorithmRunner::runAlgorithmFromConfig(const AlgorithmConfig& params)
     } catch ( ... ) {
         LOGERROR("Unknown exception: ...");
     }
+    aggregator->endRun();
+    if( control.stopped() && control.stoppedStation() >= 0 )
+        LOGINFO("'" << params.filename() << "' stopped before station " << control.stoppedStation() << ", next run resumes there");
+    resumePoints.update(params, control.stopped() ? control.stoppedStation() : -1);
+    if( findings )
+        findings->flush();
 }
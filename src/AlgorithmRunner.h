@@ -31,8 +31,12 @@
 #define ALGORITHMRUNNER_H 1
 
 #include "AlgorithmDispatcher.h"
+#include "Backfill.h"
+#include "RunControl.h"
 #include <memory>
 
+class AggregatingNotifier;
+class FindingsWriter;
 class Qc2App;
 
 class AlgorithmRunner {
@@ -43,17 +47,34 @@ public:
     void runAlgorithms();
     void runOneAlgorithm(const std::string& config);
 
+    /**
+     * Run config in chunks of chunkDays days (<= 0: one chunk), with up
+     * to nThreads chunks in parallel.
+     *
+     * If nShards <= 0, completed chunks are remembered in stateFile
+     * (default: config + ".backfill"), and are skipped when the same
+     * backfill is started again. Otherwise, each chunk is split into
+     * nShards station shards, and the items are shared with other
+     * processes through leases of leaseSeconds in the database.
+     */
+    void runBackfill(const std::string& config, int chunkDays, int nThreads, const std::string& stateFile,
+            int nShards = 0, int leaseSeconds = 300);
+
 private:
     void runAlgorithmFromConfig(const AlgorithmConfig& params);
+    void runBackfillItems(AlgorithmDispatcher* d, AlgorithmConfig params, BackfillWork* work);
 
 private:
     Qc2App& app;
 
     std::unique_ptr<DBInterface> database;
     std::unique_ptr<Broadcaster> broadcaster;
+    AggregatingNotifier*         aggregator; // owned by notifier
     std::unique_ptr<Notifier>    notifier;
+    std::unique_ptr<FindingsWriter> findings;
 
     AlgorithmDispatcher dispatcher;
+    ResumePoints resumePoints;
 };
 
 #endif
@@ -0,0 +1,145 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "AsyncNotifier.h"
+
+#include <boost/bind.hpp>
+#include <sstream>
+
+namespace {
+const char* levelNames[] = { "DEBUG", "INFO", "WARNING", "ERROR", "FATAL" };
+} // anonymous namespace
+
+AsyncNotifier::AsyncNotifier(Notifier* target, int capacity, int flushMilliseconds)
+    : mTarget(target)
+    , mQueue(capacity)
+    , mFlushMilliseconds(flushMilliseconds)
+    , mQueued(0)
+    , mWritten(0)
+    , mDropped(0)
+    , mReportedDropped(0)
+    , mStop(false)
+{
+    for(int l=0; l<N_LEVELS; ++l) {
+        mDroppedPerLevel[l].store(0);
+        mReportedPerLevel[l] = 0;
+    }
+    setLevel(mTarget->level());
+    mWriter = boost::thread(boost::bind(&AsyncNotifier::writer, this));
+}
+
+// ------------------------------------------------------------------------
+
+AsyncNotifier::~AsyncNotifier()
+{
+    mStop.store(true);
+    mWake.notify_one();
+    mWriter.join();
+}
+
+// ------------------------------------------------------------------------
+
+void AsyncNotifier::sendText(Message::Level level, const std::string& message)
+{
+    Entry e;
+    e.level = level;
+    e.text = message;
+    if( mQueue.push(e) ) {
+        mQueued.fetch_add(1);
+    } else {
+        // count per level first, so that flush() never waits for a
+        // drop that reportDropped() cannot see yet
+        mDroppedPerLevel[level].fetch_add(1);
+        mDropped.fetch_add(1);
+    }
+}
+
+// ------------------------------------------------------------------------
+
+void AsyncNotifier::flush()
+{
+    const unsigned long dropped = mDropped.load();
+    const unsigned long queued = mQueued.load();
+    while( mWritten.load() < queued || mReportedDropped.load() < dropped ) {
+        mWake.notify_one();
+        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+    }
+}
+
+// ------------------------------------------------------------------------
+
+void AsyncNotifier::writer()
+{
+    while( true ) {
+        const bool stop = mStop.load();
+        drain();
+        if( stop )
+            break;
+        boost::mutex::scoped_lock lock(mWakeMutex);
+        mWake.timed_wait(lock, boost::posix_time::milliseconds(mFlushMilliseconds));
+    }
+}
+
+// ------------------------------------------------------------------------
+
+void AsyncNotifier::drain()
+{
+    Entry e;
+    while( mQueue.pop(e) ) {
+        mTarget->sendText(e.level, e.text);
+        mWritten.fetch_add(1);
+    }
+    reportDropped();
+}
+
+// ------------------------------------------------------------------------
+
+void AsyncNotifier::reportDropped()
+{
+    std::ostringstream counts;
+    unsigned long total = 0;
+    Message::Level reportLevel = Message::WARNING;
+    for(int l=N_LEVELS-1; l>=0; --l) {
+        const unsigned long d = mDroppedPerLevel[l].load() - mReportedPerLevel[l];
+        if( d == 0 )
+            continue;
+        counts << ' ' << d << ' ' << levelNames[l];
+        mReportedPerLevel[l] += d;
+        total += d;
+        if( l >= Message::WARNING )
+            reportLevel = Message::ERROR;
+    }
+    if( total == 0 )
+        return;
+
+    std::ostringstream msg;
+    msg << "message queue full, dropped " << total << " messages:" << counts.str();
+    mTarget->sendText(reportLevel, msg.str());
+    mReportedDropped.fetch_add(total);
+}
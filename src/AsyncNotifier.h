@@ -0,0 +1,98 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef AsyncNotifier_H
+#define AsyncNotifier_H
+
+#include "Notifier.h"
+#include "helpers/RingBuffer.h"
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <atomic>
+#include <memory>
+
+/**
+ * \brief Passes user messages to another notifier from a writer thread.
+ *
+ * sendText() only moves the text into a bounded lock-free queue, so
+ * algorithms -- also several worker threads -- do not wait for log
+ * files. The writer thread wakes up periodically, forwards all queued
+ * messages, and reports how many messages of each level were dropped
+ * because the queue was full; this report is also sent by flush() and
+ * at shutdown.
+ */
+class AsyncNotifier : public Notifier
+{
+public:
+    /** Takes ownership of target, and uses its level. */
+    AsyncNotifier(Notifier* target, int capacity = 1<<14, int flushMilliseconds = 200);
+
+    /** Forwards all queued messages before returning. */
+    ~AsyncNotifier();
+
+    virtual void sendText(Message::Level level, const std::string& message);
+
+    /** Wait until all messages sent so far, and the number of dropped messages, have been passed to the target. */
+    void flush();
+
+    /** Number of messages dropped so far because the queue was full. */
+    unsigned long dropped() const
+        { return mDropped.load(); }
+
+private:
+    void writer();
+    void drain();
+    void reportDropped();
+
+    enum { N_LEVELS = Message::FATAL + 1 };
+
+private:
+    struct Entry {
+        Message::Level level;
+        std::string text;
+    };
+
+    std::unique_ptr<Notifier> mTarget;
+    Helpers::RingBuffer<Entry> mQueue;
+    const int mFlushMilliseconds;
+
+    std::atomic<unsigned long> mQueued, mWritten, mDropped, mReportedDropped;
+    std::atomic<unsigned long> mDroppedPerLevel[N_LEVELS];
+    unsigned long mReportedPerLevel[N_LEVELS];
+    std::atomic<bool> mStop;
+
+    boost::mutex mWakeMutex;
+    boost::condition_variable mWake;
+    boost::thread mWriter;
+};
+
+#endif
@@ -0,0 +1,142 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "Backfill.h"
+
+#include "foreach.h"
+
+#include <fstream>
+#include <sstream>
+
+BackfillChunks makeBackfillChunks(const kvtime::time& UT0, const kvtime::time& UT1, int chunkDays)
+{
+    BackfillChunks chunks;
+    if( UT1 < UT0 )
+        return chunks;
+    if( chunkDays <= 0 )
+        chunkDays = 1;
+    BackfillChunk c;
+    c.UT0 = UT0;
+    while( true ) {
+        kvtime::time next = c.UT0;
+        kvtime::addDays(next, chunkDays);
+        if( next >= UT1 ) {
+            c.UT1 = UT1;
+            chunks.push_back(c);
+            break;
+        }
+        // end one step before the next start so that no obstime is in two chunks
+        c.UT1 = next;
+        kvtime::addMinutes(c.UT1, -1);
+        chunks.push_back(c);
+        c.UT0 = next;
+    }
+    return chunks;
+}
+
+// ========================================================================
+
+BackfillCheckpoint::BackfillCheckpoint(const std::string& filename, const std::string& config,
+        const kvtime::time& UT0, const kvtime::time& UT1, int chunkDays)
+    : mFilename(filename)
+{
+    std::ostringstream h;
+    h << "backfill\t" << config << '\t' << kvtime::iso(UT0) << '\t' << kvtime::iso(UT1) << '\t' << chunkDays;
+    const std::string header = h.str();
+
+    std::ifstream in(mFilename.c_str());
+    std::string line;
+    if( std::getline(in, line) && line == header ) {
+        while( std::getline(in, line) )
+            mDone.insert(line);
+        return;
+    }
+    in.close();
+
+    std::ofstream out(mFilename.c_str(), std::ios_base::trunc);
+    out << header << std::endl;
+}
+
+// ------------------------------------------------------------------------
+
+std::string BackfillCheckpoint::chunkLine(const BackfillChunk& chunk)
+{
+    return "done\t" + kvtime::iso(chunk.UT0) + '\t' + kvtime::iso(chunk.UT1);
+}
+
+// ------------------------------------------------------------------------
+
+bool BackfillCheckpoint::isDone(const BackfillChunk& chunk) const
+{
+    return mDone.count(chunkLine(chunk)) > 0;
+}
+
+// ------------------------------------------------------------------------
+
+void BackfillCheckpoint::markDone(const BackfillChunk& chunk)
+{
+    const std::string line = chunkLine(chunk);
+    boost::mutex::scoped_lock lock(mMutex);
+    mDone.insert(line);
+    std::ofstream out(mFilename.c_str(), std::ios_base::app);
+    out << line << std::endl;
+}
+
+// ========================================================================
+
+CheckpointBackfillWork::CheckpointBackfillWork(const BackfillChunks& chunks, BackfillCheckpoint& checkpoint)
+    : mNext(0)
+    , mCheckpoint(checkpoint)
+{
+    foreach(const BackfillChunk& c, chunks) {
+        if( !mCheckpoint.isDone(c) )
+            mChunks.push_back(c);
+    }
+}
+
+// ------------------------------------------------------------------------
+
+bool CheckpointBackfillWork::next(BackfillItem& item)
+{
+    const std::size_t n = mNext.fetch_add(1);
+    if( n >= mChunks.size() )
+        return false;
+    item.chunk = mChunks[n];
+    item.shard = 0;
+    item.nShards = 1;
+    return true;
+}
+
+// ------------------------------------------------------------------------
+
+void CheckpointBackfillWork::finished(const BackfillItem& item, bool done)
+{
+    if( done )
+        mCheckpoint.markDone(item.chunk);
+}
@@ -0,0 +1,146 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef BACKFILL_H
+#define BACKFILL_H 1
+
+#include "helpers/timeutil.h"
+
+#include <boost/thread/mutex.hpp>
+
+#include <atomic>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief Part of a backfill time range; UT0 and UT1 are inclusive.
+ *
+ * Algorithms extend a chunk by their own lookback (e.g. Plumatic's
+ * UT0extended) as for a normal run. Redistribution searches back to
+ * the start of the whole backfill for the start of accumulations, see
+ * AlgorithmConfig::UT0lookback.
+ */
+struct BackfillChunk {
+    kvtime::time UT0, UT1;
+};
+
+typedef std::vector<BackfillChunk> BackfillChunks;
+
+/**
+ * Split UT0..UT1 into chunks of chunkDays days. Chunk starts stay
+ * aligned with UT0; as time ranges are inclusive, each chunk ends one
+ * minute (the obstime resolution) before the next one starts, so that
+ * parallel workers never write the same obstime. If UT0 == UT1, there
+ * is one chunk; if UT1 < UT0, there are none.
+ */
+BackfillChunks makeBackfillChunks(const kvtime::time& UT0, const kvtime::time& UT1, int chunkDays);
+
+// #######################################################################
+
+/**
+ * \brief Remembers the completed chunks of a backfill in a file.
+ *
+ * The first line describes the backfill; if it does not match, the
+ * file is started again. Each completed chunk is appended as one line,
+ * so that a crash loses at most the chunks that were running.
+ * markDone() may be called from several threads, isDone() only before
+ * starting them.
+ */
+class BackfillCheckpoint {
+public:
+    BackfillCheckpoint(const std::string& filename, const std::string& config,
+            const kvtime::time& UT0, const kvtime::time& UT1, int chunkDays);
+
+    bool isDone(const BackfillChunk& chunk) const;
+
+    void markDone(const BackfillChunk& chunk);
+
+private:
+    static std::string chunkLine(const BackfillChunk& chunk);
+
+private:
+    const std::string mFilename;
+    std::set<std::string> mDone;
+    boost::mutex mMutex;
+};
+
+// #######################################################################
+
+/**
+ * \brief One piece of backfill work: a chunk, for the stations with
+ * stationid % nShards == shard.
+ */
+struct BackfillItem {
+    BackfillChunk chunk;
+    int shard, nShards;
+};
+
+/**
+ * \brief Hands out backfill items to worker threads.
+ *
+ * next() and finished() may be called from several threads.
+ */
+class BackfillWork {
+public:
+    virtual ~BackfillWork() { }
+
+    /** Fetch the next item to run; returns false if there is none left. */
+    virtual bool next(BackfillItem& item) = 0;
+
+    /** The item has been run, completely if done is true. */
+    virtual void finished(const BackfillItem& item, bool done) = 0;
+};
+
+// #######################################################################
+
+/**
+ * \brief Backfill work for a single process, with completed chunks
+ * kept in a BackfillCheckpoint.
+ */
+class CheckpointBackfillWork : public BackfillWork {
+public:
+    /** Chunks that are done according to the checkpoint are skipped. */
+    CheckpointBackfillWork(const BackfillChunks& chunks, BackfillCheckpoint& checkpoint);
+
+    /** Number of chunks to run. */
+    std::size_t size() const
+        { return mChunks.size(); }
+
+    virtual bool next(BackfillItem& item);
+    virtual void finished(const BackfillItem& item, bool done);
+
+private:
+    BackfillChunks mChunks;
+    std::atomic<std::size_t> mNext;
+    BackfillCheckpoint& mCheckpoint;
+};
+
+#endif
@@ -30,6 +30,8 @@
 #ifndef DBINTERFACE_H_
 #define DBINTERFACE_H_
 
+#include "Instrument.h"
+#include "StationSet.h"
 #include "TimeRange.h"
 #include <kvalobs/kvData.h>
 #include <kvalobs/kvModelData.h>
@@ -37,6 +39,10 @@
 #include <kvalobs/kvStationParam.h>
 
 #include <exception>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
 
 class DBException : public std::runtime_error {
 public:
@@ -49,12 +55,33 @@ class FlagSetCU;
 struct NeighborData {
     int neighborid; // TODO maybe include typeid, level, sensor here?
     double offset, slope, sigma;
+    float weight; //!< 1/sigma^3, precomputed for neighbor interpolation
     NeighborData(int xid, double xoffset, double xslope, double xsigma)
-        : neighborid(xid), offset(xoffset), slope(xslope), sigma(xsigma) { }
+        : neighborid(xid), offset(xoffset), slope(xslope), sigma(xsigma), weight(cubeInverse(xsigma)) { }
+
+private:
+    static float cubeInverse(float s)
+        { return 1 / (s * s * s); }
 };
 
 typedef std::vector<NeighborData> NeighborDataVector;
 
+/** Neighbor correlations keyed by (stationid, paramid). */
+typedef std::map<std::pair<int, int>, NeighborDataVector> NeighborDataMap;
+
+/** Aggregate of one day of observations from one instrument, see table qc2_statistical_daily_aggregates. */
+struct DailyAggregate {
+    Instrument instrument;
+    kvtime::date day;
+    float sum;           //!< sum of the accepted observations
+    int count;           //!< number of accepted observations
+    int badCount;        //!< number of observations not accepted
+    int rowCount;        //!< number of data rows in this day, including missing and rejected ones
+    kvtime::time computed; //!< time when the run that calculated this aggregate started
+    DailyAggregate(const Instrument& i, const kvtime::date& d, float s, int c, int b, int r, const kvtime::time& cp)
+        : instrument(i), day(d), sum(s), count(c), badCount(b), rowCount(r), computed(cp) { }
+};
+
 /**
  * Wrapper for kvalobs database connections.
  */
@@ -78,20 +105,41 @@ public:
 
     typedef std::list<kvalobs::kvStationParam> StationParamList;
     virtual StationParamList findStationParams(int stationID, const kvtime::time& time, const std::string& qcx) throw (DBException) = 0;
-    virtual StationParamList findStationParams(const StationIDList& stationIDs, const std::vector<int>& pids, const std::string& qcxPrefix) throw (DBException) = 0;
+    virtual StationParamList findStationParams(const StationSet& stations, const std::vector<int>& pids, const std::string& qcxPrefix) throw (DBException) = 0;
 
     // ----------------------------------------
 
     typedef std::list<kvalobs::kvData> DataList;
-    virtual DataList findDataOrderObstime(const StationIDList& stationIDs, int pid, const TimeRange& time, const FlagSetCU& flags) throw (DBException) = 0;
+    virtual DataList findDataOrderObstime(const StationSet& stations, int pid, const TimeRange& time, const FlagSetCU& flags) throw (DBException) = 0;
     virtual DataList findDataOrderObstime(int stationID, int paramID, const TimeRange& time) throw (DBException) = 0;
     virtual DataList findDataOrderObstime(int stationID, int paramID, int typeID, const TimeRange& time) throw (DBException) = 0;
     virtual DataList findDataOrderObstime(int stationID, int paramID, int typeID, int sensor, int level, const TimeRange& t) throw (DBException) = 0;
     virtual DataList findDataMaybeTSLOrderObstime(int stationID, int paramID, int typeID, int sensor, int level, const TimeRange& t, const FlagSetCU& flags) throw (DBException) = 0;
     virtual DataList findDataOrderObstime(int stationID, const std::vector<int>& pids, const std::vector<int>& tids, int sensor, int level, const TimeRange& time, const FlagSetCU& flags) throw (DBException) = 0;
-    virtual DataList findDataOrderObstime(const StationIDList& stationIDs, int paramID, int typeID, const TimeRange& t, const FlagSetCU& flags) throw (DBException) = 0;
-    virtual DataList findDataOrderStationObstime(const StationIDList& stationIDs, const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& t, const FlagSetCU& flags) throw (DBException) = 0;
-    virtual DataList findDataAggregations(const StationIDList& stationIDs, const std::vector<int>& pids, const TimeRange& t, const FlagSetCU& flags) throw (DBException) = 0;
+    virtual DataList findDataOrderObstime(const StationSet& stations, int paramID, int typeID, const TimeRange& t, const FlagSetCU& flags) throw (DBException) = 0;
+    virtual DataList findDataOrderStationObstime(const StationSet& stations, const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& t, const FlagSetCU& flags) throw (DBException) = 0;
+    virtual DataList findDataAggregations(const StationSet& stations, const std::vector<int>& pids, const TimeRange& t, const FlagSetCU& flags) throw (DBException) = 0;
+
+    /** Fetch data for all Norwegian stations with tbtime after the given time, regardless of flags. */
+    virtual DataList findDataChangedSince(const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& t, const kvtime::time& tbtime) throw (DBException) = 0;
+
+    /** Current UTC time by the database clock, to be compared with tbtime. */
+    virtual kvtime::time currentTime() throw (DBException) = 0;
+
+    typedef std::map<kvtime::date, int> DayCountMap;
+
+    /** Count data rows per obstime day, using the same selection as findDataOrderStationObstime; days without rows are not included. */
+    virtual DayCountMap countDataPerDay(const StationSet& stations, const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& t, const FlagSetCU& flags) throw (DBException) = 0;
+
+    // ----------------------------------------
+
+    typedef std::list<DailyAggregate> DailyAggregateList;
+
+    /** Fetch stored daily aggregates for days d0..d1 (inclusive), ordered by instrument and day. */
+    virtual DailyAggregateList findDailyAggregates(int paramid, const std::vector<int>& tids, const kvtime::date& d0, const kvtime::date& d1) throw (DBException) = 0;
+
+    /** Replace all stored daily aggregates for days d0..d1 (inclusive) with the given ones. */
+    virtual void storeDailyAggregates(int paramid, const std::vector<int>& tids, const kvtime::date& d0, const kvtime::date& d1, const DailyAggregateList& aggregates) throw (DBException) = 0;
 
     // ----------------------------------------
 
@@ -99,10 +147,19 @@ public:
     typedef std::map<int, reference_values_t> reference_value_map_t;
     virtual reference_value_map_t findStatisticalReferenceValues(int paramid, const std::string& key, float missingValue) throw (DBException) = 0;
 
+    /** Returns a text that changes whenever the reference values for the given parameter and key change. */
+    virtual std::string findStatisticalReferenceValuesVersion(int paramid, const std::string& key) throw (DBException) = 0;
+
     // ----------------------------------------
 
     virtual NeighborDataVector findNeighborData(int stationid, int paramid, float maxsigma) throw (DBException) = 0;
 
+    /** Fetch all neighbor correlations for the given parameters, each vector sorted by increasing sigma. */
+    virtual NeighborDataMap findNeighborData(const std::vector<int>& paramids) throw (DBException) = 0;
+
+    /** Returns a text that changes whenever the neighbor correlations for the given parameters change. */
+    virtual std::string findNeighborDataVersion(const std::vector<int>& paramids) throw (DBException) = 0;
+
     // ----------------------------------------
 
     typedef std::list<kvalobs::kvModelData> ModelDataList;
@@ -113,6 +170,38 @@ public:
     /** Update and/or insert data. */
     virtual void storeData(const DataList& toUpdate, const DataList& toInsert) throw (DBException) = 0;
 
+    // ----------------------------------------
+
+    /* Work items shared by several kvqc2d processes, see table qc2_work_leases. */
+
+    /** Add work items that are not yet known; known items keep their state. */
+    virtual void addWorkItems(const std::string& work, const std::vector<std::string>& items) throw (DBException) = 0;
+
+    /**
+     * Lease one item that is not done and whose lease has expired, for
+     * leaseSeconds; returns "" if there is none. Lease times are taken
+     * from the database clock, so that the clocks of the hosts sharing
+     * the work do not matter. owner must be unique for each claim.
+     *
+     * Each claim counts as an attempt; expired items that have had
+     * maxAttempts attempts are marked as failed and not claimed again.
+     */
+    virtual std::string claimWorkItem(const std::string& work, const std::string& owner, int leaseSeconds, int maxAttempts) throw (DBException) = 0;
+
+    /** Extend the lease of an item held by owner to leaseSeconds from now, by the database clock. */
+    virtual void renewWorkItem(const std::string& work, const std::string& item, const std::string& owner, int leaseSeconds) throw (DBException) = 0;
+
+    /** Mark an item held by owner as done, or give up the lease if not done. */
+    virtual void finishWorkItem(const std::string& work, const std::string& item, const std::string& owner, bool done) throw (DBException) = 0;
+
+    /** Number of items that are neither done nor failed. */
+    virtual int countOpenWorkItems(const std::string& work) throw (DBException) = 0;
+
+    // ----------------------------------------
+
+    /** Open another connection to the same database, e.g. for use in a worker thread. Returns 0 if not supported. */
+    virtual DBInterface* newConnection()
+        { return 0; }
 };
 
 
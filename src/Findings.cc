@@ -0,0 +1,156 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "Findings.h"
+
+#include "foreach.h"
+
+#include <kvalobs/kvData.h>
+
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+
+namespace {
+
+void jsonString(std::ostream& out, const std::string& s)
+{
+    out << '"';
+    foreach(const char c, s) {
+        switch( c ) {
+        case '"':  out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n";  break;
+        case '\t': out << "\\t";  break;
+        default:
+            if( static_cast<unsigned char>(c) < 0x20 ) {
+                char u[8];
+                std::snprintf(u, sizeof(u), "\\u%04x", c);
+                out << u;
+            } else {
+                out << c;
+            }
+        }
+    }
+    out << '"';
+}
+
+void jsonNumber(std::ostream& out, float v)
+{
+    if( std::isfinite(v) )
+        out << v;
+    else
+        out << "null";
+}
+
+} // anonymous namespace
+
+// ========================================================================
+
+Finding::Finding(const std::string& c, const kvalobs::kvData& data)
+    : check(c)
+    , stationid(data.stationID())
+    , paramid(data.paramID())
+    , type(data.typeID())
+    , timeFrom(data.obstime())
+    , timeTo(data.obstime())
+{
+}
+
+// ------------------------------------------------------------------------
+
+Finding::Finding(const std::string& c, int st, int pa, int ty, const kvtime::time& obstime)
+    : check(c)
+    , stationid(st)
+    , paramid(pa)
+    , type(ty)
+    , timeFrom(obstime)
+    , timeTo(obstime)
+{
+}
+
+// ========================================================================
+
+JsonLinesFindingsWriter::JsonLinesFindingsWriter(const std::string& filename)
+    : mOut(filename.c_str(), std::ios_base::app)
+{
+}
+
+// ------------------------------------------------------------------------
+
+JsonLinesFindingsWriter::~JsonLinesFindingsWriter()
+{
+    flush();
+}
+
+// ------------------------------------------------------------------------
+
+std::string JsonLinesFindingsWriter::format(const std::string& algorithm, const Finding& f)
+{
+    std::ostringstream out;
+    out.precision(7);
+    out << "{\"schema\":1,\"algorithm\":";
+    jsonString(out, algorithm);
+    out << ",\"check\":";
+    jsonString(out, f.check);
+    out << ",\"station\":" << f.stationid
+        << ",\"param\":" << f.paramid
+        << ",\"type\":" << f.type
+        << ",\"from\":\"" << kvtime::iso(f.timeFrom) << '"'
+        << ",\"to\":\"" << kvtime::iso(f.timeTo) << '"'
+        << ",\"values\":{";
+    for(unsigned int i=0; i<f.values.size(); ++i) {
+        if( i > 0 )
+            out << ',';
+        jsonString(out, f.values[i].first);
+        out << ':';
+        jsonNumber(out, f.values[i].second);
+    }
+    out << "},\"message\":";
+    jsonString(out, f.message);
+    out << '}';
+    return out.str();
+}
+
+// ------------------------------------------------------------------------
+
+void JsonLinesFindingsWriter::write(const std::string& algorithm, const Finding& finding)
+{
+    const std::string line = format(algorithm, finding);
+    boost::mutex::scoped_lock lock(mMutex);
+    mOut << line << '\n';
+}
+
+// ------------------------------------------------------------------------
+
+void JsonLinesFindingsWriter::flush()
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    mOut.flush();
+}
@@ -0,0 +1,119 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef FINDINGS_H
+#define FINDINGS_H 1
+
+#include "helpers/timeutil.h"
+
+#include <boost/thread/mutex.hpp>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace kvalobs {
+class kvData;
+}
+
+/**
+ * \brief A typed record of something an algorithm found, e.g. a
+ * check that triggered or an accumulation that needs HQC.
+ *
+ * Findings are written in addition to the text log, for programs that
+ * want to index them instead of parsing log messages.
+ */
+struct Finding {
+    /** Finding for the station, param and type of the data, at its obstime. */
+    Finding(const std::string& check, const kvalobs::kvData& data);
+
+    Finding(const std::string& check, int stationid, int paramid, int type, const kvtime::time& obstime);
+
+    /** Set the start of the time range; the default is the same as the end. */
+    Finding& from(const kvtime::time& t)
+        { timeFrom = t; return *this; }
+
+    Finding& value(const std::string& name, float v)
+        { values.push_back(std::make_pair(name, v)); return *this; }
+
+    Finding& text(const std::string& t)
+        { message = t; return *this; }
+
+    std::string check; //!< e.g. "QC2h-1-highsingle"
+    int stationid, paramid, type;
+    kvtime::time timeFrom, timeTo;
+    std::vector<std::pair<std::string, float> > values;
+    std::string message;
+};
+
+// #######################################################################
+
+/**
+ * \brief Interface for storing findings from algorithms.
+ */
+class FindingsWriter {
+public:
+    virtual ~FindingsWriter() { }
+    virtual void write(const std::string& algorithm, const Finding& finding) = 0;
+    virtual void flush() { }
+};
+
+// #######################################################################
+
+/**
+ * \brief Writes findings to a file, one JSON object per line.
+ *
+ * The schema is fixed, with keys always in this order:
+ * <pre>
+ * {"schema":1,"algorithm":"...","check":"...","station":N,"param":N,"type":N,
+ *  "from":"YYYY-mm-dd HH:MM:SS","to":"...","values":{"name":X,...},"message":"..."}
+ * </pre>
+ * Lines are appended to the file and flushed in flush() and the
+ * destructor; write() may be called from several threads.
+ */
+class JsonLinesFindingsWriter : public FindingsWriter {
+public:
+    explicit JsonLinesFindingsWriter(const std::string& filename);
+    ~JsonLinesFindingsWriter();
+
+    bool is_open() const
+        { return mOut.is_open(); }
+
+    virtual void write(const std::string& algorithm, const Finding& finding);
+    virtual void flush();
+
+    /** The line written for a finding, without the newline. */
+    static std::string format(const std::string& algorithm, const Finding& finding);
+
+private:
+    boost::mutex mMutex;
+    std::ofstream mOut;
+};
+
+#endif
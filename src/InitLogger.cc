@@ -35,6 +35,8 @@
 #include <milog/milog.h>
 
 #include <boost/filesystem/path.hpp>
+#include <algorithm>
+#include <cstdlib>
 #include <memory>
 #include <iostream>
 
@@ -42,6 +44,21 @@ namespace fs = boost::filesystem;
 
 namespace {
 
+int loggerDetailLevel = 4;
+int loggerMaxRepeats = 0;
+std::string loggerRepeatStateFile;
+
+int getDetailLevel(milog::LogLevel level)
+{
+    switch (level) {
+    case milog::FATAL: return 0;
+    case milog::ERROR: return 1;
+    case milog::WARN:  return 2;
+    case milog::INFO:  return 3;
+    default:           return 4;
+    }
+}
+
 milog::LogLevel getLogLevel(const std::string& str)
 {
     if (str == "FATAL" || str == "0") {
@@ -105,6 +122,16 @@ void InitLogger(int argn, char **argv, const std::string &logname)
                 fail_missing_arg(argi);
             logfilename = argv[i];
             rotating_logfile = false;
+        } else if (argi == "--log-repeats") {
+            i++;
+            if (i >= argn)
+                fail_missing_arg(argi);
+            loggerMaxRepeats = atoi(argv[i]);
+        } else if (argi == "--log-repeat-state") {
+            i++;
+            if (i >= argn)
+                fail_missing_arg(argi);
+            loggerRepeatStateFile = argv[i];
         }
     }
 
@@ -129,6 +156,7 @@ void InitLogger(int argn, char **argv, const std::string &logname)
 
         logConsole->loglevel(levelConsole);
         logFile->loglevel(levelFile);
+        loggerDetailLevel = std::max(getDetailLevel(levelConsole), getDetailLevel(levelFile));
 
         if (!milog::LogManager::createLogger(logname, logConsole.release()) ) {
             std::cerr << "FATAL: Cannot create console logger" << std::endl;
@@ -148,3 +176,18 @@ void InitLogger(int argn, char **argv, const std::string &logname)
 
     std::cerr << "Logging to file '" << logfilename << "'\n";
 }
+
+int LoggerDetailLevel()
+{
+    return loggerDetailLevel;
+}
+
+int LoggerMaxRepeats()
+{
+    return loggerMaxRepeats;
+}
+
+const std::string& LoggerRepeatStateFile()
+{
+    return loggerRepeatStateFile;
+}
@@ -38,4 +38,24 @@
  */
 void InitLogger(int argn, char **argv, const std::string &logname);
 
+/**
+ * Most detailed level written by any of the log streams set up in
+ * InitLogger, numbered as for --loglevel: 0=FATAL, ..., 4=DEBUG. This
+ * is 4 if InitLogger has not been called.
+ */
+int LoggerDetailLevel();
+
+/**
+ * Number of similar algorithm messages logged per run before the rest
+ * are only counted, from --log-repeats (default 0 = no limit).
+ */
+int LoggerMaxRepeats();
+
+/**
+ * File remembering algorithm messages from the previous runs, from
+ * --log-repeat-state; unchanged messages are then not repeated. Empty
+ * if not given.
+ */
+const std::string& LoggerRepeatStateFile();
+
 #endif
@@ -29,6 +29,7 @@
 
 #include "KvalobsDB.h"
 
+#include "KvalobsDbPool.h"
 #include "KvalobsElemExtract.h"
 #include "foreach.h"
 #include "Qc2App.h"
@@ -61,12 +62,19 @@ KvalobsDB::~KvalobsDB()
 
 // ------------------------------------------------------------------------
 
+DBInterface* KvalobsDB::newConnection()
+{
+    return new KvalobsDB(mApp);
+}
+
+// ------------------------------------------------------------------------
+
 DBInterface::StationList KvalobsDB::extractStations(const std::string& sql) throw (DBException)
 {
     try {
         DBInterface::StationList s;
         std::unique_ptr<KvalobsDbExtract> extract(makeElementExtract<kvalobs::kvStation>(std::back_inserter(s)));
-        mDbGate.select(extract.get(), sql);
+        mReadGate.select(extract.get(), sql);
         return s;
     } catch(std::exception& e) {
         throw DBException(e.what());
@@ -97,7 +105,7 @@ DBInterface::StationIDList KvalobsDB::extractStationIDs(const std::string& sql)
 {
     try {
         std::unique_ptr<ExtractStationIDs> extract(new ExtractStationIDs());
-        mDbGate.select(extract.get(), sql);
+        mReadGate.select(extract.get(), sql);
         return extract->ids();
     } catch(std::exception& e) {
         throw DBException(e.what());
@@ -113,7 +121,7 @@ DBInterface::StationParamList KvalobsDB::extractStationParams(const std::string&
     try {
         StationParamList s;
         std::unique_ptr<KvalobsDbExtract> extract(makeElementExtract<kvalobs::kvStationParam>(std::back_inserter(s)));
-        mDbGate.select(extract.get(), sql);
+        mReadGate.select(extract.get(), sql);
         return s;
     } catch(std::exception& e) {
         throw DBException(e.what());
@@ -129,6 +137,7 @@ DBInterface::DataList KvalobsDB::extractData(const std::string& sql) throw (DBEx
     try {
         DataList d;
         std::unique_ptr<KvalobsDbExtract> extract(makeElementExtract<kvalobs::kvData>(std::back_inserter(d)));
+        // algorithms read data they have just written
         mDbGate.select(extract.get(), sql);
         return d;
     } catch(std::exception& e) {
@@ -172,7 +181,7 @@ DBInterface::reference_value_map_t KvalobsDB::extractStatisticalReferenceValues(
     try {
         DBInterface::reference_value_map_t rvm;
         std::unique_ptr<KvalobsDbExtract> extract(new ExtractReferenceValue(rvm, missingValue));
-        mDbGate.select(extract.get(), sql);
+        mReadGate.select(extract.get(), sql);
         return rvm;
     } catch(std::exception& e) {
         throw DBException(e.what());
@@ -185,6 +194,92 @@ DBInterface::reference_value_map_t KvalobsDB::extractStatisticalReferenceValues(
 
 namespace {
 
+struct ExtractDailyAggregate : public KvalobsDbExtract {
+    ExtractDailyAggregate(DBInterface::DailyAggregateList& aggregates)
+        : mAggregates(aggregates) { }
+
+    void extractFromRow(const dnmi::db::DRow& row);
+
+private:
+    DBInterface::DailyAggregateList& mAggregates;
+};
+
+void ExtractDailyAggregate::extractFromRow(const dnmi::db::DRow& row)
+{
+    dnmi::db::CIDRow col = row.begin();
+    const int stationid = std::atoi((*col++).c_str());
+    const int paramid   = std::atoi((*col++).c_str());
+    const int type      = std::atoi((*col++).c_str());
+    const int sensor    = std::atoi((*col++).c_str());
+    const int level     = std::atoi((*col++).c_str());
+    const kvtime::date day = kvtime::makedate(*col++);
+    const float sum     = std::atof((*col++).c_str());
+    const int count     = std::atoi((*col++).c_str());
+    const int badCount  = std::atoi((*col++).c_str());
+    const int rowCount  = std::atoi((*col++).c_str());
+    const kvtime::time computed = kvtime::maketime(*col++);
+
+    mAggregates.push_back(DailyAggregate(Instrument(stationid, paramid, sensor, type, level), day, sum, count, badCount, rowCount, computed));
+}
+
+} // anonymous namespace
+
+DBInterface::DailyAggregateList KvalobsDB::extractDailyAggregates(const std::string& sql) throw (DBException)
+{
+    try {
+        DBInterface::DailyAggregateList aggregates;
+        std::unique_ptr<KvalobsDbExtract> extract(new ExtractDailyAggregate(aggregates));
+        mDbGate.select(extract.get(), sql);
+        return aggregates;
+    } catch(std::exception& e) {
+        throw DBException(e.what());
+    } catch(...) {
+        throw UNKNOWN_DBEXCEPTION;
+    }
+}
+
+// ------------------------------------------------------------------------
+
+namespace {
+
+struct ExtractDayCount : public KvalobsDbExtract {
+    ExtractDayCount(DBInterface::DayCountMap& counts)
+        : mCounts(counts) { }
+
+    void extractFromRow(const dnmi::db::DRow& row);
+
+private:
+    DBInterface::DayCountMap& mCounts;
+};
+
+void ExtractDayCount::extractFromRow(const dnmi::db::DRow& row)
+{
+    dnmi::db::CIDRow col = row.begin();
+    const kvtime::date day = kvtime::makedate(*col++);
+    const int count = std::atoi((*col++).c_str());
+    mCounts[day] = count;
+}
+
+} // anonymous namespace
+
+DBInterface::DayCountMap KvalobsDB::extractDayCounts(const std::string& sql) throw (DBException)
+{
+    try {
+        DBInterface::DayCountMap counts;
+        std::unique_ptr<KvalobsDbExtract> extract(new ExtractDayCount(counts));
+        mDbGate.select(extract.get(), sql);
+        return counts;
+    } catch(std::exception& e) {
+        throw DBException(e.what());
+    } catch(...) {
+        throw UNKNOWN_DBEXCEPTION;
+    }
+}
+
+// ------------------------------------------------------------------------
+
+namespace {
+
 struct ExtractNeighborData : public KvalobsDbExtract {
     ExtractNeighborData(NeighborDataVector& neighbors)
         : mNeighbors(neighbors) { }
@@ -206,6 +301,52 @@ void ExtractNeighborData::extractFromRow(const dnmi::db::DRow& row)
     mNeighbors.push_back(NeighborData(neighborid, offset, slope, sigma));
 }
 
+// ------------------------------------------------------------------------
+
+struct ExtractNeighborDataMap : public KvalobsDbExtract {
+    ExtractNeighborDataMap(NeighborDataMap& neighbors)
+        : mNeighbors(neighbors) { }
+
+    void extractFromRow(const dnmi::db::DRow& row);
+
+private:
+    NeighborDataMap& mNeighbors;
+};
+
+void ExtractNeighborDataMap::extractFromRow(const dnmi::db::DRow& row)
+{
+    dnmi::db::CIDRow col = row.begin();
+    const int stationid  = std::atoi((*col++).c_str());
+    const int paramid    = std::atoi((*col++).c_str());
+    const int neighborid = std::atoi((*col++).c_str());
+    const float offset   = std::atof((*col++).c_str());
+    const float slope    = std::atof((*col++).c_str());
+    const float sigma    = std::atof((*col++).c_str());
+
+    mNeighbors[std::make_pair(stationid, paramid)].push_back(NeighborData(neighborid, offset, slope, sigma));
+}
+
+// ------------------------------------------------------------------------
+
+struct ExtractText : public KvalobsDbExtract {
+    ExtractText(std::string& text)
+        : mText(text) { }
+
+    void extractFromRow(const dnmi::db::DRow& row);
+
+private:
+    std::string& mText;
+};
+
+void ExtractText::extractFromRow(const dnmi::db::DRow& row)
+{
+    for(dnmi::db::CIDRow col = row.begin(); col != row.end(); ++col) {
+        if( !mText.empty() )
+            mText += ' ';
+        mText += *col;
+    }
+}
+
 } // anonymous namespace
 
 NeighborDataVector KvalobsDB::extractNeighborData(const std::string& sql) throw (DBException)
@@ -213,7 +354,23 @@ NeighborDataVector KvalobsDB::extractNeighborData(const std::string& sql) throw
     try {
         NeighborDataVector neighbors;
         std::unique_ptr<KvalobsDbExtract> extract(new ExtractNeighborData(neighbors));
-        mDbGate.select(extract.get(), sql);
+        mReadGate.select(extract.get(), sql);
+        return neighbors;
+    } catch(std::exception& e) {
+        throw DBException(e.what());
+    } catch(...) {
+        throw UNKNOWN_DBEXCEPTION;
+    }
+}
+
+// ------------------------------------------------------------------------
+
+NeighborDataMap KvalobsDB::extractNeighborDataMap(const std::string& sql) throw (DBException)
+{
+    try {
+        NeighborDataMap neighbors;
+        std::unique_ptr<KvalobsDbExtract> extract(new ExtractNeighborDataMap(neighbors));
+        mReadGate.select(extract.get(), sql);
         return neighbors;
     } catch(std::exception& e) {
         throw DBException(e.what());
@@ -224,12 +381,44 @@ NeighborDataVector KvalobsDB::extractNeighborData(const std::string& sql) throw
 
 // ------------------------------------------------------------------------
 
+std::string KvalobsDB::selectText(KvalobsDbGate& gate, const std::string& sql) throw (DBException)
+{
+    try {
+        std::string text;
+        std::unique_ptr<KvalobsDbExtract> extract(new ExtractText(text));
+        gate.select(extract.get(), sql);
+        return text;
+    } catch(std::exception& e) {
+        throw DBException(e.what());
+    } catch(...) {
+        throw UNKNOWN_DBEXCEPTION;
+    }
+}
+
+// ------------------------------------------------------------------------
+
+std::string KvalobsDB::extractText(const std::string& sql) throw (DBException)
+{
+    // short queries, e.g. for work leases, that must see the latest updates
+    return selectText(mDbGate, sql);
+}
+
+// ------------------------------------------------------------------------
+
+std::string KvalobsDB::extractReadOnlyText(const std::string& sql) throw (DBException)
+{
+    // versions of neighbors and reference values, read from the same gate as the values
+    return selectText(mReadGate, sql);
+}
+
+// ------------------------------------------------------------------------
+
 DBInterface::ModelDataList KvalobsDB::extractModelData(const std::string& sql) throw (DBException)
 {
     try {
         ModelDataList modelData;
         std::unique_ptr<KvalobsDbExtract> extract(makeElementExtract<kvalobs::kvModelData>(std::back_inserter(modelData)));
-        mDbGate.select(extract.get(), sql);
+        mReadGate.select(extract.get(), sql);
         return modelData;
     } catch(std::exception& e) {
         throw DBException(e.what());
@@ -251,6 +440,7 @@ void KvalobsDB::execSQLUpdate(const std::string& sql) throw (DBException)
         } catch( dnmi::db::SQLException& rex ) {
             LOGERROR("Rollback failed after problem wit SQL='" + sql + "'; exception=" + ex.what());
         }
+        disconnect(false);
         connect();
         throw DBException(ex.what());
     } catch(std::exception& e) {
@@ -262,38 +452,64 @@ void KvalobsDB::execSQLUpdate(const std::string& sql) throw (DBException)
 
 // ------------------------------------------------------------------------
 
-void KvalobsDB::formatStationIDList(std::ostream& sql, const StationIDList& stationIDs)
+void KvalobsDB::formatFixedStations(std::ostream& sql, const StationSet& stations)
 {
-    if( stationIDs.size() == 1 and stationIDs.front() == ALL_STATIONS ) {
-        sql << "stationid IN (SELECT stationid FROM station WHERE stationid BETWEEN 60 AND 99999 AND maxspeed = 0)";
-    } else {
-        SQLDataAccess::formatStationIDList(sql, stationIDs);
+    // the station table changes rarely; sending the fixed stations as
+    // an array spares the server a join with station in each query
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if( mFixedStationIDs.empty() || now - mFixedStationsFetched > std::chrono::minutes(FIXED_STATIONS_REFRESH_MINUTES) ) {
+        mFixedStationIDs = extractStationIDs("SELECT stationid FROM station WHERE maxspeed = 0 ORDER BY stationid");
+        mFixedStationsFetched = now;
     }
+
+    sql << "stationid = ANY('{";
+    const char* sep = "";
+    foreach(int id, mFixedStationIDs) {
+        if( stations.mayContain(id) ) {
+            sql << sep << id;
+            sep = ",";
+        }
+    }
+    sql << "}'::integer[])";
 }
+
+// ------------------------------------------------------------------------
+
+void KvalobsDB::formatSkipLocked(std::ostream& sql)
+{
+    sql << " FOR UPDATE SKIP LOCKED";
+}
+
+// ------------------------------------------------------------------------
+
+void KvalobsDB::formatTimeFromNow(std::ostream& sql, int seconds)
+{
+    // kvalobs keeps times in UTC in columns without time zone
+    sql << "(now() AT TIME ZONE 'UTC' + interval '" << seconds << " seconds')";
+}
+
 // ------------------------------------------------------------------------
 
 void KvalobsDB::connect()
 {
     if( mDbGate.getConnection() != 0 )
         disconnect();
-    while( !mApp.isShuttingDown() ) {
-        dnmi::db::Connection* c = mApp.getNewDbConnection();
-        if( c ) {
-            mDbGate.setConnection( c );
-            break;
-        }
-        LOGINFO( "Cannot connect to database now, retry in 5 seconds." );
-        sleep( 5 );
-    }
+    mDbGate.setConnection( mApp.dbPool().checkout() );
+    if( mApp.hasReadOnlyDb() )
+        mReadGate.setConnection( mApp.dbPool(true).checkout() );
+    else
+        mReadGate.setConnection( mDbGate.getConnection() );
 }
 
 // ------------------------------------------------------------------------
 
-void KvalobsDB::disconnect()
+void KvalobsDB::disconnect(bool healthy)
 {
     dnmi::db::Connection* c = mDbGate.getConnection();
-    if( c != 0 ) {
-        mDbGate.setConnection( 0 );
-        mApp.releaseDbConnection( c );
-    }
+    dnmi::db::Connection* r = mReadGate.getConnection();
+    mDbGate.setConnection( 0 );
+    mReadGate.setConnection( 0 );
+    mApp.dbPool().checkin( c, healthy );
+    if( r != c )
+        mApp.dbPool(true).checkin( r );
 }
@@ -33,6 +33,8 @@
 #include "SQLDataAccess.h"
 #include "KvalobsDbGate.h"
 
+#include <chrono>
+
 class Qc2App;
 
 class KvalobsDB : public SQLDataAccess {
@@ -40,25 +42,56 @@ public:
     KvalobsDB(Qc2App& app);
     virtual ~KvalobsDB();
 
+    virtual DBInterface* newConnection();
+
 protected:
     virtual StationList extractStations(const std::string& sql) throw (DBException);
     virtual StationIDList extractStationIDs(const std::string& sql) throw (DBException);
     virtual StationParamList extractStationParams(const std::string& sql) throw (DBException);
     virtual DataList extractData(const std::string& sql) throw (DBException);
     virtual reference_value_map_t extractStatisticalReferenceValues(const std::string& sql, float missingValue) throw (DBException);
+    virtual DailyAggregateList extractDailyAggregates(const std::string& sql) throw (DBException);
+    virtual DayCountMap extractDayCounts(const std::string& sql) throw (DBException);
     virtual NeighborDataVector extractNeighborData(const std::string& sql) throw (DBException);
+    virtual NeighborDataMap extractNeighborDataMap(const std::string& sql) throw (DBException);
+    virtual std::string extractText(const std::string& sql) throw (DBException);
+    virtual std::string extractReadOnlyText(const std::string& sql) throw (DBException);
     virtual ModelDataList extractModelData(const std::string& sql) throw (DBException);
     virtual void execSQLUpdate(const std::string& sql) throw (DBException);
 
-    virtual void formatStationIDList(std::ostream& sql, const StationIDList& stationIDs);
+    virtual void formatFixedStations(std::ostream& sql, const StationSet& stations);
+    virtual void formatSkipLocked(std::ostream& sql);
+    virtual void formatTimeFromNow(std::ostream& sql, int seconds);
 
 private:
     void connect();
-    void disconnect();
+
+    std::string selectText(KvalobsDbGate& gate, const std::string& sql) throw (DBException);
+
+    /** Return the connections to the pools; the primary one is closed if not healthy. */
+    void disconnect(bool healthy = true);
 
 private:
     Qc2App& mApp;
+
+    /**
+     * Connection to the primary database, for updates and for queries
+     * on tables that kvqc2d writes, which must see the latest writes.
+     */
     KvalobsDbGate mDbGate;
+
+    /**
+     * Connection for queries on tables that kvqc2d never writes (stations,
+     * station parameters, neighbors, reference values, model data): to
+     * the read-only replica if configured, otherwise the same as mDbGate.
+     */
+    KvalobsDbGate mReadGate;
+
+    enum { FIXED_STATIONS_REFRESH_MINUTES = 10 };
+
+    /** Cached ids of the fixed stations, for formatFixedStations(). */
+    StationIDList mFixedStationIDs;
+    std::chrono::steady_clock::time_point mFixedStationsFetched;
 };
 
 #endif /* KvalobsDB_h */
@@ -0,0 +1,80 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "KvalobsDbPool.h"
+
+#include "Qc2App.h"
+
+#include <milog/milog.h>
+
+#include <unistd.h>
+
+KvalobsDbPool::KvalobsDbPool(Qc2App& app, bool readOnly)
+    : mApp(app)
+    , mReadOnly(readOnly)
+{
+}
+
+// ------------------------------------------------------------------------
+
+KvalobsDbPool::~KvalobsDbPool()
+{
+    releaseIdle();
+}
+
+// ------------------------------------------------------------------------
+
+KvalobsDbPool::Connection_t* KvalobsDbPool::connect()
+{
+    while( !mApp.isShuttingDown() ) {
+        Connection_t* c = mApp.getNewDbConnection(mReadOnly);
+        if( c )
+            return c;
+        LOGINFO( "Cannot connect to database now, retry in 5 seconds." );
+        sleep( 5 );
+    }
+    return 0;
+}
+
+// ------------------------------------------------------------------------
+
+bool KvalobsDbPool::isConnected(Connection_t* c)
+{
+    if( c->isConnected() )
+        return true;
+    LOGINFO("Dropping broken database connection from pool.");
+    return false;
+}
+
+// ------------------------------------------------------------------------
+
+void KvalobsDbPool::release(Connection_t* c)
+{
+    mApp.releaseDbConnection(c);
+}
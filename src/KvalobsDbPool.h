@@ -0,0 +1,66 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef KvalobsDbPool_H
+#define KvalobsDbPool_H 1
+
+#include "helpers/ConnectionPool.h"
+
+#include <kvdb/kvdb.h>
+
+class Qc2App;
+
+/**
+ * \brief Keeps open database connections for reuse.
+ *
+ * Each KvalobsDB checks out its own connection, so that a connection
+ * is never used by two threads at the same time. A connection is
+ * checked with isConnected() before being handed out again; broken
+ * ones are released and replaced by new ones.
+ */
+class KvalobsDbPool : public Helpers::ConnectionPool<dnmi::db::Connection> {
+public:
+    typedef dnmi::db::Connection Connection_t;
+
+    /** Connect to the read-only replica if readOnly is true, see Qc2App::getNewDbConnection. */
+    KvalobsDbPool(Qc2App& app, bool readOnly);
+    ~KvalobsDbPool();
+
+protected:
+    /** Waits until connecting works, returns 0 at shutdown. */
+    virtual Connection_t* connect();
+    virtual bool isConnected(Connection_t* c);
+    virtual void release(Connection_t* c);
+
+private:
+    Qc2App& mApp;
+    const bool mReadOnly;
+};
+
+#endif /* KvalobsDbPool_H */
@@ -0,0 +1,158 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "LeasedBackfillWork.h"
+
+#include "DBInterface.h"
+#include "foreach.h"
+
+#include <milog/milog.h>
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <unistd.h>
+
+LeasedBackfillWork::LeasedBackfillWork(DBInterface* db, const std::string& config, const BackfillChunks& chunks,
+        int nShards, int leaseSeconds, const boost::function<bool()>& cancelled)
+    : mDB(db)
+    , mLeaseSeconds(std::max(leaseSeconds, 10))
+    , mCancelled(cancelled)
+    , mClaims(0)
+{
+    if( nShards < 1 )
+        nShards = 1;
+    if( !chunks.empty() ) {
+        std::ostringstream w;
+        w << config << '\t' << kvtime::iso(chunks.front().UT0) << '\t' << kvtime::iso(chunks.back().UT1)
+          << '\t' << chunks.size() << '\t' << nShards;
+        mWork = w.str();
+    }
+
+    char host[256];
+    if( gethostname(host, sizeof(host)) != 0 )
+        host[0] = 0;
+    host[sizeof(host)-1] = 0;
+    std::ostringstream o;
+    o << host << ':' << getpid();
+    mOwnerPrefix = o.str();
+
+    std::vector<std::string> keys;
+    foreach(const BackfillChunk& c, chunks) {
+        for(int s=0; s<nShards; ++s) {
+            const BackfillItem item = { c, s, nShards };
+            const std::string key = itemKey(item);
+            mItems[key] = item;
+            keys.push_back(key);
+        }
+    }
+    mDB->addWorkItems(mWork, keys);
+
+    mHeartbeat = boost::thread(boost::bind(&LeasedBackfillWork::heartbeat, this));
+}
+
+// ------------------------------------------------------------------------
+
+LeasedBackfillWork::~LeasedBackfillWork()
+{
+    mHeartbeat.interrupt();
+    mHeartbeat.join();
+}
+
+// ------------------------------------------------------------------------
+
+std::string LeasedBackfillWork::itemKey(const BackfillItem& item)
+{
+    std::ostringstream k;
+    k << kvtime::iso(item.chunk.UT0) << " -- " << kvtime::iso(item.chunk.UT1)
+      << " shard " << item.shard << '/' << item.nShards;
+    return k.str();
+}
+
+// ------------------------------------------------------------------------
+
+bool LeasedBackfillWork::next(BackfillItem& item)
+{
+    while( !(mCancelled && mCancelled()) ) {
+        {
+            boost::mutex::scoped_lock lock(mMutex);
+            std::ostringstream owner;
+            owner << mOwnerPrefix << ':' << ++mClaims;
+            const std::string key = mDB->claimWorkItem(mWork, owner.str(), mLeaseSeconds, MAX_ATTEMPTS);
+            const Items::const_iterator it = mItems.find(key);
+            if( it != mItems.end() ) {
+                mLeases[key] = owner.str();
+                item = it->second;
+                return true;
+            }
+            if( mDB->countOpenWorkItems(mWork) == 0 )
+                return false;
+        }
+        // other processes hold the remaining items; their leases may expire
+        for(int i=0; i<mLeaseSeconds/4 && !(mCancelled && mCancelled()); ++i)
+            boost::this_thread::sleep(boost::posix_time::seconds(1));
+    }
+    return false;
+}
+
+// ------------------------------------------------------------------------
+
+void LeasedBackfillWork::finished(const BackfillItem& item, bool done)
+{
+    const std::string key = itemKey(item);
+    boost::mutex::scoped_lock lock(mMutex);
+    const Leases::iterator it = mLeases.find(key);
+    if( it == mLeases.end() )
+        return;
+    if( !done )
+        LOGWARN("Backfill of '" << key << "' failed, it is tried at most " << int(MAX_ATTEMPTS) << " times");
+    mDB->finishWorkItem(mWork, key, it->second, done);
+    mLeases.erase(it);
+}
+
+// ------------------------------------------------------------------------
+
+void LeasedBackfillWork::heartbeat()
+{
+    try {
+        while( true ) {
+            boost::this_thread::sleep(boost::posix_time::seconds(mLeaseSeconds / 3));
+            boost::mutex::scoped_lock lock(mMutex);
+            foreach(const Leases::value_type& l, mLeases) {
+                try {
+                    mDB->renewWorkItem(mWork, l.first, l.second, mLeaseSeconds);
+                } catch (std::exception& e) {
+                    LOGWARN("Could not renew lease for '" << l.first << "': " << e.what());
+                }
+            }
+        }
+    } catch (boost::thread_interrupted&) {
+    }
+}
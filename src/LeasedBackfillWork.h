@@ -0,0 +1,93 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef LEASEDBACKFILLWORK_H
+#define LEASEDBACKFILLWORK_H 1
+
+#include "Backfill.h"
+
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <map>
+#include <string>
+
+class DBInterface;
+
+/**
+ * \brief Backfill work shared by several kvqc2d processes through
+ * leases in the database table qc2_work_leases.
+ *
+ * All processes running the same configuration with the same chunks
+ * and shards add the same items, and each item is run by the process
+ * holding its lease. A heartbeat thread renews the leases of running
+ * items; the lease of a process that crashes expires, and another
+ * process runs the item again. As algorithms only write changed data,
+ * running an item twice gives the same result. An item that has failed
+ * or crashed MAX_ATTEMPTS times is given up.
+ */
+class LeasedBackfillWork : public BackfillWork {
+public:
+    enum { MAX_ATTEMPTS = 3 };
+
+    /**
+     * The database connection is used from the heartbeat thread, too,
+     * and must not be used elsewhere while this object exists.
+     */
+    LeasedBackfillWork(DBInterface* db, const std::string& config, const BackfillChunks& chunks,
+            int nShards, int leaseSeconds, const boost::function<bool()>& cancelled);
+    ~LeasedBackfillWork();
+
+    /** Waits while other processes hold leases of the remaining items. */
+    virtual bool next(BackfillItem& item);
+    virtual void finished(const BackfillItem& item, bool done);
+
+private:
+    static std::string itemKey(const BackfillItem& item);
+    void heartbeat();
+
+private:
+    DBInterface* mDB;
+    const int mLeaseSeconds;
+    const boost::function<bool()> mCancelled;
+    std::string mWork, mOwnerPrefix;
+
+    typedef std::map<std::string, BackfillItem> Items;
+    Items mItems;
+
+    boost::mutex mMutex;
+    int mClaims;
+    typedef std::map<std::string, std::string> Leases; // item key => owner
+    Leases mLeases;
+
+    boost::thread mHeartbeat;
+};
+
+#endif
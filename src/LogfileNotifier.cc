@@ -29,8 +29,17 @@
 
 #include "LogfileNotifier.h"
 
+#include "InitLogger.h"
+
 #include <milog/Logger.h>
 
+LogfileNotifier::LogfileNotifier()
+{
+    // detail level 4=DEBUG corresponds to Message::DEBUG=0, 0=FATAL to Message::FATAL=4
+    const int level = Message::FATAL - LoggerDetailLevel();
+    setLevel(Message::Level(level < Message::DEBUG ? Message::DEBUG : level));
+}
+
 void LogfileNotifier::sendText(Message::Level level, const std::string& message)
 {
     const milog::LogLevel milogLevels[] = { milog::DEBUG, milog::INFO, milog::WARN, milog::ERROR, milog::FATAL };
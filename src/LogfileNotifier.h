@@ -38,6 +38,9 @@
 class LogfileNotifier : public Notifier
 {
 public:
+    /** Drops messages below the most detailed level of the log streams. */
+    LogfileNotifier();
+
     virtual void sendText(Message::Level level, const std::string& message);
 };
 
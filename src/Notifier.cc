@@ -39,33 +39,91 @@ const char* levelNames[] = { "DEBUG", "INFO", "WARNING", "ERROR", "FATAL" };
 
 // ========================================================================
 
+MessageBuffer::MessageBuffer()
+{
+    setp(mInline, mInline + INLINE_SIZE);
+}
+
+// ------------------------------------------------------------------------
+
+std::string MessageBuffer::str() const
+{
+    return mOverflow + std::string(pbase(), pptr());
+}
+
+// ------------------------------------------------------------------------
+
+bool MessageBuffer::empty() const
+{
+    return mOverflow.empty() && pbase() == pptr();
+}
+
+// ------------------------------------------------------------------------
+
+void MessageBuffer::clear()
+{
+    mOverflow.clear();
+    setp(mInline, mInline + INLINE_SIZE);
+}
+
+// ------------------------------------------------------------------------
+
+MessageBuffer::int_type MessageBuffer::overflow(int_type c)
+{
+    mOverflow.append(pbase(), pptr());
+    setp(mInline, mInline + INLINE_SIZE);
+    if( !traits_type::eq_int_type(c, traits_type::eof()) ) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+// ========================================================================
+
 Message::Message(Level level, Notifier* n, const std::string& category)
-    : mStream(new std::ostringstream)
-    , mLevel(level)
+    : mLevel(level)
     , mNotifier(n)
-    , mCategory(category)
+    , mEnabled(!n || n->isEnabled(level))
+    , mStream(&mBuffer)
+{
+    if( mEnabled )
+        mCategory = category;
+}
+
+// ------------------------------------------------------------------------
+
+Message::Message(Message&& other)
+    : mLevel(other.mLevel)
+    , mNotifier(other.mNotifier)
+    , mEnabled(other.mEnabled)
+    , mCategory(other.mCategory)
+    , mStream(&mBuffer)
 {
+    if( mEnabled && !other.mBuffer.empty() )
+        mStream << other.mBuffer.str();
+    other.mEnabled = false;
 }
 
 // ------------------------------------------------------------------------
 
 Message::~Message()
 {
-    std::string msg = mStream->str();
-    if( !msg.empty() ) {
-        msg = mCategory + ": " + msg;
-        if( mNotifier )
-            mNotifier->sendText( mLevel, msg );
-        else
-            std::cerr << std::setw(7) << levelNames[mLevel] << ": " << msg << std::endl;
-    }
+    if( !mEnabled || mBuffer.empty() )
+        return;
+
+    const std::string msg = mCategory + ": " + mBuffer.str();
+    if( mNotifier )
+        mNotifier->sendText( mLevel, msg );
+    else
+        std::cerr << std::setw(7) << levelNames[mLevel] << ": " << msg << std::endl;
 }
 
 // ------------------------------------------------------------------------
 
 void Message::reset()
 {
-    mStream->str("");
+    mBuffer.clear();
 }
 
 // ------------------------------------------------------------------------
@@ -86,17 +144,23 @@ template Message& Message::operator<< <Instrument>      (const Instrument& t);
 
 Message& Message::operator<<(const char* t)
 {
-    *mStream << t; return *this;
+    if( mEnabled )
+        mStream << t;
+    return *this;
 }
 
 template<>
 Message& Message::operator<< <kvtime::time>(const kvtime::time& t)
 {
-    *mStream << kvtime::iso(t); return *this;
+    if( mEnabled )
+        mStream << kvtime::iso(t);
+    return *this;
 }
 
 template<>
 Message& Message::operator<< <kvtime::date>    (const kvtime::date& d)
 {
-    *mStream << kvtime::iso(d); return *this;
+    if( mEnabled )
+        mStream << kvtime::iso(d);
+    return *this;
 }
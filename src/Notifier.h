@@ -30,22 +30,63 @@
 #ifndef Notifier_H
 #define Notifier_H
 
-#include <iosfwd>
-#include <memory>
+#include <ostream>
+#include <streambuf>
 #include <string>
 
 class Notifier;
 
 // #######################################################################
 
+/**
+ * Stream buffer keeping short texts in an inline array; only longer
+ * texts need heap memory.
+ */
+class MessageBuffer : public std::streambuf {
+public:
+    MessageBuffer();
+
+    std::string str() const;
+    bool empty() const;
+    void clear();
+
+protected:
+    virtual int_type overflow(int_type c);
+
+private:
+    MessageBuffer(const MessageBuffer&);
+    MessageBuffer& operator=(const MessageBuffer&);
+
+private:
+    enum { INLINE_SIZE = 256 };
+    char mInline[INLINE_SIZE];
+    std::string mOverflow;
+};
+
+// #######################################################################
+
+/**
+ * A message that is sent to the notifier when destroyed.
+ *
+ * If the notifier does not want messages of this level, the message
+ * is disabled at construction and ignores everything streamed into
+ * it. Arguments are still evaluated, so callers of expensive
+ * formatting functions should check enabled() first.
+ */
 class Message {
 public:
     enum Level { DEBUG, INFO, WARNING, ERROR, FATAL };
 
     Message(Level level, Notifier* n, const std::string& category);
 
+    /** Takes over the text; the other message will not send anything. */
+    Message(Message&& other);
+
     ~Message();
 
+    bool enabled() const
+        { return mEnabled; }
+
     void reset();
 
     template<class T>
@@ -54,10 +95,16 @@ public:
     Message& operator<<(const char* t);
 
 private:
-    std::shared_ptr<std::ostringstream> mStream;
+    Message(const Message&);
+    Message& operator=(const Message&);
+
+private:
     Level mLevel;
     Notifier* mNotifier;
-    const std::string mCategory;
+    bool mEnabled;
+    std::string mCategory;
+    MessageBuffer mBuffer;
+    std::ostream mStream;
 };
 
 // #######################################################################
@@ -71,8 +118,24 @@ private:
 class Notifier
 {
 public:
+    Notifier()
+        : mLevel(Message::DEBUG) { }
+
     virtual ~Notifier() { }
     virtual void sendText(Message::Level level, const std::string& message) = 0;
+
+    /** Messages below this level are dropped without being formatted. */
+    void setLevel(Message::Level level)
+        { mLevel = level; }
+
+    Message::Level level() const
+        { return mLevel; }
+
+    bool isEnabled(Message::Level level) const
+        { return level >= mLevel; }
+
+private:
+    Message::Level mLevel;
 };
 
 #endif
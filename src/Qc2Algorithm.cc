@@ -32,9 +32,12 @@
 #include "helpers/AlgorithmHelpers.h"
 #include "Broadcaster.h"
 #include "DBInterface.h"
+#include "Findings.h"
+#include "RunControl.h"
 #include "foreach.h"
 
 #include <milog/milog.h>
+#include <boost/bind.hpp>
 
 Qc2Algorithm::Qc2Algorithm(const std::string& name)
     : missing(-32767)
@@ -42,8 +45,12 @@ Qc2Algorithm::Qc2Algorithm(const std::string& name)
     , mDatabase(0)
     , mBroadcaster(0)
     , mNotifier(0)
+    , mFindings(0)
+    , mRunControl(0)
+    , mWriteBehind(new WriteBehindDB)
     , mName(name)
 {
+    mWriteBehind->setWrittenCallback(boost::bind(&Qc2Algorithm::logWritten, this, _1, _2));
 }
 
 Qc2Algorithm::~Qc2Algorithm()
@@ -74,25 +81,61 @@ void Qc2Algorithm::updateSingle(const kvalobs::kvData& update)
 
 void Qc2Algorithm::storeData(const DBInterface::DataList& toUpdate, const DBInterface::DataList& toInsert)
 {
-    database()->storeData(toUpdate, toInsert);
-    foreach(const kvalobs::kvData& i, toInsert) {
-        broadcaster()->queueChanged(i);
-        info() << "NEW ROW " << Helpers::datatext(i);
-    }
-    foreach(const kvalobs::kvData& u, toUpdate) {
-        broadcaster()->queueChanged(u);
-        info() << "UPDATE " << Helpers::datatext(u);
+    // queued, and broadcast and logged after writing, see WriteBehindDB
+    mWriteBehind->storeData(toUpdate, toInsert);
+}
+
+void Qc2Algorithm::logWritten(const DBInterface::DataList& updated, const DBInterface::DataList& inserted)
+{
+    if( isEnabled(Message::INFO) ) {
+        foreach(const kvalobs::kvData& i, inserted)
+            info() << "NEW ROW " << Helpers::datatext(i);
+        foreach(const kvalobs::kvData& u, updated)
+            info() << "UPDATE " << Helpers::datatext(u);
     }
-    broadcaster()->sendChanges();
+}
+
+void Qc2Algorithm::flushWrites()
+{
+    mWriteBehind->flush();
+}
+
+std::size_t Qc2Algorithm::discardWrites()
+{
+    return mWriteBehind->discard();
 }
 
 void Qc2Algorithm::configure(const AlgorithmConfig& params)
 {
     UT0            = params.UT0;
     UT1            = params.UT1;
+    UT0lookback    = (params.UT0lookback < params.UT0) ? params.UT0lookback : params.UT0;
     CFAILED_STRING = params.CFAILED_STRING;
     missing        = params.missing;
     rejected       = params.rejected;
+    mWriteBehind->setLimits(params.WriteBatchRows, params.WriteBatchMilliseconds);
+}
+
+bool Qc2Algorithm::shouldStop()
+{
+    return mRunControl && mRunControl->shouldStop();
+}
+
+bool Qc2Algorithm::isStationSkipped(int stationid) const
+{
+    return mRunControl && mRunControl->skipsStation(stationid);
+}
+
+void Qc2Algorithm::stoppedBefore(int stationid)
+{
+    if( mRunControl )
+        mRunControl->stoppedBefore(stationid);
+}
+
+void Qc2Algorithm::report(const Finding& finding)
+{
+    if( mFindings )
+        mFindings->write(name(), finding);
 }
 
 Message Qc2Algorithm::message(Message::Level level)
@@ -33,11 +33,16 @@
 #include "AlgorithmConfig.h"
 #include "DBInterface.h"
 #include "Notifier.h"
+#include "WriteBehindDB.h"
 #include <kvalobs/kvStation.h>
 #include <kvalobs/kvData.h>
 #include <list>
+#include <memory>
 
 class Broadcaster;
+class FindingsWriter;
+class RunControl;
+struct Finding;
 
 // #######################################################################
 
@@ -54,17 +59,32 @@ public:
 
     virtual void run() = 0;
 
+    /**
+     * If stations may be split into shards run separately; false if the
+     * result for a station depends on results for other stations written
+     * in the same run.
+     */
+    virtual bool canSplitStations() const
+        { return true; }
+
     void setBroadcaster(Broadcaster* b)
-        { mBroadcaster = b; }
+        { mBroadcaster = b; mWriteBehind->setBroadcaster(b); }
 
     Broadcaster* broadcaster() const
         { return mBroadcaster; }
 
     void setDatabase(DBInterface* db)
-        { mDatabase = db; }
+        { mDatabase = db; mWriteBehind->setDatabase(db); }
 
+    /** The database, with storeData() queued in a WriteBehindDB; 0 if none is set. */
     DBInterface* database() const
-        { return mDatabase; }
+        { return mDatabase ? mWriteBehind.get() : 0; }
+
+    /** Write the updates queued by storeData(); to be called after run(). */
+    void flushWrites();
+
+    /** Forget updates that could not be written; returns how many there were. */
+    std::size_t discardWrites();
 
     const std::string& name() const
         { return mName; }
@@ -72,6 +92,13 @@ public:
     void setNotifier(Notifier* n)
         { mNotifier = n; }
 
+    void setFindingsWriter(FindingsWriter* f)
+        { mFindings = f; }
+
+    /** Control for the next run(s); 0 for none. */
+    void setRunControl(RunControl* rc)
+        { mRunControl = rc; }
+
     Message debug()
         { return message(Message::DEBUG); }
 
@@ -84,18 +111,45 @@ public:
     Message error()
         { return message(Message::ERROR); }
 
+    /** Whether messages of the given level are sent anywhere; use to skip expensive formatting. */
+    bool isEnabled(Message::Level level) const
+        { return !mNotifier || mNotifier->isEnabled(level); }
+
+    /** Write a finding, if there is a findings writer. */
+    void report(const Finding& finding);
+
     void fillStationLists(DBInterface::StationList& stations, DBInterface::StationIDList& idList);
     void fillStationIDList(DBInterface::StationIDList& idList);
 
 protected:
+    /** True if the run should stop now, e.g. at shutdown or when its time budget is used up. */
+    bool shouldStop();
+
+    /** True if this run skips the station, e.g. because a previous run that stopped early has finished it. */
+    bool isStationSkipped(int stationid) const;
+
+    /** Record that the run stops before finishing this station. */
+    void stoppedBefore(int stationid);
+
     void updateSingle(const kvalobs::kvData& update);
     void storeData(const DBInterface::DataList& toUpdate, const DBInterface::DataList& toInsert = DBInterface::DataList());
 
 private:
     Message message(Message::Level level);
 
+    /** Log the rows written for storeData(). */
+    void logWritten(const DBInterface::DataList& updated, const DBInterface::DataList& inserted);
+
 protected:
     kvtime::time UT0, UT1;
+
+    /**
+     * Earliest time to search for the start of something ending in
+     * UT0..UT1, e.g. an accumulation; UT0 except for backfill chunks,
+     * where it is the start of the whole backfill, so that chunks find
+     * the same as one run over the whole time range.
+     */
+    kvtime::time UT0lookback;
     std::string CFAILED_STRING;
     float missing, rejected;
 
@@ -103,6 +157,9 @@ private:
     DBInterface* mDatabase;
     Broadcaster* mBroadcaster;
     Notifier* mNotifier;
+    FindingsWriter* mFindings;
+    RunControl* mRunControl;
+    std::unique_ptr<WriteBehindDB> mWriteBehind;
     std::string mName;
 };
 
@@ -31,6 +31,7 @@
 
 #include "AlgorithmRunner.h"
 #include "foreach.h"
+#include "KvalobsDbPool.h"
 #include "helpers/timeutil.h"
 
 #include <kvalobs/kvPath.h>
@@ -41,6 +42,8 @@
 #include <milog/milog.h>
 
 #include <boost/bind.hpp>
+#include <algorithm>
+#include <cstdlib>
 #include <signal.h>
 #include <stdexcept>
 
@@ -66,6 +69,13 @@ std::string getValue(const std::string& key, std::shared_ptr<miutil::conf::ConfS
     return val.front().valAsString();
 }
 
+std::string getOptionalValue(const std::string& key, std::shared_ptr<miutil::conf::ConfSection> conf)
+{
+    if (!conf || conf->getValue(key).empty())
+        return std::string();
+    return getValue(key, conf);
+}
+
 } // namespace
 
 
@@ -73,9 +83,14 @@ Qc2App::Qc2App(int argc, char **argv, std::shared_ptr<miutil::conf::ConfSection>
     : confSection(conf)
     , app(kvservice::KvApp::create("kvqc2", argc, argv, confSection))
     , mShouldShutdown(false)
+    , backfillDays_(0)
+    , backfillThreads_(1)
+    , shards_(0)
+    , leaseSeconds_(300)
 {
     setSigHandlers();
     initializeKAFKA();
+    readOnlyConnectString_ = getOptionalValue("database.dbconnect_readonly", confSection);
 
     for (int i=1; i<argc; ++i) {
         const std::string argi(argv[i]);
@@ -86,6 +101,33 @@ Qc2App::Qc2App(int argc, char **argv, std::shared_ptr<miutil::conf::ConfSection>
             } else {
                 LOGERROR("Missing argument to '" << argi << "', ignored");
             }
+        } else if (argi == "--backfill-days" || argi == "--backfill-threads" || argi == "--backfill-state") {
+            i += 1;
+            if (i >= argc) {
+                LOGERROR("Missing argument to '" << argi << "', ignored");
+            } else if (argi == "--backfill-days") {
+                backfillDays_ = std::atoi(argv[i]);
+            } else if (argi == "--backfill-threads") {
+                backfillThreads_ = std::atoi(argv[i]);
+            } else {
+                backfillStateFile_ = argv[i];
+            }
+        } else if (argi == "--shards" || argi == "--lease-seconds") {
+            i += 1;
+            if (i >= argc) {
+                LOGERROR("Missing argument to '" << argi << "', ignored");
+            } else if (argi == "--shards") {
+                shards_ = std::atoi(argv[i]);
+            } else {
+                leaseSeconds_ = std::atoi(argv[i]);
+            }
+        } else if (argi == "--findings") {
+            i += 1;
+            if (i < argc) {
+                findingsFile_ = argv[i];
+            } else {
+                LOGERROR("Missing argument to '" << argi << "', ignored");
+            }
         }
     }
 }
@@ -95,29 +137,37 @@ Qc2App::~Qc2App()
     shutdownKAFKA();
 }
 
-dnmi::db::Connection* Qc2App::getNewDbConnection()
+dnmi::db::Connection* Qc2App::getNewDbConnection(bool readOnly)
 {
-    // FIXME this is almost the same as CurrentKvApp.cc createConnection
-    std::string dbdriver;
-    if (confSection) {
-        dbdriver = getValue("database.dbdriver", confSection);
-        std::cout <<  "FROM CONFIGURATION FILE: " << dbdriver << std::endl;
-    }
+    std::string driverId;
+    {
+        // the driver is loaded only once
+        boost::mutex::scoped_lock lock(mDbMutex);
+        if (driverId_.empty()) {
+            // FIXME this is almost the same as CurrentKvApp.cc createConnection
+            std::string dbdriver;
+            if (confSection) {
+                dbdriver = getValue("database.dbdriver", confSection);
+                LOGINFO("Database driver from configuration file: " << dbdriver);
+            }
 
-    if (dbdriver.empty()) {
-        // use postgresql as a last guess.
-        dbdriver = "pgdriver.so";
-    }
+            if (dbdriver.empty()) {
+                // use postgresql as a last guess.
+                dbdriver = "pgdriver.so";
+            }
 
-    std::string driverId;
-    if (!dnmi::db::DriverManager::loadDriver(dbdriver, driverId)) {
-        std::ostringstream msg;
-        msg << "Unable to load database driver '" << dbdriver << "'.";
-        throw std::runtime_error(msg.str());
+            if (!dnmi::db::DriverManager::loadDriver(dbdriver, driverId_)) {
+                std::ostringstream msg;
+                msg << "Unable to load database driver '" << dbdriver << "'.";
+                throw std::runtime_error(msg.str());
+            }
+        }
+        driverId = driverId_;
     }
 
     // FIXME this is almost the same as CurrentKvApp.cc createConnection
-    std::string connectString = getValue("database.dbconnect", confSection);
+    const std::string connectString = (readOnly && hasReadOnlyDb())
+        ? readOnlyConnectString_ : getValue("database.dbconnect", confSection);
     return dnmi::db::DriverManager::connect(driverId, connectString);
 }
 
@@ -127,6 +177,19 @@ void Qc2App::releaseDbConnection(dnmi::db::Connection *con)
     dnmi::db::DriverManager::releaseConnection(con);
 }
 
+KvalobsDbPool& Qc2App::dbPool(bool readOnly)
+{
+    readOnly &= hasReadOnlyDb();
+    boost::mutex::scoped_lock lock(mPoolMutex);
+    std::unique_ptr<KvalobsDbPool>& pool = readOnly ? mReadOnlyDbPool : mDbPool;
+    if (!pool) {
+        pool.reset(new KvalobsDbPool(*this, readOnly));
+        // one connection per backfill thread, plus one for work leases
+        pool->warmUp(std::max(backfillThreads_, 1) + ((shards_ > 0 && !readOnly) ? 1 : 0));
+    }
+    return *pool;
+}
+
 void Qc2App::initializeKAFKA()
 {
     mProducerThread.reset(new kvalobs::service::KafkaProducerThread);
@@ -159,7 +222,10 @@ void Qc2App::runAlgorithms()
         runner.runAlgorithms();
     } else {
         for (std::vector<std::string>::const_iterator it = algorithmFiles_.begin(); it != algorithmFiles_.end(); ++it) {
-            runner.runOneAlgorithm(*it);
+            if (backfillDays_ > 0 || shards_ > 0)
+                runner.runBackfill(*it, backfillDays_, backfillThreads_, backfillStateFile_, shards_, leaseSeconds_);
+            else
+                runner.runOneAlgorithm(*it);
         }
     }
 }
@@ -38,9 +38,12 @@
 
 #include <boost/thread.hpp>
 
+#include <memory>
 #include <string>
 #include <vector>
 
+class KvalobsDbPool;
+
 class Qc2App
 {
 public:
@@ -51,6 +54,10 @@ public:
     const std::vector<std::string>& algorithmFiles() const
         { return algorithmFiles_; }
 
+    /** File for JSON-lines findings from --findings, or empty. */
+    const std::string& findingsFile() const
+        { return findingsFile_; }
+
     void run();
 
     bool sendDataToKvService(const std::list<kvalobs::kvData>& data, bool &busy);
@@ -61,12 +68,21 @@ public:
     bool isShuttingDown();
 
     /**
-     * Creates a new connection to the database. The caller must
-     * call releaseDbConnection after use.
+     * Creates a new connection to the database. If readOnly is true
+     * and database.dbconnect_readonly is configured, the connection is
+     * to that read-only replica. The caller must call
+     * releaseDbConnection after use.
      */
-    dnmi::db::Connection *getNewDbConnection();
+    dnmi::db::Connection *getNewDbConnection(bool readOnly = false);
     void releaseDbConnection(dnmi::db::Connection *con);
 
+    /** True if database.dbconnect_readonly is configured. */
+    bool hasReadOnlyDb() const
+        { return !readOnlyConnectString_.empty(); }
+
+    /** Connections for KvalobsDB, to the primary or, if readOnly, to the read-only replica. */
+    KvalobsDbPool& dbPool(bool readOnly = false);
+
 private:
     void initializeKAFKA();
     void runKAFKA();
@@ -83,7 +99,19 @@ private:
 
     std::unique_ptr<kvalobs::service::KafkaProducerThread> mProducerThread;
 
+    boost::mutex mDbMutex; // for driverId_
+    std::string driverId_;
+    std::string readOnlyConnectString_;
+    boost::mutex mPoolMutex;
+    std::unique_ptr<KvalobsDbPool> mDbPool, mReadOnlyDbPool;
+
     std::vector<std::string> algorithmFiles_;
+    std::string findingsFile_;
+    int backfillDays_;
+    int backfillThreads_;
+    std::string backfillStateFile_;
+    int shards_;
+    int leaseSeconds_;
 };
 
 #endif
@@ -0,0 +1,166 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "RunControl.h"
+
+#include "AlgorithmConfig.h"
+#include "foreach.h"
+#include "helpers/stringutil.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+RunControl::RunControl()
+    : mHasDeadline(false)
+    , mResumeStation(-1)
+    , mShard(0)
+    , mShards(1)
+    , mStop(false)
+    , mStoppedStation(-1)
+{
+}
+
+// ------------------------------------------------------------------------
+
+void RunControl::setBudget(int seconds)
+{
+    mHasDeadline = (seconds > 0);
+    if( mHasDeadline )
+        mDeadline = clock::now() + std::chrono::seconds(seconds);
+}
+
+// ------------------------------------------------------------------------
+
+bool RunControl::skipsStation(int stationid) const
+{
+    if( stationid < mResumeStation )
+        return true;
+    return mShards > 1 && (stationid % mShards) != mShard;
+}
+
+// ------------------------------------------------------------------------
+
+bool RunControl::shouldStop()
+{
+    if( mStop.load() )
+        return true;
+    if( (mCancelled && mCancelled()) || (mHasDeadline && clock::now() >= mDeadline) )
+        mStop.store(true);
+    return mStop.load();
+}
+
+// ------------------------------------------------------------------------
+
+void RunControl::stoppedBefore(int stationid)
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    if( mStoppedStation < 0 || stationid < mStoppedStation )
+        mStoppedStation = stationid;
+}
+
+// ------------------------------------------------------------------------
+
+int RunControl::stoppedStation() const
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    return mStoppedStation;
+}
+
+// ========================================================================
+
+ResumePoints::ResumePoints(const std::string& filename)
+    : mFilename(filename)
+{
+    read();
+}
+
+// ------------------------------------------------------------------------
+
+int ResumePoints::find(const AlgorithmConfig& params) const
+{
+    const Entries::const_iterator it = mEntries.find(params.filename());
+    if( it == mEntries.end() || it->second.UT0 != params.UT0 || it->second.UT1 != params.UT1 )
+        return -1;
+    return it->second.stationid;
+}
+
+// ------------------------------------------------------------------------
+
+void ResumePoints::update(const AlgorithmConfig& params, int stationid)
+{
+    if( stationid < 0 ) {
+        if( mEntries.erase(params.filename()) == 0 )
+            return;
+    } else {
+        Entry& e = mEntries[params.filename()];
+        e.UT0 = params.UT0;
+        e.UT1 = params.UT1;
+        e.stationid = stationid;
+    }
+    write();
+}
+
+// ------------------------------------------------------------------------
+
+void ResumePoints::read()
+{
+    if( mFilename.empty() )
+        return;
+    std::ifstream in(mFilename.c_str());
+    std::string line;
+    while( std::getline(in, line) ) {
+        const Helpers::splitN_t fields = Helpers::splitN(line, "\t");
+        if( fields.size() != 4 )
+            continue;
+        Entry& e = mEntries[fields[0]];
+        e.UT0 = kvtime::maketime(fields[1]);
+        e.UT1 = kvtime::maketime(fields[2]);
+        e.stationid = std::atoi(fields[3].c_str());
+    }
+}
+
+// ------------------------------------------------------------------------
+
+void ResumePoints::write() const
+{
+    if( mFilename.empty() )
+        return;
+    const std::string tmp = mFilename + ".new";
+    {
+        std::ofstream out(tmp.c_str());
+        foreach(const Entries::value_type& fe, mEntries) {
+            out << fe.first << '\t' << kvtime::iso(fe.second.UT0) << '\t' << kvtime::iso(fe.second.UT1)
+                << '\t' << fe.second.stationid << '\n';
+        }
+        if( !out )
+            return;
+    }
+    std::rename(tmp.c_str(), mFilename.c_str());
+}
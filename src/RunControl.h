@@ -0,0 +1,147 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef RUNCONTROL_H
+#define RUNCONTROL_H 1
+
+#include "helpers/timeutil.h"
+
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+
+class AlgorithmConfig;
+
+/**
+ * \brief Tells a running algorithm when to stop early, and where to
+ * resume.
+ *
+ * An algorithm is asked to stop when it is cancelled (e.g. at
+ * shutdown) or when its time budget is used up. Algorithms working
+ * through stations in increasing stationid order record the first
+ * station they did not finish; the next run with the same
+ * configuration may then skip the stations before it.
+ *
+ * A run may also be restricted to one shard of the stations, so that
+ * several processes can share the work, see doc/RunningOnce.md.
+ *
+ * shouldStop() and stoppedBefore() may be called from several threads.
+ */
+class RunControl {
+public:
+    RunControl();
+
+    /** The run is cancelled as soon as this returns true. */
+    void setCancelled(const boost::function<bool()>& cancelled)
+        { mCancelled = cancelled; }
+
+    /** Stop after this many seconds from now; <= 0 means no budget. */
+    void setBudget(int seconds);
+
+    /** Stations with smaller ids have been done by a previous run; -1 if none. */
+    void setResumeStation(int stationid)
+        { mResumeStation = stationid; }
+
+    int resumeStation() const
+        { return mResumeStation; }
+
+    /** Only run stations with stationid % nShards == shard; nShards <= 1 means all stations. */
+    void setShard(int shard, int nShards)
+        { mShard = shard; mShards = nShards; }
+
+    /** True if the run skips this station, see setResumeStation() and setShard(). */
+    bool skipsStation(int stationid) const;
+
+    bool shouldStop();
+
+    /** Record that the run stopped before finishing this station. */
+    void stoppedBefore(int stationid);
+
+    /** True if shouldStop() has returned true. */
+    bool stopped() const
+        { return mStop.load(); }
+
+    /** Smallest station recorded by stoppedBefore(), or -1. */
+    int stoppedStation() const;
+
+private:
+    typedef std::chrono::steady_clock clock;
+
+    boost::function<bool()> mCancelled;
+    bool mHasDeadline;
+    clock::time_point mDeadline;
+    int mResumeStation;
+    int mShard, mShards;
+
+    std::atomic<bool> mStop;
+    mutable boost::mutex mMutex;
+    int mStoppedStation;
+};
+
+// #######################################################################
+
+/**
+ * \brief Resume stations of runs that stopped early, kept in a file.
+ *
+ * Entries are for a configuration file and its time range UT0--UT1;
+ * a run with a different time range starts from the beginning. In
+ * daemon mode the time range moves with each run, so only runs with
+ * fixed Start and End are resumed.
+ */
+class ResumePoints {
+public:
+    /** An empty filename keeps resume points in memory only. */
+    explicit ResumePoints(const std::string& filename);
+
+    /** Resume station for this configuration, or -1. */
+    int find(const AlgorithmConfig& params) const;
+
+    /** Remember stationid, or forget the entry if stationid < 0. */
+    void update(const AlgorithmConfig& params, int stationid);
+
+private:
+    void read();
+    void write() const;
+
+private:
+    struct Entry {
+        kvtime::time UT0, UT1;
+        int stationid;
+    };
+    typedef std::map<std::string, Entry> Entries;
+
+    const std::string mFilename;
+    Entries mEntries;
+};
+
+#endif
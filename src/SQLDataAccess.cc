@@ -34,6 +34,8 @@
 
 #include <kvalobs/kvQueries.h>
 #include <kvalobs/kvStation.h>
+#include <cstdlib>
+#include <iomanip>
 #include <sstream>
 
 #ifndef NDEBUG
@@ -65,6 +67,17 @@ void formatIDList(std::ostream& sql, const CC& ids, const std::string& column)
     }
 }
 
+std::string quoted(const std::string& text)
+{
+    std::string q = "'";
+    foreach(char c, text) {
+        if( c == '\'' )
+            q += c;
+        q += c;
+    }
+    return q + "'";
+}
+
 const std::string WHERE_FIXED_STATIONS =
                           " WHERE stationid >= 60"
                           "   AND maxspeed = 0"
@@ -98,11 +111,11 @@ DBInterface::StationParamList SQLDataAccess::findStationParams(int stationID, co
                                 + kvQueries::selectStationParam(station, time, qcx));
 }
 
-DBInterface::StationParamList SQLDataAccess::findStationParams(const StationIDList& stationIDs, const std::vector<int>& pids, const std::string& qcxPrefix) throw (DBException)
+DBInterface::StationParamList SQLDataAccess::findStationParams(const StationSet& stations, const std::vector<int>& pids, const std::string& qcxPrefix) throw (DBException)
 {
     std::ostringstream sql;
     sql << kvalobs::kvStationParam().selectAllQuery() << " WHERE ";
-    formatStationIDList(sql, stationIDs);
+    formatStationSet(sql, stations);
     sql << " AND ";
     formatIDList(sql, pids, "paramid");
     sql << " AND qcx LIKE '" << qcxPrefix << "%'";
@@ -111,10 +124,10 @@ DBInterface::StationParamList SQLDataAccess::findStationParams(const StationIDLi
 
 // ------------------------------------------------------------------------
 
-DBInterface::DataList SQLDataAccess::findDataOrderObstime(const StationIDList& stationIDs, int paramID, const TimeRange& time, const FlagSetCU& flags) throw (DBException)
+DBInterface::DataList SQLDataAccess::findDataOrderObstime(const StationSet& stations, int paramID, const TimeRange& time, const FlagSetCU& flags) throw (DBException)
 {
     const std::vector<int> pids(1, paramID), tids(1, DBInterface::INVALID_ID);
-    return findData(stationIDs, pids, tids, INVALID_ID, INVALID_ID, time, flags);
+    return findData(stations, pids, tids, INVALID_ID, INVALID_ID, time, flags);
 }
 
 // ------------------------------------------------------------------------
@@ -158,26 +171,26 @@ DBInterface::DataList SQLDataAccess::findDataOrderObstime(int stationID, const s
 
 // ------------------------------------------------------------------------
 
-DBInterface::DataList SQLDataAccess::findDataOrderObstime(const StationIDList& stationIDs, int paramID, int typeID, const TimeRange& time, const FlagSetCU& flags) throw (DBException)
+DBInterface::DataList SQLDataAccess::findDataOrderObstime(const StationSet& stations, int paramID, int typeID, const TimeRange& time, const FlagSetCU& flags) throw (DBException)
 {
     const std::vector<int> pids(1, paramID), tids(1, typeID);
-    return findData(stationIDs, pids, tids, INVALID_ID, INVALID_ID, time, flags, false);
+    return findData(stations, pids, tids, INVALID_ID, INVALID_ID, time, flags, false);
 }
 
 // ------------------------------------------------------------------------
 
-DBInterface::DataList SQLDataAccess::findDataOrderStationObstime(const StationIDList& stationIDs, const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& time, const FlagSetCU& flags) throw (DBException)
+DBInterface::DataList SQLDataAccess::findDataOrderStationObstime(const StationSet& stations, const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& time, const FlagSetCU& flags) throw (DBException)
 {
-    return findData(stationIDs, pids, tids, INVALID_ID, INVALID_ID, time, flags, true);
+    return findData(stations, pids, tids, INVALID_ID, INVALID_ID, time, flags, true);
 }
 
 // ------------------------------------------------------------------------
 
-DBInterface::DataList SQLDataAccess::findData(const StationIDList& stationIDs, const std::vector<int>& pids, const std::vector<int>& tids, int sensor, int level, const TimeRange& time, const FlagSetCU& flags, bool orderByStation) throw (DBException)
+DBInterface::DataList SQLDataAccess::findData(const StationSet& stations, const std::vector<int>& pids, const std::vector<int>& tids, int sensor, int level, const TimeRange& time, const FlagSetCU& flags, bool orderByStation) throw (DBException)
 {
     std::ostringstream sql;
     sql << kvalobs::kvData().selectAllQuery() + " WHERE ";
-    formatStationIDList(sql, stationIDs);
+    formatStationSet(sql, stations);
     sql << " AND ";
     formatIDList(sql, pids, "paramid");
     sql << " AND ";
@@ -197,11 +210,11 @@ DBInterface::DataList SQLDataAccess::findData(const StationIDList& stationIDs, c
 
 // ------------------------------------------------------------------------
 
-DBInterface::DataList SQLDataAccess::findDataAggregations(const StationIDList& stationIDs, const std::vector<int>& pids, const TimeRange& time, const FlagSetCU& flags) throw (DBException)
+DBInterface::DataList SQLDataAccess::findDataAggregations(const StationSet& stations, const std::vector<int>& pids, const TimeRange& time, const FlagSetCU& flags) throw (DBException)
 {
     std::ostringstream sql;
     sql << kvalobs::kvData().selectAllQuery() + " WHERE ";
-    formatStationIDList(sql, stationIDs);
+    formatStationSet(sql, stations);
     sql << " AND ";
     formatIDList(sql, pids, "paramid");
     sql << " AND typeid < 0"
@@ -213,6 +226,90 @@ DBInterface::DataList SQLDataAccess::findDataAggregations(const StationIDList& s
 
 // ------------------------------------------------------------------------
 
+DBInterface::DataList SQLDataAccess::findDataChangedSince(const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& time, const kvtime::time& tbtime) throw (DBException)
+{
+    std::ostringstream sql;
+    sql << kvalobs::kvData().selectAllQuery() + " WHERE ";
+    formatStationSet(sql, StationSet::norwegian());
+    sql << " AND ";
+    formatIDList(sql, pids, "paramid");
+    sql << " AND ";
+    formatIDList(sql, tids, "typeid");
+    sql << " AND obstime BETWEEN '" << kvtime::iso(time.t0) << "' AND '" << kvtime::iso(time.t1) << "'"
+        << " AND tbtime > '" << kvtime::iso(tbtime) << "'"
+        << " ORDER BY obstime";
+    return extractData(sql.str());
+}
+
+// ------------------------------------------------------------------------
+
+kvtime::time SQLDataAccess::currentTime() throw (DBException)
+{
+    std::ostringstream sql;
+    sql << "SELECT ";
+    formatTimeFromNow(sql, 0);
+    std::string text = extractText(sql.str());
+    // fractions of seconds
+    const std::string::size_type dot = text.find('.');
+    if( dot != std::string::npos )
+        text.erase(dot);
+    return kvtime::maketime(text);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DayCountMap SQLDataAccess::countDataPerDay(const StationSet& stations, const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& time, const FlagSetCU& flags) throw (DBException)
+{
+    std::ostringstream sql;
+    sql << "SELECT date(obstime), COUNT(*) FROM data WHERE ";
+    formatStationSet(sql, stations);
+    sql << " AND ";
+    formatIDList(sql, pids, "paramid");
+    sql << " AND ";
+    formatIDList(sql, tids, "typeid");
+    sql << " AND obstime BETWEEN '" << kvtime::iso(time.t0) << "' AND '" << kvtime::iso(time.t1) << "'"
+        << " AND " << flags.sql()
+        << " GROUP BY date(obstime)";
+
+    return extractDayCounts(sql.str());
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DailyAggregateList SQLDataAccess::findDailyAggregates(int paramid, const std::vector<int>& tids, const kvtime::date& d0, const kvtime::date& d1) throw (DBException)
+{
+    std::ostringstream sql;
+    sql << "SELECT stationid, paramid, typeid, sensor, level, obsdate, value_sum, value_count, bad_count, row_count, computed"
+        << " FROM qc2_statistical_daily_aggregates"
+        << " WHERE paramid = " << paramid << " AND ";
+    formatIDList(sql, tids, "typeid");
+    sql << " AND obsdate BETWEEN '" << kvtime::iso(d0) << "' AND '" << kvtime::iso(d1) << "'"
+        << " ORDER BY stationid, typeid, sensor, level, obsdate";
+    return extractDailyAggregates(sql.str());
+}
+
+// ------------------------------------------------------------------------
+
+void SQLDataAccess::storeDailyAggregates(int paramid, const std::vector<int>& tids, const kvtime::date& d0, const kvtime::date& d1, const DailyAggregateList& aggregates) throw (DBException)
+{
+    std::ostringstream sql;
+    sql << std::setprecision(9)
+        << "BEGIN; DELETE FROM qc2_statistical_daily_aggregates WHERE paramid = " << paramid << " AND ";
+    formatIDList(sql, tids, "typeid");
+    sql << " AND obsdate BETWEEN '" << kvtime::iso(d0) << "' AND '" << kvtime::iso(d1) << "'; ";
+    foreach(const DailyAggregate& a, aggregates) {
+        const Instrument& i = a.instrument;
+        sql << "INSERT INTO qc2_statistical_daily_aggregates VALUES ("
+            << i.stationid << ", " << i.paramid << ", " << i.type << ", '" << i.sensor << "', " << i.level
+            << ", '" << kvtime::iso(a.day) << "', " << a.sum << ", " << a.count << ", " << a.badCount
+            << ", " << a.rowCount << ", '" << kvtime::iso(a.computed) << "'); ";
+    }
+    sql << "COMMIT; " << std::endl;
+    execSQLUpdate(sql.str());
+}
+
+// ------------------------------------------------------------------------
+
 DBInterface::reference_value_map_t SQLDataAccess::findStatisticalReferenceValues(int paramID, const std::string& key, float missingValue) throw (DBException)
 {
     std::ostringstream sql;
@@ -223,6 +320,16 @@ DBInterface::reference_value_map_t SQLDataAccess::findStatisticalReferenceValues
 
 // ------------------------------------------------------------------------
 
+std::string SQLDataAccess::findStatisticalReferenceValuesVersion(int paramID, const std::string& key) throw (DBException)
+{
+    std::ostringstream sql;
+    sql << "SELECT COUNT(*), SUM(stationid), SUM(day_of_year), SUM(value), MIN(value), MAX(value) FROM qc2_statistical_reference_values"
+        << " WHERE paramid = " << paramID << " AND key = '" << key << "'";
+    return extractReadOnlyText(sql.str());
+}
+
+// ------------------------------------------------------------------------
+
 NeighborDataVector SQLDataAccess::findNeighborData(int stationid, int paramid, float maxsigma) throw (DBException)
 {
     std::ostringstream sql;
@@ -236,6 +343,36 @@ NeighborDataVector SQLDataAccess::findNeighborData(int stationid, int paramid, f
 
 // ------------------------------------------------------------------------
 
+NeighborDataMap SQLDataAccess::findNeighborData(const std::vector<int>& paramids) throw (DBException)
+{
+    std::ostringstream sql;
+    sql << "SELECT stationid, paramid, neighborid, fit_offset, fit_slope, fit_sigma FROM qc2_interpolation_best_neighbors"
+        << " WHERE";
+    formatIDList(sql, paramids, "paramid");
+    sql << " AND interpolation_id = 0"
+        << " ORDER BY stationid, paramid, fit_sigma";
+    return extractNeighborDataMap(sql.str());
+}
+
+// ------------------------------------------------------------------------
+
+std::string SQLDataAccess::findNeighborDataVersion(const std::vector<int>& paramids) throw (DBException)
+{
+    std::ostringstream sql;
+    // weighting each row by its stationid makes the checksum change
+    // also when rows or values move between stations
+    sql << "SELECT COUNT(*), SUM(stationid), SUM(neighborid), SUM(stationid * neighborid),"
+        << " SUM(stationid * fit_offset), SUM(stationid * fit_slope), SUM(stationid * fit_sigma),"
+        << " SUM(fit_offset), SUM(fit_slope), SUM(fit_sigma)"
+        << " FROM qc2_interpolation_best_neighbors"
+        << " WHERE";
+    formatIDList(sql, paramids, "paramid");
+    sql << " AND interpolation_id = 0";
+    return extractReadOnlyText(sql.str());
+}
+
+// ------------------------------------------------------------------------
+
 DBInterface::ModelDataList SQLDataAccess::findModelData(int stationID, int paramID, int level, const TimeRange& time) throw (DBException)
 {
     std::ostringstream sql;
@@ -267,12 +404,106 @@ void SQLDataAccess::storeData(const DataList& toUpdate, const DataList& toInsert
 
 // ------------------------------------------------------------------------
 
-void SQLDataAccess::formatStationIDList(std::ostream& sql, const StationIDList& stationIDs)
+void SQLDataAccess::addWorkItems(const std::string& work, const std::vector<std::string>& items) throw (DBException)
 {
-    if( stationIDs.size() == 1 and stationIDs.front() == ALL_STATIONS ) {
-        // no constraint on stationid by default
-        sql << " 0=0 ";
-    } else {
-        formatIDList(sql, stationIDs, "stationid");
+    if( items.empty() )
+        return;
+    std::ostringstream sql;
+    sql << "BEGIN; ";
+    foreach(const std::string& item, items) {
+        sql << "INSERT INTO qc2_work_leases VALUES (" << quoted(work) << ", " << quoted(item)
+            << ", '', '1970-01-01 00:00:00', 0, 0) ON CONFLICT DO NOTHING; ";
+    }
+    sql << "COMMIT; " << std::endl;
+    execSQLUpdate(sql.str());
+}
+
+// ------------------------------------------------------------------------
+
+std::string SQLDataAccess::claimWorkItem(const std::string& work, const std::string& owner, int leaseSeconds, int maxAttempts) throw (DBException)
+{
+    std::ostringstream sql;
+    sql << "BEGIN; UPDATE qc2_work_leases SET done = " << WORK_ITEM_FAILED
+        << " WHERE work = " << quoted(work) << " AND done = 0 AND attempts >= " << maxAttempts << " AND expires <= ";
+    formatTimeFromNow(sql, 0);
+    sql << "; UPDATE qc2_work_leases SET owner = " << quoted(owner) << ", attempts = attempts + 1, expires = ";
+    formatTimeFromNow(sql, leaseSeconds);
+    sql << " WHERE work = " << quoted(work) << " AND item = (SELECT item FROM qc2_work_leases"
+        << " WHERE work = " << quoted(work) << " AND done = 0 AND expires <= ";
+    formatTimeFromNow(sql, 0);
+    sql << " ORDER BY item LIMIT 1";
+    formatSkipLocked(sql);
+    sql << "); COMMIT; " << std::endl;
+    execSQLUpdate(sql.str());
+
+    // owner is unique for each claim
+    std::ostringstream select;
+    select << "SELECT item FROM qc2_work_leases WHERE work = " << quoted(work) << " AND owner = " << quoted(owner)
+           << " AND done = 0 ORDER BY item LIMIT 1";
+    return extractText(select.str());
+}
+
+// ------------------------------------------------------------------------
+
+void SQLDataAccess::renewWorkItem(const std::string& work, const std::string& item, const std::string& owner, int leaseSeconds) throw (DBException)
+{
+    std::ostringstream sql;
+    sql << "UPDATE qc2_work_leases SET expires = ";
+    formatTimeFromNow(sql, leaseSeconds);
+    sql << " WHERE work = " << quoted(work) << " AND item = " << quoted(item) << " AND owner = " << quoted(owner)
+        << " AND done = 0";
+    execSQLUpdate(sql.str());
+}
+
+// ------------------------------------------------------------------------
+
+void SQLDataAccess::finishWorkItem(const std::string& work, const std::string& item, const std::string& owner, bool done) throw (DBException)
+{
+    std::ostringstream sql;
+    sql << "UPDATE qc2_work_leases SET expires = '1970-01-01 00:00:00'";
+    if( done )
+        sql << ", done = 1";
+    sql << " WHERE work = " << quoted(work) << " AND item = " << quoted(item) << " AND owner = " << quoted(owner)
+        << " AND done = 0";
+    execSQLUpdate(sql.str());
+}
+
+// ------------------------------------------------------------------------
+
+int SQLDataAccess::countOpenWorkItems(const std::string& work) throw (DBException)
+{
+    std::ostringstream sql;
+    sql << "SELECT COUNT(*) FROM qc2_work_leases WHERE work = " << quoted(work) << " AND done = 0";
+    return std::atoi(extractText(sql.str()).c_str());
+}
+
+// ------------------------------------------------------------------------
+
+void SQLDataAccess::formatStationSet(std::ostream& sql, const StationSet& stations)
+{
+    if( stations.isList() ) {
+        formatIDList(sql, stations.stationIDs(), "stationid");
+        return;
+    }
+
+    sql << ' ';
+    if( stations.hasRange() )
+        sql << "stationid BETWEEN " << stations.first() << " AND " << stations.last();
+    if( stations.isFixedOnly() ) {
+        if( stations.hasRange() )
+            sql << " AND ";
+        formatFixedStations(sql, stations);
     }
+    if( !stations.hasRange() && !stations.isFixedOnly() ) {
+        // all stations, no constraint on stationid
+        sql << "0=0";
+    }
+    sql << ' ';
+}
+
+// ------------------------------------------------------------------------
+
+void SQLDataAccess::formatFixedStations(std::ostream& sql, const StationSet&)
+{
+    sql << "stationid IN (SELECT stationid FROM station WHERE maxspeed = 0)";
 }
@@ -40,39 +40,86 @@ public:
     virtual StationIDList findFixedStationIDs() throw (DBException);
 
     virtual StationParamList findStationParams(int stationID, const kvtime::time& time, const std::string& qcx) throw (DBException);
-    virtual StationParamList findStationParams(const StationIDList& stationIDs, const std::vector<int>& pids, const std::string& qcxPrefix) throw (DBException);
+    virtual StationParamList findStationParams(const StationSet& stations, const std::vector<int>& pids, const std::string& qcxPrefix) throw (DBException);
 
-    virtual DataList findDataOrderObstime(const StationIDList& stationIDs, int pid, const TimeRange& time, const FlagSetCU& flags) throw (DBException);
+    virtual DataList findDataOrderObstime(const StationSet& stations, int pid, const TimeRange& time, const FlagSetCU& flags) throw (DBException);
     virtual DataList findDataOrderObstime(int stationID, int paramID, const TimeRange& time) throw (DBException);
     virtual DataList findDataOrderObstime(int stationID, int paramID, int typeID, const TimeRange& time) throw (DBException);
     virtual DataList findDataOrderObstime(int stationID, int paramID, int typeID, int sensor, int level, const TimeRange& t) throw (DBException);
     virtual DataList findDataMaybeTSLOrderObstime(int stationID, int paramID, int typeID, int sensor, int level, const TimeRange& t, const FlagSetCU& flags) throw (DBException);
     virtual DataList findDataOrderObstime(int stationID, const std::vector<int>& pids, const std::vector<int>& tids, int sensor, int level, const TimeRange& time, const FlagSetCU& flags) throw (DBException);
-    virtual DataList findDataOrderObstime(const StationIDList& stationIDs, int paramID, int typeID, const TimeRange& t, const FlagSetCU& flags) throw (DBException);
-    virtual DataList findDataOrderStationObstime(const StationIDList& stationIDs, const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& t, const FlagSetCU& flags) throw (DBException);
-    virtual DataList findDataAggregations(const StationIDList& stationIDs, const std::vector<int>& pids, const TimeRange& t, const FlagSetCU& flags) throw (DBException);
+    virtual DataList findDataOrderObstime(const StationSet& stations, int paramID, int typeID, const TimeRange& t, const FlagSetCU& flags) throw (DBException);
+    virtual DataList findDataOrderStationObstime(const StationSet& stations, const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& t, const FlagSetCU& flags) throw (DBException);
+    virtual DataList findDataAggregations(const StationSet& stations, const std::vector<int>& pids, const TimeRange& t, const FlagSetCU& flags) throw (DBException);
+    virtual DataList findDataChangedSince(const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& t, const kvtime::time& tbtime) throw (DBException);
+    virtual kvtime::time currentTime() throw (DBException);
+    virtual DayCountMap countDataPerDay(const StationSet& stations, const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& t, const FlagSetCU& flags) throw (DBException);
+
+    virtual DailyAggregateList findDailyAggregates(int paramid, const std::vector<int>& tids, const kvtime::date& d0, const kvtime::date& d1) throw (DBException);
+    virtual void storeDailyAggregates(int paramid, const std::vector<int>& tids, const kvtime::date& d0, const kvtime::date& d1, const DailyAggregateList& aggregates) throw (DBException);
 
     virtual reference_value_map_t findStatisticalReferenceValues(int paramid, const std::string& key, float missingValue) throw (DBException);
+    virtual std::string findStatisticalReferenceValuesVersion(int paramid, const std::string& key) throw (DBException);
     virtual NeighborDataVector findNeighborData(int stationid, int paramid, float maxsigma) throw (DBException);
+    virtual NeighborDataMap findNeighborData(const std::vector<int>& paramids) throw (DBException);
+    virtual std::string findNeighborDataVersion(const std::vector<int>& paramids) throw (DBException);
 
     virtual ModelDataList findModelData(int stationID, int paramID, int level, const TimeRange& time) throw (DBException);
 
     virtual void storeData(const DataList& toUpdate, const DataList& toInsert) throw (DBException);
 
+    virtual void addWorkItems(const std::string& work, const std::vector<std::string>& items) throw (DBException);
+    virtual std::string claimWorkItem(const std::string& work, const std::string& owner, int leaseSeconds, int maxAttempts) throw (DBException);
+    virtual void renewWorkItem(const std::string& work, const std::string& item, const std::string& owner, int leaseSeconds) throw (DBException);
+    virtual void finishWorkItem(const std::string& work, const std::string& item, const std::string& owner, bool done) throw (DBException);
+    virtual int countOpenWorkItems(const std::string& work) throw (DBException);
+
 protected:
     virtual StationList extractStations(const std::string& sql) throw (DBException) = 0;
     virtual StationIDList extractStationIDs(const std::string& sql) throw (DBException) = 0;
     virtual StationParamList extractStationParams(const std::string& sql) throw (DBException) = 0;
     virtual DataList extractData(const std::string& sql) throw (DBException) = 0;
     virtual reference_value_map_t extractStatisticalReferenceValues(const std::string& sql, float missingValue) throw (DBException) = 0;
+    virtual DailyAggregateList extractDailyAggregates(const std::string& sql) throw (DBException) = 0;
+
+    /** Rows with a date and a count. */
+    virtual DayCountMap extractDayCounts(const std::string& sql) throw (DBException) = 0;
     virtual NeighborDataVector extractNeighborData(const std::string& sql) throw (DBException) = 0;
+    virtual NeighborDataMap extractNeighborDataMap(const std::string& sql) throw (DBException) = 0;
+    virtual std::string extractText(const std::string& sql) throw (DBException) = 0;
+
+    /**
+     * Like extractText(), for tables that kvqc2d never writes; read from the
+     * same connection as the other queries on these tables, so that a
+     * version matches the values read with it.
+     */
+    virtual std::string extractReadOnlyText(const std::string& sql) throw (DBException)
+        { return extractText(sql); }
+
     virtual ModelDataList extractModelData(const std::string& sql) throw (DBException) = 0;
     virtual void execSQLUpdate(const std::string& sql) throw (DBException) = 0;
 
-    virtual void formatStationIDList(std::ostream& sql, const StationIDList& stationIDs);
+    /** Append a WHERE condition selecting the given stations. */
+    void formatStationSet(std::ostream& sql, const StationSet& stations);
+
+    /**
+     * Append a condition selecting the fixed stations; the set is passed
+     * so that the condition may be narrowed to its range.
+     */
+    virtual void formatFixedStations(std::ostream& sql, const StationSet& stations);
+
+    /** Append a clause that makes a SELECT skip rows locked by other transactions, if the database has one. */
+    virtual void formatSkipLocked(std::ostream& sql)
+        { }
+
+    /** Append an expression for the database's current UTC time plus seconds, comparable to TIMESTAMP columns. */
+    virtual void formatTimeFromNow(std::ostream& sql, int seconds) = 0;
 
 private:
-    virtual DataList findData(const StationIDList& stationIDs, const std::vector<int>& pids, const std::vector<int>& tids, int sensor, int level, const TimeRange& time, const FlagSetCU& flags, bool orderByStation=false) throw (DBException);
+    /** Value of qc2_work_leases.done for items given up after too many attempts. */
+    enum { WORK_ITEM_FAILED = 2 };
+
+    virtual DataList findData(const StationSet& stations, const std::vector<int>& pids, const std::vector<int>& tids, int sensor, int level, const TimeRange& time, const FlagSetCU& flags, bool orderByStation=false) throw (DBException);
 };
 
 #endif /* SQLDataAccess_h */
@@ -0,0 +1,99 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "StationSet.h"
+
+#include "DBInterface.h"
+
+#include <algorithm>
+
+StationSet::StationSet()
+    : mIsList(false)
+    , mFixedOnly(false)
+    , mHasRange(false)
+    , mFirst(0)
+    , mLast(0)
+{
+}
+
+// ------------------------------------------------------------------------
+
+StationSet::StationSet(const StationIDList& stationIDs)
+    : mIsList(true)
+    , mStationIDs(stationIDs)
+    , mFixedOnly(false)
+    , mHasRange(false)
+    , mFirst(0)
+    , mLast(0)
+{
+    if( stationIDs.size() == 1 and stationIDs.front() == DBInterface::ALL_STATIONS )
+        *this = norwegian();
+}
+
+// ------------------------------------------------------------------------
+
+StationSet StationSet::fixed()
+{
+    StationSet s;
+    s.mFixedOnly = true;
+    return s;
+}
+
+// ------------------------------------------------------------------------
+
+StationSet StationSet::norwegian()
+{
+    return fixed().range(60, 99999);
+}
+
+// ------------------------------------------------------------------------
+
+StationSet& StationSet::range(int first, int last)
+{
+    if( mHasRange ) {
+        mFirst = std::max(mFirst, first);
+        mLast  = std::min(mLast,  last);
+    } else {
+        mFirst = first;
+        mLast  = last;
+        mHasRange = true;
+    }
+    return *this;
+}
+
+// ------------------------------------------------------------------------
+
+bool StationSet::mayContain(int stationid) const
+{
+    if( mHasRange && (stationid < mFirst || stationid > mLast) )
+        return false;
+    if( mIsList )
+        return std::find(mStationIDs.begin(), mStationIDs.end(), stationid) != mStationIDs.end();
+    return true;
+}
@@ -0,0 +1,99 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef STATIONSET_H
+#define STATIONSET_H 1
+
+#include <list>
+
+/**
+ * \brief Selects the stations for a database query.
+ *
+ * A set is either an explicit list of stationids, or all stations,
+ * possibly restricted to the fixed ones (maxspeed = 0 in table
+ * station) and to a range of stationids. The database turns the set
+ * into a WHERE clause, so that rows from other stations are never
+ * fetched.
+ */
+class StationSet {
+public:
+    typedef std::list<int> StationIDList;
+
+    /** All stations. */
+    StationSet();
+
+    /**
+     * The listed stations. For compatibility, a list containing only
+     * DBInterface::ALL_STATIONS means norwegian().
+     */
+    StationSet(const StationIDList& stationIDs);
+
+    /** Fixed stations, i.e. not ships etc. */
+    static StationSet fixed();
+
+    /** Fixed stations with a Norwegian stationid, see Helpers::isNorwegianStationId. */
+    static StationSet norwegian();
+
+    /** Restrict to stationids first..last, inclusive. */
+    StationSet& range(int first, int last);
+
+    bool isList() const
+        { return mIsList; }
+
+    const StationIDList& stationIDs() const
+        { return mStationIDs; }
+
+    bool isFixedOnly() const
+        { return mFixedOnly; }
+
+    bool hasRange() const
+        { return mHasRange; }
+
+    int first() const
+        { return mFirst; }
+
+    int last() const
+        { return mLast; }
+
+    /**
+     * False if the station is certainly not in this set. As it is not
+     * known here which stations are fixed, fixed sets may contain all
+     * stations in their range.
+     */
+    bool mayContain(int stationid) const;
+
+private:
+    bool mIsList;
+    StationIDList mStationIDs;
+    bool mFixedOnly;
+    bool mHasRange;
+    int mFirst, mLast;
+};
+
+#endif /* STATIONSET_H */
@@ -0,0 +1,596 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "WriteBehindDB.h"
+
+#include "Broadcaster.h"
+#include "foreach.h"
+#include "helpers/Helpers.h"
+
+#include <milog/milog.h>
+#include <boost/thread/mutex.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <set>
+#include <sstream>
+
+namespace {
+
+template<class C>
+bool containsID(const C& ids, int id, int wildcard)
+{
+    if( ids.size() == 1 && ids.front() == wildcard )
+        return true;
+    return std::find(ids.begin(), ids.end(), id) != ids.end();
+}
+
+} // anonymous namespace
+
+// ########################################################################
+
+struct WriteBehindDB::Queue {
+    typedef std::chrono::steady_clock clock;
+
+    Queue();
+
+    /** The rows of one storeData() call, or a row refused by the database. */
+    struct Group {
+        DataList toUpdate, toInsert;
+        int attempts;
+    };
+    typedef std::list<Group> Groups;
+
+    void append(const DataList& toUpdate, const DataList& toInsert);
+    void add(const Group& group);
+    void flush();
+    bool contains(const StationSet& stations, const std::vector<int>& pids) const;
+    void clear();
+
+    bool write(const Group& group);
+    void writeAlone(const Group& group, Groups& refused);
+    void written(const Group& group);
+
+    boost::mutex mutex;
+    DBInterface* writer;
+    Broadcaster* broadcaster;
+    WrittenCallback callback;
+    int maxRows, maxMilliseconds;
+    int transactions;
+
+    Groups groups; // in the order of the storeData() calls
+    std::size_t rows, lost;
+    typedef std::pair<int, int> StationParam;
+    std::set<StationParam> instruments;
+    clock::time_point oldest;
+};
+
+// ------------------------------------------------------------------------
+
+WriteBehindDB::Queue::Queue()
+    : writer(0)
+    , broadcaster(0)
+    , maxRows(1)
+    , maxMilliseconds(0)
+    , transactions(0)
+    , rows(0)
+    , lost(0)
+{
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::Queue::append(const DataList& u, const DataList& i)
+{
+    const Group group = { u, i, 0 };
+    add(group);
+
+    if( (int)rows >= maxRows
+        || clock::now() >= oldest + std::chrono::milliseconds(maxMilliseconds) )
+    {
+        flush();
+    }
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::Queue::add(const Group& group)
+{
+    if( groups.empty() )
+        oldest = clock::now();
+    groups.push_back(group);
+    rows += group.toInsert.size() + group.toUpdate.size();
+    foreach(const kvalobs::kvData& d, group.toInsert)
+        instruments.insert(std::make_pair(d.stationID(), d.paramID()));
+    foreach(const kvalobs::kvData& d, group.toUpdate)
+        instruments.insert(std::make_pair(d.stationID(), d.paramID()));
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::Queue::flush()
+{
+    if( groups.empty() )
+        return;
+
+    Group all = { DataList(), DataList(), 0 };
+    foreach(const Group& g, groups) {
+        all.toUpdate.insert(all.toUpdate.end(), g.toUpdate.begin(), g.toUpdate.end());
+        all.toInsert.insert(all.toInsert.end(), g.toInsert.begin(), g.toInsert.end());
+    }
+    // the database may have reconnected, so the first failure is retried at once
+    Groups refused;
+    if( write(all) || write(all) ) {
+        foreach(const Group& g, groups)
+            written(g);
+    } else {
+        // some row is bad; write the storeData() calls, or their rows, alone so that the others are written
+        foreach(const Group& g, groups)
+            writeAlone(g, refused);
+    }
+    clear();
+    if( broadcaster )
+        broadcaster->sendChanges();
+    if( refused.empty() )
+        return;
+
+    // refused rows are tried again in the next flush, up to MAX_ROW_ATTEMPTS times
+    std::size_t givenUp = 0;
+    foreach(Group& r, refused) {
+        r.attempts += 1;
+        if( r.attempts < MAX_ROW_ATTEMPTS ) {
+            add(r);
+        } else {
+            LOGERROR("Giving up writing " << Helpers::datatext(r.toUpdate.empty() ? r.toInsert.front() : r.toUpdate.front())
+                    << " after " << r.attempts << " attempts");
+            givenUp += 1;
+        }
+    }
+    lost += givenUp;
+    std::ostringstream msg;
+    msg << refused.size() << " rows could not be written, " << givenUp << " of them were given up";
+    throw DBException(msg.str());
+}
+
+// ------------------------------------------------------------------------
+
+bool WriteBehindDB::Queue::write(const Group& group)
+{
+    try {
+        writer->storeData(group.toUpdate, group.toInsert);
+        transactions += 1;
+        return true;
+    } catch(DBException& e) {
+        LOGWARN("Could not write " << (group.toUpdate.size() + group.toInsert.size()) << " rows: " << e.what());
+        return false;
+    }
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::Queue::writeAlone(const Group& group, Groups& refused)
+{
+    if( group.toUpdate.size() + group.toInsert.size() > 1 ) {
+        if( write(group) ) {
+            written(group);
+            return;
+        }
+    }
+    foreach(const kvalobs::kvData& d, group.toInsert) {
+        const Group row = { DataList(), DataList(1, d), group.attempts };
+        if( write(row) )
+            written(row);
+        else
+            refused.push_back(row);
+    }
+    foreach(const kvalobs::kvData& d, group.toUpdate) {
+        const Group row = { DataList(1, d), DataList(), group.attempts };
+        if( write(row) )
+            written(row);
+        else
+            refused.push_back(row);
+    }
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::Queue::written(const Group& group)
+{
+    if( broadcaster ) {
+        foreach(const kvalobs::kvData& d, group.toInsert)
+            broadcaster->queueChanged(d);
+        foreach(const kvalobs::kvData& d, group.toUpdate)
+            broadcaster->queueChanged(d);
+    }
+    if( callback )
+        callback(group.toUpdate, group.toInsert);
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::Queue::clear()
+{
+    groups.clear();
+    rows = 0;
+    instruments.clear();
+}
+
+// ------------------------------------------------------------------------
+
+bool WriteBehindDB::Queue::contains(const StationSet& stations, const std::vector<int>& pids) const
+{
+    foreach(const StationParam& sp, instruments) {
+        if( stations.mayContain(sp.first) && containsID(pids, sp.second, INVALID_ID) )
+            return true;
+    }
+    return false;
+}
+
+// ########################################################################
+
+WriteBehindDB::WriteBehindDB()
+    : mDatabase(0)
+    , mQueue(new Queue)
+{
+}
+
+// ------------------------------------------------------------------------
+
+WriteBehindDB::WriteBehindDB(DBInterface* db, std::shared_ptr<Queue> queue)
+    : mOwnedDatabase(db)
+    , mDatabase(db)
+    , mQueue(queue)
+{
+}
+
+// ------------------------------------------------------------------------
+
+WriteBehindDB::~WriteBehindDB()
+{
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::setDatabase(DBInterface* db)
+{
+    boost::mutex::scoped_lock lock(mQueue->mutex);
+    mDatabase = db;
+    mQueue->writer = db;
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::setBroadcaster(Broadcaster* b)
+{
+    boost::mutex::scoped_lock lock(mQueue->mutex);
+    mQueue->broadcaster = b;
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::setWrittenCallback(const WrittenCallback& cb)
+{
+    boost::mutex::scoped_lock lock(mQueue->mutex);
+    mQueue->callback = cb;
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::setLimits(int maxRows, int maxMilliseconds)
+{
+    boost::mutex::scoped_lock lock(mQueue->mutex);
+    mQueue->maxRows = maxRows;
+    mQueue->maxMilliseconds = maxMilliseconds;
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::flush() throw (DBException)
+{
+    boost::mutex::scoped_lock lock(mQueue->mutex);
+    mQueue->flush();
+}
+
+// ------------------------------------------------------------------------
+
+std::size_t WriteBehindDB::discard()
+{
+    boost::mutex::scoped_lock lock(mQueue->mutex);
+    const std::size_t n = mQueue->rows + mQueue->lost;
+    mQueue->clear();
+    mQueue->lost = 0;
+    return n;
+}
+
+// ------------------------------------------------------------------------
+
+std::size_t WriteBehindDB::queued() const
+{
+    boost::mutex::scoped_lock lock(mQueue->mutex);
+    return mQueue->rows;
+}
+
+// ------------------------------------------------------------------------
+
+int WriteBehindDB::transactions() const
+{
+    boost::mutex::scoped_lock lock(mQueue->mutex);
+    return mQueue->transactions;
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::flushFor(const StationSet& stations, const std::vector<int>& pids)
+{
+    boost::mutex::scoped_lock lock(mQueue->mutex);
+    if( mQueue->contains(stations, pids) )
+        mQueue->flush();
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::flushFor(int stationID, int paramID)
+{
+    flushFor(StationIDList(1, stationID), std::vector<int>(1, paramID));
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::StationList WriteBehindDB::findFixedStations() throw (DBException)
+{
+    return mDatabase->findFixedStations();
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::StationIDList WriteBehindDB::findFixedStationIDs() throw (DBException)
+{
+    return mDatabase->findFixedStationIDs();
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::StationParamList WriteBehindDB::findStationParams(int stationID, const kvtime::time& time, const std::string& qcx) throw (DBException)
+{
+    return mDatabase->findStationParams(stationID, time, qcx);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::StationParamList WriteBehindDB::findStationParams(const StationSet& stations, const std::vector<int>& pids, const std::string& qcxPrefix) throw (DBException)
+{
+    return mDatabase->findStationParams(stations, pids, qcxPrefix);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DataList WriteBehindDB::findDataOrderObstime(const StationSet& stations, int pid, const TimeRange& time, const FlagSetCU& flags) throw (DBException)
+{
+    flushFor(stations, std::vector<int>(1, pid));
+    return mDatabase->findDataOrderObstime(stations, pid, time, flags);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DataList WriteBehindDB::findDataOrderObstime(int stationID, int paramID, const TimeRange& time) throw (DBException)
+{
+    flushFor(stationID, paramID);
+    return mDatabase->findDataOrderObstime(stationID, paramID, time);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DataList WriteBehindDB::findDataOrderObstime(int stationID, int paramID, int typeID, const TimeRange& time) throw (DBException)
+{
+    flushFor(stationID, paramID);
+    return mDatabase->findDataOrderObstime(stationID, paramID, typeID, time);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DataList WriteBehindDB::findDataOrderObstime(int stationID, int paramID, int typeID, int sensor, int level, const TimeRange& t) throw (DBException)
+{
+    flushFor(stationID, paramID);
+    return mDatabase->findDataOrderObstime(stationID, paramID, typeID, sensor, level, t);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DataList WriteBehindDB::findDataMaybeTSLOrderObstime(int stationID, int paramID, int typeID, int sensor, int level, const TimeRange& t, const FlagSetCU& flags) throw (DBException)
+{
+    flushFor(stationID, paramID);
+    return mDatabase->findDataMaybeTSLOrderObstime(stationID, paramID, typeID, sensor, level, t, flags);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DataList WriteBehindDB::findDataOrderObstime(int stationID, const std::vector<int>& pids, const std::vector<int>& tids, int sensor, int level, const TimeRange& time, const FlagSetCU& flags) throw (DBException)
+{
+    flushFor(StationIDList(1, stationID), pids);
+    return mDatabase->findDataOrderObstime(stationID, pids, tids, sensor, level, time, flags);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DataList WriteBehindDB::findDataOrderObstime(const StationSet& stations, int paramID, int typeID, const TimeRange& t, const FlagSetCU& flags) throw (DBException)
+{
+    flushFor(stations, std::vector<int>(1, paramID));
+    return mDatabase->findDataOrderObstime(stations, paramID, typeID, t, flags);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DataList WriteBehindDB::findDataOrderStationObstime(const StationSet& stations, const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& t, const FlagSetCU& flags) throw (DBException)
+{
+    flushFor(stations, pids);
+    return mDatabase->findDataOrderStationObstime(stations, pids, tids, t, flags);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DataList WriteBehindDB::findDataAggregations(const StationSet& stations, const std::vector<int>& pids, const TimeRange& t, const FlagSetCU& flags) throw (DBException)
+{
+    flushFor(stations, pids);
+    return mDatabase->findDataAggregations(stations, pids, t, flags);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DataList WriteBehindDB::findDataChangedSince(const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& t, const kvtime::time& tbtime) throw (DBException)
+{
+    flushFor(StationSet::norwegian(), pids);
+    return mDatabase->findDataChangedSince(pids, tids, t, tbtime);
+}
+
+// ------------------------------------------------------------------------
+
+kvtime::time WriteBehindDB::currentTime() throw (DBException)
+{
+    return mDatabase->currentTime();
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DayCountMap WriteBehindDB::countDataPerDay(const StationSet& stations, const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& t, const FlagSetCU& flags) throw (DBException)
+{
+    flushFor(stations, pids);
+    return mDatabase->countDataPerDay(stations, pids, tids, t, flags);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DailyAggregateList WriteBehindDB::findDailyAggregates(int paramid, const std::vector<int>& tids, const kvtime::date& d0, const kvtime::date& d1) throw (DBException)
+{
+    return mDatabase->findDailyAggregates(paramid, tids, d0, d1);
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::storeDailyAggregates(int paramid, const std::vector<int>& tids, const kvtime::date& d0, const kvtime::date& d1, const DailyAggregateList& aggregates) throw (DBException)
+{
+    mDatabase->storeDailyAggregates(paramid, tids, d0, d1, aggregates);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::reference_value_map_t WriteBehindDB::findStatisticalReferenceValues(int paramid, const std::string& key, float missingValue) throw (DBException)
+{
+    return mDatabase->findStatisticalReferenceValues(paramid, key, missingValue);
+}
+
+// ------------------------------------------------------------------------
+
+std::string WriteBehindDB::findStatisticalReferenceValuesVersion(int paramid, const std::string& key) throw (DBException)
+{
+    return mDatabase->findStatisticalReferenceValuesVersion(paramid, key);
+}
+
+// ------------------------------------------------------------------------
+
+NeighborDataVector WriteBehindDB::findNeighborData(int stationid, int paramid, float maxsigma) throw (DBException)
+{
+    return mDatabase->findNeighborData(stationid, paramid, maxsigma);
+}
+
+// ------------------------------------------------------------------------
+
+NeighborDataMap WriteBehindDB::findNeighborData(const std::vector<int>& paramids) throw (DBException)
+{
+    return mDatabase->findNeighborData(paramids);
+}
+
+// ------------------------------------------------------------------------
+
+std::string WriteBehindDB::findNeighborDataVersion(const std::vector<int>& paramids) throw (DBException)
+{
+    return mDatabase->findNeighborDataVersion(paramids);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::ModelDataList WriteBehindDB::findModelData(int stationID, int paramID, int level, const TimeRange& time) throw (DBException)
+{
+    return mDatabase->findModelData(stationID, paramID, level, time);
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::storeData(const DataList& toUpdate, const DataList& toInsert) throw (DBException)
+{
+    if( toUpdate.empty() && toInsert.empty() )
+        return;
+    boost::mutex::scoped_lock lock(mQueue->mutex);
+    mQueue->append(toUpdate, toInsert);
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::addWorkItems(const std::string& work, const std::vector<std::string>& items) throw (DBException)
+{
+    mDatabase->addWorkItems(work, items);
+}
+
+// ------------------------------------------------------------------------
+
+std::string WriteBehindDB::claimWorkItem(const std::string& work, const std::string& owner, int leaseSeconds, int maxAttempts) throw (DBException)
+{
+    return mDatabase->claimWorkItem(work, owner, leaseSeconds, maxAttempts);
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::renewWorkItem(const std::string& work, const std::string& item, const std::string& owner, int leaseSeconds) throw (DBException)
+{
+    mDatabase->renewWorkItem(work, item, owner, leaseSeconds);
+}
+
+// ------------------------------------------------------------------------
+
+void WriteBehindDB::finishWorkItem(const std::string& work, const std::string& item, const std::string& owner, bool done) throw (DBException)
+{
+    mDatabase->finishWorkItem(work, item, owner, done);
+}
+
+// ------------------------------------------------------------------------
+
+int WriteBehindDB::countOpenWorkItems(const std::string& work) throw (DBException)
+{
+    return mDatabase->countOpenWorkItems(work);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface* WriteBehindDB::newConnection()
+{
+    DBInterface* db = mDatabase->newConnection();
+    if( !db )
+        return 0;
+    return new WriteBehindDB(db, mQueue);
+}
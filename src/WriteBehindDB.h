@@ -0,0 +1,154 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef WRITEBEHINDDB_H
+#define WRITEBEHINDDB_H 1
+
+#include "DBInterface.h"
+
+#include <boost/function.hpp>
+
+#include <memory>
+
+class Broadcaster;
+
+/**
+ * \brief Collects storeData() calls and writes them in one transaction.
+ *
+ * Queued rows are written, and then broadcast, when there are
+ * maxRows of them, when the oldest has waited maxMilliseconds at the
+ * next storeData(), when flush() is called, and before a data query
+ * that could return one of them (same stationid and paramid). There
+ * is no timer: as the database connection is used by the algorithm's
+ * thread, rows queued before a long computation without storeData()
+ * or queries wait until it ends.
+ *
+ * If writing fails, it is tried once more, as the database may have
+ * reconnected. If that fails, too, each storeData() call is written
+ * alone, and the rows of a call that still fails are written one by
+ * one. Rows the database refuses stay queued and the DBException is
+ * passed on; after failing in MAX_ROW_ATTEMPTS flushes, a row is given
+ * up, logged and counted by discard().
+ *
+ * Other queries are passed to the database directly. Connections from
+ * newConnection() share the queue, so that worker threads see the
+ * rows queued by others; all queued rows are written through the
+ * database given to setDatabase().
+ */
+class WriteBehindDB : public DBInterface {
+public:
+    /** Number of flushes a refused row is tried in before it is given up. */
+    enum { MAX_ROW_ATTEMPTS = 3 };
+
+    WriteBehindDB();
+    virtual ~WriteBehindDB();
+
+    /** Database for queries and for writing; must not be changed while rows are queued. */
+    void setDatabase(DBInterface* db);
+
+    /** Broadcaster for written rows, may be 0. */
+    void setBroadcaster(Broadcaster* b);
+
+    typedef boost::function<void(const DataList& updated, const DataList& inserted)> WrittenCallback;
+
+    /** Called with the rows of each successful write, after the commit; may be empty. */
+    void setWrittenCallback(const WrittenCallback& cb);
+
+    /** maxRows <= 1 writes each storeData() call at once. */
+    void setLimits(int maxRows, int maxMilliseconds);
+
+    /** Write all queued rows. */
+    void flush() throw (DBException);
+
+    /** Forget all queued rows; returns how many there were, plus the rows lost since the last discard(). */
+    std::size_t discard();
+
+    /** Number of queued rows. */
+    std::size_t queued() const;
+
+    /** Number of successful writes so far. */
+    int transactions() const;
+
+    virtual StationList findFixedStations() throw (DBException);
+    virtual StationIDList findFixedStationIDs() throw (DBException);
+
+    virtual StationParamList findStationParams(int stationID, const kvtime::time& time, const std::string& qcx) throw (DBException);
+    virtual StationParamList findStationParams(const StationSet& stations, const std::vector<int>& pids, const std::string& qcxPrefix) throw (DBException);
+
+    virtual DataList findDataOrderObstime(const StationSet& stations, int pid, const TimeRange& time, const FlagSetCU& flags) throw (DBException);
+    virtual DataList findDataOrderObstime(int stationID, int paramID, const TimeRange& time) throw (DBException);
+    virtual DataList findDataOrderObstime(int stationID, int paramID, int typeID, const TimeRange& time) throw (DBException);
+    virtual DataList findDataOrderObstime(int stationID, int paramID, int typeID, int sensor, int level, const TimeRange& t) throw (DBException);
+    virtual DataList findDataMaybeTSLOrderObstime(int stationID, int paramID, int typeID, int sensor, int level, const TimeRange& t, const FlagSetCU& flags) throw (DBException);
+    virtual DataList findDataOrderObstime(int stationID, const std::vector<int>& pids, const std::vector<int>& tids, int sensor, int level, const TimeRange& time, const FlagSetCU& flags) throw (DBException);
+    virtual DataList findDataOrderObstime(const StationSet& stations, int paramID, int typeID, const TimeRange& t, const FlagSetCU& flags) throw (DBException);
+    virtual DataList findDataOrderStationObstime(const StationSet& stations, const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& t, const FlagSetCU& flags) throw (DBException);
+    virtual DataList findDataAggregations(const StationSet& stations, const std::vector<int>& pids, const TimeRange& t, const FlagSetCU& flags) throw (DBException);
+    virtual DataList findDataChangedSince(const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& t, const kvtime::time& tbtime) throw (DBException);
+    virtual kvtime::time currentTime() throw (DBException);
+    virtual DayCountMap countDataPerDay(const StationSet& stations, const std::vector<int>& pids, const std::vector<int>& tids, const TimeRange& t, const FlagSetCU& flags) throw (DBException);
+
+    virtual DailyAggregateList findDailyAggregates(int paramid, const std::vector<int>& tids, const kvtime::date& d0, const kvtime::date& d1) throw (DBException);
+    virtual void storeDailyAggregates(int paramid, const std::vector<int>& tids, const kvtime::date& d0, const kvtime::date& d1, const DailyAggregateList& aggregates) throw (DBException);
+
+    virtual reference_value_map_t findStatisticalReferenceValues(int paramid, const std::string& key, float missingValue) throw (DBException);
+    virtual std::string findStatisticalReferenceValuesVersion(int paramid, const std::string& key) throw (DBException);
+
+    virtual NeighborDataVector findNeighborData(int stationid, int paramid, float maxsigma) throw (DBException);
+    virtual NeighborDataMap findNeighborData(const std::vector<int>& paramids) throw (DBException);
+    virtual std::string findNeighborDataVersion(const std::vector<int>& paramids) throw (DBException);
+
+    virtual ModelDataList findModelData(int stationID, int paramID, int level, const TimeRange& time) throw (DBException);
+
+    /** Queue the rows; they are written later, see flush(). */
+    virtual void storeData(const DataList& toUpdate, const DataList& toInsert) throw (DBException);
+
+    virtual void addWorkItems(const std::string& work, const std::vector<std::string>& items) throw (DBException);
+    virtual std::string claimWorkItem(const std::string& work, const std::string& owner, int leaseSeconds, int maxAttempts) throw (DBException);
+    virtual void renewWorkItem(const std::string& work, const std::string& item, const std::string& owner, int leaseSeconds) throw (DBException);
+    virtual void finishWorkItem(const std::string& work, const std::string& item, const std::string& owner, bool done) throw (DBException);
+    virtual int countOpenWorkItems(const std::string& work) throw (DBException);
+
+    /** Opens a new connection for queries, sharing the queue with this one. */
+    virtual DBInterface* newConnection();
+
+private:
+    struct Queue;
+    WriteBehindDB(DBInterface* db, std::shared_ptr<Queue> queue);
+
+    void flushFor(const StationSet& stations, const std::vector<int>& pids);
+    void flushFor(int stationID, int paramID);
+
+private:
+    std::unique_ptr<DBInterface> mOwnedDatabase;
+    DBInterface* mDatabase;
+    std::shared_ptr<Queue> mQueue;
+};
+
+#endif
@@ -36,6 +36,10 @@
 
 #include <kvalobs/kvDataOperations.h>
 
+#include <algorithm>
+#include <map>
+#include <vector>
+
 #define NDEBUG 1
 #include "debug.h"
 
@@ -92,82 +96,153 @@ struct lt_Limits : public std::binary_function<Limits, Limits, bool> {
 
 } // anonymous namespace
 
+/**
+ * Limits per station, parameter, hour and day of year.
+ *
+ * Limits are collected with add() and then compiled into a flat table
+ * with one row of 365 min/max pairs per station, parameter and
+ * hour. Fallbacks -- first to hour -1 of the same station, then to
+ * station 0 -- are resolved when compiling, so find() is a binary
+ * search for the station and a single indexed load.
+ */
 class AggregatorLimits::LimitValues {
 public:
     static const Limits INVALID;
-    Limits find(int stationid, int paramid, int hour, int day);
+    Limits find(int stationid, int paramid, int hour, int day) const;
     void add(int stationid, int paramid, int hour, int dayFrom, int dayTo, float min, float max);
+    void compile();
 
 private:
     typedef std::list<Limits> LimitsPerDayOfYear;
     typedef std::map<int, LimitsPerDayOfYear> LimitsPerHour;
     typedef std::map<SPInstrument, LimitsPerHour, lt_SPInstrument> LimitsPerStation;
 
+    enum { HOURS = 24, DAYS = 365, SOURCES = 4 };
+
+    struct MinMax {
+        float min, max;
+    };
+
+    /** Indices of the rows for each hour of one station and parameter. */
+    struct Rows {
+        int row[HOURS];
+    };
+
+    typedef std::vector<const LimitsPerDayOfYear*> Sources;
+
 private:
-    bool findInstrument(int stationid, int paramid, int hour, int day, Limits& limits);
-    bool findHour(const LimitsPerHour& lph, int hour, int day, Limits& limits);
-    bool findDayOfYear(const LimitsPerDayOfYear& lpd, int day, Limits& limits);
+    static const LimitsPerDayOfYear* findHour(const LimitsPerHour* lph, int hour);
+    int compileRow(const Sources& sources);
+    int findRows(int stationid, int paramid) const;
 
 private:
     LimitsPerStation lps;
+
+    std::vector<SPInstrument> mInstruments;
+    std::vector<Rows> mRows;
+    std::vector<MinMax> mMinMax;
+    std::map<Sources, int> mCompiledRows;
 };
 
 const Limits AggregatorLimits::LimitValues::INVALID;
 
-bool AggregatorLimits::LimitValues::findInstrument(int stationid, int paramid, int hour, int day, Limits& limits)
+const AggregatorLimits::LimitValues::LimitsPerDayOfYear* AggregatorLimits::LimitValues::findHour(const LimitsPerHour* lph, int hour)
 {
-    const int N = 2, ids[N] = { stationid, 0 };
-    for(int i=0; i<N; ++i) {
-        DBGV(i);
-        LimitsPerStation::const_iterator its = lps.find(SPInstrument(ids[i], paramid));
-        if( its != lps.end() && findHour(its->second, hour, day, limits) )
-            return true;
-    }
-    DBGL;
-    return false;
+    if( !lph )
+        return 0;
+    const LimitsPerHour::const_iterator ith = lph->find(hour);
+    if( ith == lph->end() || ith->second.empty() )
+        return 0;
+    return &ith->second;
 }
 
-bool AggregatorLimits::LimitValues::findHour(const LimitsPerHour& lph, int hour, int day, Limits& limits)
+int AggregatorLimits::LimitValues::compileRow(const Sources& sources)
 {
-    DBGL;
-    LimitsPerHour::const_iterator ith = lph.find(hour);
-    if( ith != lph.end() && findDayOfYear(ith->second, day, limits) )
-        return true;
-    DBGL;
-    ith = lph.find(-1);
-    if( ith != lph.end() && findDayOfYear(ith->second, day, limits) )
-        return true;
-    DBGL;
-    return false;
+    const std::map<Sources, int>::const_iterator it = mCompiledRows.find(sources);
+    if( it != mCompiledRows.end() )
+        return it->second;
+
+    const int row = mMinMax.size() / DAYS;
+    const MinMax invalid = { 1, -1 };
+    mMinMax.resize(mMinMax.size() + DAYS, invalid);
+    MinMax* mm = &mMinMax[row*DAYS];
+
+    // sources are in order of preference, so fill the least preferred first
+    for(Sources::const_reverse_iterator its = sources.rbegin(); its != sources.rend(); ++its) {
+        if( !*its )
+            continue;
+        foreach(const Limits& l, **its) {
+            if( !l.valid() )
+                continue;
+            const MinMax v = { l.min, l.max };
+            std::fill(mm + l.dayFrom - 1, mm + l.dayTo, v);
+        }
+    }
+    mCompiledRows[sources] = row;
+    return row;
 }
 
-bool AggregatorLimits::LimitValues::findDayOfYear(const LimitsPerDayOfYear& lpd, int day, Limits& limits)
+void AggregatorLimits::LimitValues::compile()
 {
-    DBGL;
-    if( lpd.empty() )
-        return false;
+    mInstruments.clear();
+    mRows.clear();
+    mMinMax.clear();
+    mCompiledRows.clear();
+
+    foreach(const LimitsPerStation::value_type& st, lps) {
+        const SPInstrument& instrument = st.first;
+        const LimitsPerHour* lph0 = 0;
+        if( instrument.stationid != 0 ) {
+            const LimitsPerStation::const_iterator it0 = lps.find(SPInstrument(0, instrument.paramid));
+            if( it0 != lps.end() )
+                lph0 = &it0->second;
+        }
 
-    DBGL;
-    LimitsPerDayOfYear::const_iterator itd = std::lower_bound(lpd.begin(), lpd.end(), day, lt_Limits());
-    if( itd == lpd.end() )
-        --itd;
-    DBG(DBG1(itd->dayFrom) << DBG1(itd->dayTo));
-    if( itd->dayFrom <= day && itd->dayTo >= day ) {
-        DBGL;
-        limits = *itd;
-        return true;
+        Rows rows;
+        Sources sources(SOURCES);
+        for(int hour=0; hour<HOURS; ++hour) {
+            sources[0] = findHour(&st.second, hour);
+            sources[1] = findHour(&st.second, -1);
+            sources[2] = findHour(lph0, hour);
+            sources[3] = findHour(lph0, -1);
+            rows.row[hour] = compileRow(sources);
+        }
+        // lps is sorted, so mInstruments will be sorted, too
+        mInstruments.push_back(instrument);
+        mRows.push_back(rows);
     }
-    DBGL;
-    return false;
+    DBG(DBG1(mInstruments.size()) << DBG1(mMinMax.size()/DAYS));
+
+    lps.clear();
+    mCompiledRows.clear();
+}
+
+int AggregatorLimits::LimitValues::findRows(int stationid, int paramid) const
+{
+    const std::vector<SPInstrument>::const_iterator it
+        = std::lower_bound(mInstruments.begin(), mInstruments.end(), SPInstrument(stationid, paramid), lt_SPInstrument());
+    if( it == mInstruments.end() || it->stationid != stationid || it->paramid != paramid )
+        return -1;
+    return it - mInstruments.begin();
 }
 
-Limits AggregatorLimits::LimitValues::find(int stationid, int paramid, int hour, int day)
+Limits AggregatorLimits::LimitValues::find(int stationid, int paramid, int hour, int day) const
 {
     DBG(DBG1(stationid) << DBG1(paramid) << DBG1(hour) << DBG1(day));
-    Limits limits;
-    findInstrument(stationid, paramid, hour, day, limits);
-    DBG(DBG1(limits.dayFrom) << DBG1(limits.dayTo)DBG1(limits.min) << DBG1(limits.max));
-    return limits;
+    if( hour < 0 || hour >= HOURS || day < 1 || day > DAYS )
+        return INVALID;
+
+    int rows = findRows(stationid, paramid);
+    if( rows < 0 && stationid != 0 )
+        rows = findRows(0, paramid);
+    if( rows < 0 )
+        return INVALID;
+
+    const MinMax& mm = mMinMax[mRows[rows].row[hour]*DAYS + day - 1];
+    if( mm.min > mm.max )
+        return INVALID;
+    DBG(DBG1(mm.min) << DBG1(mm.max));
+    return Limits(mm.min, mm.max, day, day);
 }
 
 void AggregatorLimits::LimitValues::add(int stationid, int paramid, int hour, int dayFrom, int dayTo, float min, float max)
@@ -222,6 +297,7 @@ void AggregatorLimits::configure(const AlgorithmConfig& config)
     }
     DBGV(mParameters.size());
 #endif
+    mLimits->compile();
 
     Qc2Algorithm::configure(config);
 }
@@ -252,6 +328,10 @@ void AggregatorLimits::run()
     const DBInterface::DataList outOfRange = database()->findDataAggregations(allStations, mParameters, TimeRange(UT0, UT1), mFlags);
     DBGV(outOfRange.size());
     foreach(const kvalobs::kvData& data, outOfRange) {
+        if( shouldStop() )
+            break;
+        if( isStationSkipped(data.stationID()) )
+            continue;
         DataUpdate du(data);
         DBGV(data);
         const Limits limits = mLimits->find(data.stationID(), data.paramID(), kvtime::hour(data.obstime()), Helpers::normalisedDayOfYear(data.obstime().date()));
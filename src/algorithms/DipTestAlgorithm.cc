@@ -104,6 +104,10 @@ void DipTestAlgorithm::run()
         const DBInterface::DataList candidates = database()->findDataOrderObstime(stationIDs, pid, TimeRange(UT0, UT1), candidate_flags);
         DBGV(candidates.size());
         foreach(const kvalobs::kvData& c, candidates) {
+            if( shouldStop() )
+                return;
+            if( isStationSkipped(c.stationID()) )
+                continue;
             if( c.original() > missing )
                 checkDipAndInterpolate(c, delta);
         }
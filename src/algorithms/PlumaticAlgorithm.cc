@@ -34,6 +34,7 @@
 #include "helpers/stringutil.h"
 #include "helpers/timeutil.h"
 #include "DBInterface.h"
+#include "Findings.h"
 #include "NeighborsDistance2.h"
 #include "Notifier.icc"
 #include "foreach.h"
@@ -43,6 +44,7 @@
 #include <milog/milog.h>
 
 #include <boost/bind.hpp>
+#include <map>
 
 #define NDEBUG 1
 #include "debug.h"
@@ -166,12 +168,24 @@ void PlumaticAlgorithm::configure(const AlgorithmConfig& params)
 void PlumaticAlgorithm::run()
 {
     // use script stinfosys-vipp-pluviometer.pl or change program and use "select stationid from obs_pgm where paramid = 105;"
+    // stations are checked in order of stationid, so a stopped run can resume at a station
+    typedef std::map<int, float> StationResolution;
+    StationResolution stations;
     foreach(const ResolutionStations& rs, mStationlist) {
         foreach(int stationid, rs.stationids) {
             if (Helpers::isNorwegianStationId(stationid))
-                checkStation(stationid, rs.mmpv);
+                stations.insert(std::make_pair(stationid, rs.mmpv));
         }
     }
+    foreach(const StationResolution::value_type& sr, stations) {
+        if (isStationSkipped(sr.first))
+            continue;
+        if (shouldStop()) {
+            stoppedBefore(sr.first);
+            break;
+        }
+        checkStation(sr.first, sr.second);
+    }
 }
 
 // ------------------------------------------------------------------------
@@ -252,6 +266,9 @@ void PlumaticAlgorithm::checkSlidingSum(kvUpdateList_t& data, const SlidingAlarm
 void PlumaticAlgorithm::applyAggregationFlags(kvUpdateList_it start, kvUpdateList_it stop, const SlidingAlarm& slal)
 {
     warning() << "QC2h-1-aggregation-" << slal.length << " triggered for " << stop->text(start->obstime());
+    report(Finding("QC2h-1-aggregation-" + std::to_string(slal.length), stop->data())
+           .from(start->obstime())
+           .value("max", slal.max));
     for(; start != stop; ++start)
         start->setAggregationFlagged(true);
     if( start == stop )
@@ -514,6 +531,8 @@ void PlumaticAlgorithm::flagHighSingle(const Shower& shower)
 {
     shower.first->flagchange(highsingle_flagchange)
         .cfailed("QC2h-1-highsingle", CFAILED_STRING);
+    report(Finding("QC2h-1-highsingle", shower.first->data())
+           .value("original", shower.first->original()));
 }
 
 // ------------------------------------------------------------------------
@@ -525,6 +544,8 @@ void PlumaticAlgorithm::flagHighStart(const Shower& shower, int length)
         it->flagchange(highstart_flagchange)
             .cfailed("QC2h-1-highstart", CFAILED_STRING);
     }
+    report(Finding("QC2h-1-highstart", shower.first->data())
+           .value("length", length));
 }
 
 // ------------------------------------------------------------------------
@@ -657,6 +678,11 @@ void PlumaticAlgorithm::checkNeighborStations(int stationid, int type, kvUpdateL
                         if (foundFW != 0)
                             info() << "updating fw for station " << stationid
                                    << " in 24h before " << nextXX06 << ", probably neighbor data have changed";
+                        if (newFW > 1)
+                            report(Finding("QC2h-1-neighbors", stationid, start->data().paramID(), type, nextXX06)
+                                   .from(start->obstime())
+                                   .value("sum", sum)
+                                   .value("fw", newFW));
                         for (; start != mark; ++start) {
                             start->flagchange(*fc);
                             if (newFW > 1)
@@ -35,6 +35,7 @@
 #include "helpers/timeutil.h"
 #include "algorithms/NeighborsDistance2.h"
 #include "DBInterface.h"
+#include "Findings.h"
 #include "foreach.h"
 #include "Notifier.icc"
 
@@ -114,8 +115,6 @@ std::list<int> RedistributionAlgorithm::findNeighbors(int stationID)
 bool RedistributionAlgorithm::checkEndpoint(const kvalobs::kvData& endpoint)
 {
     DBG("endpoint=" << endpoint);
-    if (!Helpers::isNorwegianStationId(endpoint.stationID()))
-        return false;
     const int m_fhqc = endpoint.controlinfo().flag(kvQCFlagTypes::f_fhqc);
     const bool hqc04 = ( m_fhqc == 0 IF_FUTURE(|| m_fhqc == 4) );
     if( Helpers::isMissingOrRejected(endpoint) ) {
@@ -184,10 +183,14 @@ bool RedistributionAlgorithm::checkAccumulationPeriod(const updateList_t& mdata)
     const RedisUpdate& endpoint = mdata.front();
     if( length == 1 ) {
         const int m_fhqc = endpoint.controlinfo().flag(kvQCFlagTypes::f_fhqc);
-        if( m_fhqc == 0 IF_FUTURE(|| m_fhqc == 4) )
+        if( m_fhqc == 0 IF_FUTURE(|| m_fhqc == 4) ) {
             warning() << "HQC: station=" << endpoint.data().stationID()
                       << " date_to=" << endpoint.obstime()
                       << " message: accumulation without missing rows";
+            report(Finding("QC2-redist-hqc-no-missing", endpoint.data())
+                   .value("original", endpoint.original())
+                   .text("accumulation without missing rows"));
+        }
         return false;
     }
 
@@ -291,6 +294,10 @@ bool RedistributionAlgorithm::checkAccumulationPeriod(const updateList_t& mdata)
                   << " date_from=" << mdata.back().obstime()
                   << " date_to=" << endpoint.obstime()
                   << " message: accumulation with errors" << hqc_bad_sum.str();
+        report(Finding("QC2-redist-hqc-errors", endpoint.data())
+               .from(mdata.back().obstime())
+               .value("original", endpoint.original())
+               .text("accumulation with errors" + hqc_bad_sum.str()));
     }
     return !stop;
 }
@@ -327,6 +334,9 @@ bool RedistributionAlgorithm::findMissing(const kvalobs::kvData& endpoint, const
                       << " date_from=" << it->obstime()
                       << " date_to=" << endpoint.obstime()
                       << " message: missing or bad data in accumulation period";
+            report(Finding("QC2-redist-hqc-missing-or-bad", endpoint)
+                   .from(it->obstime())
+                   .text("missing or bad data in accumulation period"));
         }
         return false;
     }
@@ -412,17 +422,27 @@ void RedistributionAlgorithm::configure(const AlgorithmConfig& params)
 
 void RedistributionAlgorithm::run()
 {
-    const DBInterface::StationIDList stationIDs(1, DBInterface::ALL_STATIONS);
     const DBInterface::DataList edata
-        = database()->findDataOrderStationObstime(stationIDs, pids, tids, TimeRange(UT0, UT1), endpoint_flags);
+        = database()->findDataOrderStationObstime(StationSet::norwegian(), pids, tids, TimeRange(UT0, UT1), endpoint_flags);
 
-    int lastStationId = -1;
-    kvtime::time lastObstime = UT0;
+    int lastStationId = -1, currentStationId = -1;
+    kvtime::time lastObstime = UT0lookback;
     foreach(const kvalobs::kvData& endpoint, edata) {
+        // endpoints are ordered by station, so a stopped run can resume
+        // at a station; skipped stations must not be recorded as stopped
+        if( isStationSkipped(endpoint.stationID()) )
+            continue;
+        if( endpoint.stationID() != currentStationId ) {
+            currentStationId = endpoint.stationID();
+            if( shouldStop() ) {
+                stoppedBefore(currentStationId);
+                break;
+            }
+        }
         if( !checkEndpoint(endpoint) )
             continue;
 
-        const kvtime::time earliestPossibleMissing = ( endpoint.stationID() != lastStationId ) ? UT0 : lastObstime;
+        const kvtime::time earliestPossibleMissing = ( endpoint.stationID() != lastStationId ) ? UT0lookback : lastObstime;
         lastStationId = endpoint.stationID();
         lastObstime   = endpoint.obstime();
 
@@ -568,11 +588,16 @@ bool RedistributionAlgorithm::redistributePrecipitation(updateList_t& before)
         if (!doWARN)
             info() << "accumulation " << accumulated << " > 0 would be redistributed to zeros for endpoint "
                    << before.front().text(before.back().obstime(), false);
-        else
+        else {
             warning() << "HQC: station=" << before.front().data().stationID()
                       << " date_from=" << before.back().obstime()
                       << " date_to=" << before.front().obstime()
                       << " message: non-0 accumulation with dry neighbors";
+            report(Finding("QC2-redist-hqc-dry-neighbors", before.front().data())
+                   .from(before.back().obstime())
+                   .value("accumulated", accumulated)
+                   .text("non-0 accumulation with dry neighbors"));
+        }
         return false;
     }
     float corrected_sum = 0;
@@ -31,10 +31,14 @@
 
 #include "helpers/mathutil.h"
 #include "DBInterface.h"
+#include "Instrument.h"
 #include "foreach.h"
 
 #include <milog/milog.h>
 
+#include <map>
+#include <set>
+
 #ifndef NDEBUG
 #define NDEBUG
 #endif
@@ -42,6 +46,45 @@
 
 using Helpers::equal;
 
+namespace {
+
+typedef std::map<kvtime::time, kvalobs::kvData> TimeSeries;
+typedef std::map<Instrument, TimeSeries, lt_Instrument> InstrumentSeries;
+
+/**
+ * Find the rows directly before and after d in the series of d's
+ * instrument. Succeeds only if these are exactly one hour before and
+ * after d, i.e. if there are exactly three rows in [t-1h, t+1h].
+ */
+bool findNeighbors(const InstrumentSeries& series, const kvalobs::kvData& d, const kvalobs::kvData*& before, const kvalobs::kvData*& after)
+{
+    const InstrumentSeries::const_iterator itI = series.find(Instrument(d));
+    if( itI == series.end() )
+        return false;
+    const TimeSeries& ts = itI->second;
+
+    const TimeSeries::const_iterator itM = ts.find(d.obstime());
+    if( itM == ts.end() || itM == ts.begin() )
+        return false;
+    TimeSeries::const_iterator itB = itM, itA = itM;
+    --itB;
+    ++itA;
+    if( itA == ts.end() )
+        return false;
+
+    kvtime::time timeBefore = d.obstime(), timeAfter = d.obstime();
+    kvtime::addHours(timeBefore, -1);
+    kvtime::addHours(timeAfter, 1);
+    if( itB->first != timeBefore || itA->first != timeAfter )
+        return false;
+
+    before = &itB->second;
+    after  = &itA->second;
+    return true;
+}
+
+} // anonymous namespace
+
 // ########################################################################
 
 SingleLinearAlgorithm::SingleLinearAlgorithm()
@@ -79,26 +122,53 @@ void SingleLinearAlgorithm::run()
         const DBInterface::DataList Qc2Data
             = database()->findDataOrderObstime(stationIDs, pid, TimeRange(UT0, UT1), missing_flags);
         DBGV(Qc2Data.size());
-
+        if( Qc2Data.empty() )
+            continue;
+
+        // fetch the series of all stations with candidates in one query, extended by one hour at each end
+        std::set<int> candidateStations;
+        foreach(const kvalobs::kvData& d, Qc2Data)
+            candidateStations.insert(d.stationID());
+        const DBInterface::StationIDList seriesStationIDs(candidateStations.begin(), candidateStations.end());
+
+        kvtime::time seriesBegin = UT0, seriesEnd = UT1;
+        kvtime::addHours(seriesBegin, -1);
+        kvtime::addHours(seriesEnd, 1);
+        const DBInterface::DataList seriesData
+            = database()->findDataOrderStationObstime(seriesStationIDs, std::vector<int>(1, pid), std::vector<int>(1, DBInterface::INVALID_ID),
+                                                      TimeRange(seriesBegin, seriesEnd), FlagSetCU());
+        DBGV(seriesData.size());
+
+        InstrumentSeries series;
+        foreach(const kvalobs::kvData& s, seriesData)
+            series[Instrument(s)].insert(std::make_pair(s.obstime(), s));
+
+        DBInterface::DataList updates;
+        bool stop = false;
         foreach(const kvalobs::kvData& d, Qc2Data) {
-            kvtime::time timeBefore = d.obstime(), timeAfter = d.obstime();
-            kvtime::addHours(timeBefore, -1);
-            kvtime::addHours(timeAfter, 1);
-
-            const DBInterface::DataList series
-                = database()->findDataOrderObstime(d.stationID(), d.paramID(), d.typeID(), d.sensor(), d.level(), TimeRange(timeBefore, timeAfter));
-            DBGV(series.size());
-            if( series.size() != 3 ) {
-                DBG("got " << series.size() << " neighbors at d=" << d);
+            // rows that are done no longer match missing_flags, so the next run continues here
+            if( shouldStop() ) {
+                stop = true;
+                break;
+            }
+            if( isStationSkipped(d.stationID()) )
+                continue;
+            const kvalobs::kvData *before = 0, *after = 0;
+            if( !findNeighbors(series, d, before, after) ) {
+                DBG("no neighbors one hour before and after d=" << d);
                 continue;
             }
 
             DataUpdate update(d);
-            calculateCorrected(series.front(), update, series.back());
+            calculateCorrected(*before, update, *after);
 
             if( update.needsWrite() )
-                updateSingle(update.data());
+                updates.push_back(update.data());
         }
+        if( !updates.empty() )
+            storeData(updates);
+        if( stop )
+            break;
     }
 }
 
@@ -42,37 +42,76 @@ double Akima::interpolate(double x) const
     const int i = findIndex(x);
     if( i<0  )
         return INVALID;
+    return evaluateSegment(i, x);
+}
 
-    const int N = (int)mX.size()-1;
-    double mmm[5];
-    for(int j=std::max(i-2, 0); j<std::min(i+3, N); ++j)
-        mmm[j-i+2] = (mY[j+1]-mY[j])/(mX[j+1]-mX[j]);
-    if( i < 2 ) {
-        const double m2 = mmm[2-i], m3 = mmm[3-i];
-        mmm[1-i] = 2*m2 - m3;
-        if( i == 0 )
-            mmm[0] = 3*m2 - 2*m3;
-    }
-    if( i > N-3 ) {
-        const double m1 = mmm[N+1-i], m0 = mmm[N-i];
-        mmm[N+2-i] = 2*m1 - m0;
-        if( i > N-2 )
-            mmm[N+3-i] = 3*m1 - 2*m0;
+// ------------------------------------------------------------------------
+
+void Akima::evaluate(const std::vector<double>& xs, std::vector<double>& out) const
+{
+    out.resize(xs.size());
+    const int NX = mX.size();
+    if( xs.empty() )
+        return;
+    int upper = findUpper(xs.front()); // first index with mX[upper] >= x, as std::lower_bound
+    for(std::size_t q=0; q<xs.size(); ++q) {
+        const double x = xs[q];
+        if( q>0 && x < xs[q-1] )
+            upper = findUpper(x); // not sorted, search again
+        while( upper < NX && mX[upper] < x )
+            upper += 1;
+        const int i = segmentIndex(upper, x);
+        out[q] = (i<0) ? INVALID : evaluateSegment(i, x);
     }
+    mHint = upper;
+}
 
-    // TODO llvm clang static analysis complains about mmm[1] in the next line; why?
-    const double a0  = fabs(mmm[1] - mmm[0]), NE0 = a0 + fabs(mmm[3] - mmm[2]);
-    const double tR0 = (NE0>0) ? (mmm[1] + a0*(mmm[2] - mmm[1])/NE0) : mmm[2];
-    const double a1  = fabs(mmm[2] - mmm[1]), NE1 = a1 + fabs(mmm[4] - mmm[3]);
-    const double tL1 = (NE1>0) ? (mmm[2] + a1*(mmm[3] - mmm[2])/NE1) : mmm[2];
-
-    const double h = mX[i+1] - mX[i];
-    const double a = mY[i];
-    const double b = tR0;
-    const double c = (3*mmm[2] - 2*tR0 - tL1)/h;
-    const double d = (tR0 + tL1 - 2*mmm[2])/(h*h);
+// ------------------------------------------------------------------------
+
+double Akima::evaluateSegment(int i, double x) const
+{
+    if( mSegments.empty() )
+        calculateSegments();
+    const Segment& s = mSegments[i];
     const double x0 = x - mX[i];
-    return a + x0*(b + x0*(c + x0*d));
+    return mY[i] + x0*(s.b + x0*(s.c + x0*s.d));
+}
+
+// ------------------------------------------------------------------------
+
+void Akima::calculateSegments() const
+{
+    const int N = (int)mX.size()-1;
+    mSegments.resize(N);
+
+    for(int i=0; i<N; ++i) {
+        double mmm[5];
+        for(int j=std::max(i-2, 0); j<std::min(i+3, N); ++j)
+            mmm[j-i+2] = (mY[j+1]-mY[j])/(mX[j+1]-mX[j]);
+        if( i < 2 ) {
+            const double m2 = mmm[2-i], m3 = mmm[3-i];
+            mmm[1-i] = 2*m2 - m3;
+            if( i == 0 )
+                mmm[0] = 3*m2 - 2*m3;
+        }
+        if( i > N-3 ) {
+            const double m1 = mmm[N+1-i], m0 = mmm[N-i];
+            mmm[N+2-i] = 2*m1 - m0;
+            if( i > N-2 )
+                mmm[N+3-i] = 3*m1 - 2*m0;
+        }
+
+        const double a0  = fabs(mmm[1] - mmm[0]), NE0 = a0 + fabs(mmm[3] - mmm[2]);
+        const double tR0 = (NE0>0) ? (mmm[1] + a0*(mmm[2] - mmm[1])/NE0) : mmm[2];
+        const double a1  = fabs(mmm[2] - mmm[1]), NE1 = a1 + fabs(mmm[4] - mmm[3]);
+        const double tL1 = (NE1>0) ? (mmm[2] + a1*(mmm[3] - mmm[2])/NE1) : mmm[2];
+
+        const double h = mX[i+1] - mX[i];
+        Segment& s = mSegments[i];
+        s.b = tR0;
+        s.c = (3*mmm[2] - 2*tR0 - tL1)/h;
+        s.d = (tR0 + tL1 - 2*mmm[2])/(h*h);
+    }
 }
 
 // ------------------------------------------------------------------------
@@ -92,10 +131,33 @@ int Akima::findIndex(double x) const
     const int N = (int)mX.size()-1;
     if( N<4 || x < mX.front() )
         return -1;
-    std::vector<double>::const_iterator iX1 = std::lower_bound(mX.begin(), mX.end(), x);
-    if( iX1 == mX.end() )
+    return segmentIndex(findUpper(x), x);
+}
+
+// ------------------------------------------------------------------------
+
+int Akima::findUpper(double x) const
+{
+    // try the remembered position and the one after it before searching
+    const int NX = mX.size();
+    for(int u = mHint; u <= std::min(mHint + 1, NX); ++u) {
+        if( (u == 0 || mX[u-1] < x) && (u == NX || mX[u] >= x) ) {
+            mHint = u;
+            return u;
+        }
+    }
+    mHint = std::lower_bound(mX.begin(), mX.end(), x) - mX.begin();
+    return mHint;
+}
+
+// ------------------------------------------------------------------------
+
+int Akima::segmentIndex(int upper, double x) const
+{
+    const int N = (int)mX.size()-1;
+    if( N<4 || x < mX.front() || upper > N )
         return -1;
-    const int i = std::max(0, static_cast<int>(iX1 - mX.begin() - 1));
+    const int i = std::max(0, upper - 1);
     if( i >= N )
         return -1;
     if( x < mX[i] || x > mX[i+1] ) {
@@ -34,28 +34,57 @@
 
 #include <vector>
 
+/**
+ * Akima spline interpolation. The segment coefficients are calculated
+ * once, at the first interpolation after adding support points.
+ *
+ * The segment found last is remembered, so that lookups at increasing
+ * positions need no binary search. Not thread-safe.
+ */
 class Akima {
 public:
+    Akima()
+        : mHint(0) { }
+
     Akima& add(double x, double y)
-        { mX.push_back(x); mY.push_back(y); return *this; }
+        { mX.push_back(x); mY.push_back(y); mSegments.clear(); mHint = 0; return *this; }
 
     void clear()
-        { mX.clear(); mY.clear(); }
+        { mX.clear(); mY.clear(); mSegments.clear(); mHint = 0; }
 
     int count() const
         { return mX.size(); }
 
     double interpolate(double x) const;
 
+    /**
+     * Interpolate at all positions in x, which should be sorted in
+     * increasing order. Uses a moving cursor instead of a binary
+     * search for each position, starting from the segment used last.
+     */
+    void evaluate(const std::vector<double>& x, std::vector<double>& out) const;
+
     double distance(double x) const;
 
     static const double INVALID;
 
 private:
     int findIndex(double x) const;
+    int findUpper(double x) const;
+    int segmentIndex(int upper, double x) const;
+    void calculateSegments() const;
+    double evaluateSegment(int i, double x) const;
 
 private:
     std::vector<double> mX, mY;
+
+    struct Segment {
+        double b, c, d;
+    };
+    mutable std::vector<Segment> mSegments;
+
+    /** Last result of findUpper(). */
+    mutable int mHint;
 };
 
 #endif // AKIMA_H
@@ -29,46 +29,10 @@
 
 #include "AkimaSpline.h"
 
-using namespace std;
-
 // --------------------------------------------------------------------
 
 AkimaSpline::AkimaSpline(const std::vector<double>& xt, const std::vector<double>& yt)
 {
-    const int npoints = xt.size();
-    double xx[npoints], yy[npoints];
-    std::copy(xt.begin(), xt.end(), xx);
-    std::copy(yt.begin(), yt.end(), yy);
-    acc = gsl_interp_accel_alloc();
-    spline = gsl_spline_alloc(gsl_interp_akima, npoints);
-    gsl_spline_init(spline, xx, yy, npoints);
-}
-
-// --------------------------------------------------------------------
-
-AkimaSpline::~AkimaSpline()
-{
-    gsl_spline_free(spline);
-    gsl_interp_accel_free(acc);
-}
-
-// --------------------------------------------------------------------
-
-double AkimaSpline::AkimaPoint(double xp) const
-{
-    return gsl_spline_eval(spline, xp, acc);
+    for(std::size_t i=0; i<xt.size() && i<yt.size(); ++i)
+        mAkima.add(xt[i], yt[i]);
 }
-
-// --------------------------------------------------------------------
-
-// int AkimaSpline::AkimaPoints()
-// {
-//     long nmax=npoints*10;
-//
-//     for (int i = 0; i < nmax +1; i++)  {
-//         xi = tt[0] + (tt[npoints-1] - tt[0])*i/nmax;
-//         yi = AkimaPoint(xi);
-//     }
-//
-//     return 0;
-// }
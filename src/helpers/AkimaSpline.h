@@ -3,33 +3,32 @@
 #ifndef AkimaSpline_H
 #define AkimaSpline_H 1
 
+#include "Akima.h"
+
 #include <vector>
-//GNU Statistical library
-#include <gsl/gsl_errno.h>
-#include <gsl/gsl_spline.h>
 
 using namespace std;
 
-// TODO maybe use template+iterators instead of std::vector
+/**
+ * Akima spline through all points given to the constructor, using
+ * the same interpolation kernel as Akima.
+ */
 class AkimaSpline{
 
 public:
     AkimaSpline(const std::vector<double>& xt, const std::vector<double>& yt);
-    ~AkimaSpline();
 
     double operator() (double x) const
         { return AkimaPoint(x); }
 
-    double AkimaPoint(double x) const;
+    double AkimaPoint(double x) const
+        { return mAkima.interpolate(x); }
 
     double interpolate(double x) const
         { return AkimaPoint(x); }
 
-    //int AkimaPoints();
-
 private:
-    gsl_interp_accel *acc;
-    gsl_spline *spline;
+    Akima mAkima;
 };
 
 #endif
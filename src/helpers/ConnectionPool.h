@@ -0,0 +1,147 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef HELPERS_CONNECTIONPOOL_H_
+#define HELPERS_CONNECTIONPOOL_H_
+
+#include <boost/thread/mutex.hpp>
+
+#include <list>
+
+namespace Helpers {
+
+/**
+ * Keeps open connections for reuse by several threads. How connections
+ * are opened, checked and closed is left to subclasses. The lock is
+ * only held while the list of idle connections is used, so that a
+ * slow connect() does not block other threads.
+ */
+template<class C>
+class ConnectionPool {
+public:
+    virtual ~ConnectionPool() { }
+
+    /** Open connections until nConnections are idle. */
+    void warmUp(int nConnections);
+
+    /** Returns an idle or new connection; 0 if connect() gives up. */
+    C* checkout();
+
+    /** Return a connection; it is released instead of kept if not healthy. */
+    void checkin(C* c, bool healthy = true);
+
+protected:
+    /** Open a new connection; may wait and retry, returns 0 on giving up. */
+    virtual C* connect() = 0;
+
+    /** Checked before an idle connection is handed out again. */
+    virtual bool isConnected(C* c) = 0;
+
+    virtual void release(C* c) = 0;
+
+    /** Release all idle connections; to be called from the destructor of subclasses. */
+    void releaseIdle();
+
+private:
+    boost::mutex mMutex;
+    std::list<C*> mIdle;
+};
+
+// ------------------------------------------------------------------------
+
+template<class C>
+void ConnectionPool<C>::warmUp(int nConnections)
+{
+    while( true ) {
+        {
+            boost::mutex::scoped_lock lock(mMutex);
+            if( (int)mIdle.size() >= nConnections )
+                return;
+        }
+        C* c = connect();
+        if( !c )
+            return;
+        boost::mutex::scoped_lock lock(mMutex);
+        mIdle.push_back(c);
+    }
+}
+
+// ------------------------------------------------------------------------
+
+template<class C>
+C* ConnectionPool<C>::checkout()
+{
+    while( true ) {
+        C* c;
+        {
+            boost::mutex::scoped_lock lock(mMutex);
+            if( mIdle.empty() )
+                break;
+            c = mIdle.front();
+            mIdle.pop_front();
+        }
+        if( isConnected(c) )
+            return c;
+        release(c);
+    }
+    return connect();
+}
+
+// ------------------------------------------------------------------------
+
+template<class C>
+void ConnectionPool<C>::checkin(C* c, bool healthy)
+{
+    if( !c )
+        return;
+    if( !healthy ) {
+        release(c);
+        return;
+    }
+    boost::mutex::scoped_lock lock(mMutex);
+    mIdle.push_back(c);
+}
+
+// ------------------------------------------------------------------------
+
+template<class C>
+void ConnectionPool<C>::releaseIdle()
+{
+    std::list<C*> idle;
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        idle.swap(mIdle);
+    }
+    for(typename std::list<C*>::iterator it = idle.begin(); it != idle.end(); ++it)
+        release(*it);
+}
+
+} // namespace Helpers
+
+#endif /* HELPERS_CONNECTIONPOOL_H_ */
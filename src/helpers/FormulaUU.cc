@@ -37,6 +37,7 @@ namespace Helpers {
 namespace {
 
 const float C20 = 17.5043, C30 = 241.2;
+const float C2_NEGATIVE = 22.4433, C3_NEGATIVE = 272.186;
 
 }
 
@@ -52,8 +53,8 @@ float formulaTD(float TA, float UU)
         C2 = C20;
         C3 = C30;
     } else {
-        C2 = 22.4433;
-        C3 = 272.186;
+        C2 = C2_NEGATIVE;
+        C3 = C3_NEGATIVE;
     }
     const float lu = std::log(UU/100.0);
     const float a = (C20*TA)/(C30+TA);
@@ -70,4 +71,37 @@ float formulaUU(float TA, float TD)
     return 100*std::exp( (C20*TD)/(C30+TD) - (C20*TA)/(C30+TA) );
 }
 
+// ------------------------------------------------------------------------
+
+// Invalid input is replaced by a harmless value before log or exp, and
+// the result is selected afterwards.
+
+void formulaTD(const float* TA, const float* UU, float* TD, std::size_t n)
+{
+    for(std::size_t i=0; i<n; ++i) {
+        const float ta = TA[i], uu = UU[i];
+        const bool invalid = (uu <= 0) | (uu >= 100) | (ta == UU_INVALID);
+        const float uuSafe = invalid ? 50.0f : uu;
+        const bool positive = (ta >= 0);
+        const float C2 = positive ? C20 : C2_NEGATIVE, C3 = positive ? C30 : C3_NEGATIVE;
+        const float lu = std::log(uuSafe/100.0);
+        const float a = (C20*ta)/(C30+ta);
+        const float td = C3*(a + lu)/(C2-a-lu);
+        TD[i] = invalid ? UU_INVALID : td;
+    }
+}
+
+// ------------------------------------------------------------------------
+
+void formulaUU(const float* TA, const float* TD, float* UU, std::size_t n)
+{
+    for(std::size_t i=0; i<n; ++i) {
+        const float ta = TA[i], td = TD[i];
+        const bool invalid = (td == UU_INVALID) | (ta == UU_INVALID);
+        const float tdSafe = invalid ? 0.0f : td, taSafe = invalid ? 0.0f : ta;
+        const float uu = 100*std::exp( (C20*tdSafe)/(C30+tdSafe) - (C20*taSafe)/(C30+taSafe) );
+        UU[i] = invalid ? UU_INVALID : uu;
+    }
+}
+
 } // namespace Helpers
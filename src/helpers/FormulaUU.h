@@ -30,6 +30,8 @@
 #ifndef FORMULA_UU_h
 #define FORMULA_UU_h 1
 
+#include <cstddef>
+
 namespace Helpers {
 
 /** Calculate dew point from temperature TA and relative humidity UU. */
@@ -38,6 +40,18 @@ float formulaTD(float TA, float UU);
 /** Calculate relative humidity from temperature TA and dew point TD. */
 float formulaUU(float TA, float TD);
 
+/**
+ * Calculate dew point for n pairs of TA and UU, with the same results
+ * as the scalar formulaTD, including UU_INVALID for invalid input.
+ */
+void formulaTD(const float* TA, const float* UU, float* TD, std::size_t n);
+
+/**
+ * Calculate relative humidity for n pairs of TA and TD, with the same
+ * results as the scalar formulaUU, including UU_INVALID for invalid input.
+ */
+void formulaUU(const float* TA, const float* TD, float* UU, std::size_t n);
+
 extern const int UU_INVALID;
 
 } // namespace Helpers
@@ -0,0 +1,70 @@
+/*
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "OrderStatistics.h"
+
+namespace Helpers {
+
+bool OrderStatistics::erase(float value)
+{
+    const Tree::iterator it = mTree.lower_bound(Key(value, 0));
+    if( it == mTree.end() or it->first != value )
+        return false;
+    mTree.erase(it);
+    return true;
+}
+
+// ------------------------------------------------------------------------
+
+double OrderStatistics::median(std::size_t begin, std::size_t end) const
+{
+    if( begin == end )
+        return 0;
+
+    const std::size_t size = end - begin, idxM = begin + size/2;
+    double median = at(idxM);
+    if( size % 2 == 0 )
+        median = ( median + at(idxM-1) )/2.0;
+    return median;
+}
+
+// ------------------------------------------------------------------------
+
+void OrderStatistics::quartiles(double& q1, double& q2, double& q3) const
+{
+    // like Helpers::quartiles, the median is excluded from both halves
+    // if the number of values is odd
+    const std::size_t size = mTree.size(), half = size/2;
+    q2 = median(0, size);
+    q1 = median(0, half);
+    q3 = median((size % 2 != 0) ? half+1 : half, size);
+}
+
+} // namespace Helpers
@@ -0,0 +1,87 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#ifndef HELPERS_ORDERSTATISTICS_H_
+#define HELPERS_ORDERSTATISTICS_H_
+
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+
+#include <functional>
+#include <utility>
+
+namespace Helpers {
+
+/**
+ * Multiset of floats with O(log n) insert, erase and access by rank,
+ * for quartiles of a sliding window.
+ */
+class OrderStatistics {
+public:
+    OrderStatistics()
+        : mSerial(0) { }
+
+    void clear()
+        { mTree.clear(); }
+
+    void insert(float value)
+        { mTree.insert(Key(value, mSerial++)); }
+
+    /** Remove one value equal to value; returns false if there is none. */
+    bool erase(float value);
+
+    std::size_t size() const
+        { return mTree.size(); }
+
+    bool empty() const
+        { return mTree.empty(); }
+
+    /** The value with rank k, i.e. the k-th smallest value, starting at 0. */
+    float at(std::size_t k) const
+        { return mTree.find_by_order(k)->first; }
+
+    /** Same as Helpers::median for the values with ranks in [begin, end). */
+    double median(std::size_t begin, std::size_t end) const;
+
+    /** Same as Helpers::quartiles for all values. */
+    void quartiles(double& q1, double& q2, double& q3) const;
+
+private:
+    // the serial number makes equal values distinct
+    typedef std::pair<float, unsigned long> Key;
+    typedef __gnu_pbds::tree<Key, __gnu_pbds::null_type, std::less<Key>,
+                             __gnu_pbds::rb_tree_tag, __gnu_pbds::tree_order_statistics_node_update> Tree;
+    Tree mTree;
+    unsigned long mSerial;
+};
+
+} // namespace Helpers
+
+#endif /* HELPERS_ORDERSTATISTICS_H_ */
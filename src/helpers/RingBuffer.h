@@ -0,0 +1,142 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef HELPERS_RINGBUFFER_H_
+#define HELPERS_RINGBUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace Helpers {
+
+/**
+ * Bounded queue for several producers and one consumer, without
+ * locks (after D. Vyukov's bounded MPMC queue). push() never blocks
+ * and never allocates; it fails if the queue is full.
+ */
+template<class T>
+class RingBuffer {
+public:
+    /** Capacity is rounded up to a power of 2. */
+    explicit RingBuffer(std::size_t capacity);
+
+    /** Move value into the queue; returns false if the queue is full. May be called from any thread. */
+    bool push(T& value);
+
+    /** Move the oldest value out of the queue; returns false if it is empty. Only one thread may call this. */
+    bool pop(T& value);
+
+    std::size_t capacity() const
+        { return mMask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    static std::size_t roundUp(std::size_t capacity);
+
+private:
+    const std::size_t mMask;
+    std::unique_ptr<Cell[]> mCells;
+    std::atomic<std::size_t> mEnqueue;
+    char mPadding[64];
+    std::atomic<std::size_t> mDequeue;
+};
+
+// ------------------------------------------------------------------------
+
+template<class T>
+std::size_t RingBuffer<T>::roundUp(std::size_t capacity)
+{
+    std::size_t c = 2;
+    while( c < capacity )
+        c <<= 1;
+    return c;
+}
+
+// ------------------------------------------------------------------------
+
+template<class T>
+RingBuffer<T>::RingBuffer(std::size_t capacity)
+    : mMask(roundUp(capacity) - 1)
+    , mCells(new Cell[mMask + 1])
+    , mEnqueue(0)
+    , mDequeue(0)
+{
+    for(std::size_t i=0; i<=mMask; ++i)
+        mCells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+// ------------------------------------------------------------------------
+
+template<class T>
+bool RingBuffer<T>::push(T& value)
+{
+    std::size_t pos = mEnqueue.load(std::memory_order_relaxed);
+    Cell* cell;
+    while( true ) {
+        cell = &mCells[pos & mMask];
+        const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t dif = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+        if( dif == 0 ) {
+            if( mEnqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed) )
+                break;
+        } else if( dif < 0 ) {
+            return false; // full
+        } else {
+            pos = mEnqueue.load(std::memory_order_relaxed);
+        }
+    }
+    cell->value = std::move(value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+// ------------------------------------------------------------------------
+
+template<class T>
+bool RingBuffer<T>::pop(T& value)
+{
+    const std::size_t pos = mDequeue.load(std::memory_order_relaxed);
+    Cell& cell = mCells[pos & mMask];
+    const std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+    if( std::ptrdiff_t(seq) - std::ptrdiff_t(pos + 1) < 0 )
+        return false; // empty
+    mDequeue.store(pos + 1, std::memory_order_relaxed);
+    value = std::move(cell.value);
+    cell.sequence.store(pos + mMask + 1, std::memory_order_release);
+    return true;
+}
+
+} // namespace Helpers
+
+#endif /* HELPERS_RINGBUFFER_H_ */
@@ -0,0 +1,132 @@
+/*
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "TaskGraph.h"
+
+#include "foreach.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <stdexcept>
+
+namespace Helpers {
+
+TaskGraph::TaskGraph()
+    : mRunning(0), mFinished(0)
+{
+}
+
+// ------------------------------------------------------------------------
+
+TaskGraph::TaskId TaskGraph::add(const Work& work)
+{
+    mTasks.push_back(Task(work));
+    return mTasks.size() - 1;
+}
+
+// ------------------------------------------------------------------------
+
+void TaskGraph::addDependency(TaskId task, TaskId before)
+{
+    mTasks.at(before).dependents.push_back(task);
+    mTasks.at(task).dependencies += 1;
+}
+
+// ------------------------------------------------------------------------
+
+void TaskGraph::run(int nWorkers)
+{
+    mReady.clear();
+    mRunning = mFinished = 0;
+    mError = std::exception_ptr();
+    for(TaskId t=0; t<mTasks.size(); ++t) {
+        mTasks[t].waitingFor = mTasks[t].dependencies;
+        if( mTasks[t].waitingFor == 0 )
+            mReady.push_back(t);
+    }
+
+    if( nWorkers <= 1 ) {
+        work(0);
+    } else {
+        boost::thread_group workers;
+        for(int w=0; w<nWorkers; ++w)
+            workers.create_thread(boost::bind(&TaskGraph::work, this, w));
+        workers.join_all();
+    }
+
+    if( mError )
+        std::rethrow_exception(mError);
+    if( mFinished != mTasks.size() )
+        throw std::logic_error("TaskGraph: cyclic dependencies");
+}
+
+// ------------------------------------------------------------------------
+
+void TaskGraph::work(int worker)
+{
+    boost::mutex::scoped_lock lock(mMutex);
+    while( true ) {
+        while( mReady.empty() and mRunning > 0 and not mError )
+            mCondition.wait(lock);
+        // no ready task and nothing running means all done (or a cycle)
+        if( mError or mReady.empty() )
+            break;
+
+        const TaskId t = mReady.front();
+        mReady.pop_front();
+        mRunning += 1;
+
+        lock.unlock();
+        std::exception_ptr error;
+        try {
+            mTasks[t].work(worker);
+        } catch(...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+
+        mRunning -= 1;
+        if( error ) {
+            if( not mError )
+                mError = error;
+        } else {
+            mFinished += 1;
+            foreach(TaskId d, mTasks[t].dependents) {
+                if( --mTasks[d].waitingFor == 0 )
+                    mReady.push_back(d);
+            }
+        }
+        mCondition.notify_all();
+    }
+    mCondition.notify_all();
+}
+
+} // namespace Helpers
@@ -0,0 +1,99 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#ifndef TASKGRAPH_H_
+#define TASKGRAPH_H_
+
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <deque>
+#include <exception>
+#include <vector>
+
+namespace Helpers {
+
+/**
+ * Tasks with dependencies, executed by a number of worker threads. A
+ * task is started only after all tasks it depends on have finished.
+ * Tasks without pending dependencies are started in the order in
+ * which they were added.
+ */
+class TaskGraph {
+public:
+    /** Task function; the argument is the index of the worker running it. */
+    typedef boost::function<void (int)> Work;
+    typedef std::size_t TaskId;
+
+    TaskGraph();
+
+    TaskId add(const Work& work);
+
+    /** Make sure that task is started only after before has finished. */
+    void addDependency(TaskId task, TaskId before);
+
+    std::size_t size() const
+        { return mTasks.size(); }
+
+    /**
+     * Run all tasks using nWorkers threads and wait until they are
+     * finished. With nWorkers <= 1, tasks are run in the calling thread.
+     *
+     * If a task throws, no more tasks are started and the exception is
+     * rethrown after all running tasks have finished. Throws
+     * std::logic_error if the dependencies contain a cycle.
+     */
+    void run(int nWorkers);
+
+private:
+    void work(int worker);
+
+private:
+    struct Task {
+        Work work;
+        std::vector<TaskId> dependents;
+        int dependencies;
+        int waitingFor;
+        Task(const Work& w)
+            : work(w), dependencies(0), waitingFor(0) { }
+    };
+    std::vector<Task> mTasks;
+
+    boost::mutex mMutex;
+    boost::condition_variable mCondition;
+    std::deque<TaskId> mReady;
+    std::size_t mRunning, mFinished;
+    std::exception_ptr mError;
+};
+
+} // namespace Helpers
+
+#endif /* TASKGRAPH_H_ */
@@ -29,6 +29,7 @@
 
 #include "timeutil.h"
 
+#include <boost/date_time/gregorian/gregorian.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/format.hpp>
 
@@ -57,6 +58,11 @@ date makedate(int year, int month, int day)
     return boost::gregorian::date(year, month, day);
 }
 
+date makedate(const std::string& sd)
+{
+    return boost::gregorian::from_simple_string(sd.substr(0, 10));
+}
+
 time now()
 {
     return b_pt::second_clock::universal_time();
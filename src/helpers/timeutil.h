@@ -49,6 +49,7 @@ namespace kvtime {
 time maketime(const std::string& time_text);
 time maketime(int Year, int Month, int Day, int Hour, int Minute, int Second);
 date makedate(int Year, int Month, int Day);
+date makedate(const std::string& date_text);
 time now();
 
 void addSeconds(time& t, int nSeconds);
@@ -5,9 +5,12 @@
 #include "helpers/FormulaUU.h"
 #include "Instrument.h"
 #include "ParameterInfo.h"
+#include "foreach.h"
 
 #include "gdebug.h"
 
+#include <algorithm>
+
 using Interpolation::SeriesData;
 using Interpolation::SupportData;
 
@@ -51,8 +54,6 @@ void GapData::fetchNeighborCorrelations()
     DBGL;
     mNeighborCorrelations = mAlgo->findNeighborData(mInstrument.stationid, mInstrument.paramid, mParameterInfo.maxSigma);
     DBGL;
-    mNeighborObservations = NeighborObservations(mNeighborCorrelations.size());
-    DBGL;
     mFetchedNeighborCorrelations = true;
 }
 
@@ -69,13 +70,14 @@ SupportData GapData::neighbor(int n, int time)
     if (n >= neighborCount())
         return SupportData();
 
-    Interpolation::SupportDataList& no = mNeighborObservations[n];
-    if( no.empty() ) {
-        const NeighborData& nd = mNeighborCorrelations[n];
-        no = mAlgo->getNeighborData(mTimeRange, nd.neighborid, mInstrument.paramid);
+    if( mNeighborObservations.empty() ) {
+        std::vector<int> neighborids;
+        foreach(const NeighborData& nd, mNeighborCorrelations)
+            neighborids.push_back(nd.neighborid);
+        mNeighborObservations = mAlgo->getNeighborData(mTimeRange, neighborids, mInstrument.paramid);
     }
 
-    return no.at(time);
+    return mNeighborObservations[n].at(time);
 }
 
 SupportData GapData::transformedNeighbor(int n, int time)
@@ -93,8 +95,7 @@ float GapData::neighborWeight(int neighbor)
 {
     if( !mFetchedNeighborCorrelations )
         fetchNeighborCorrelations();
-    const float s = mNeighborCorrelations[neighbor].sigma;
-    return 1 / (s * s * s);
+    return mNeighborCorrelations[neighbor].weight;
 }
 
 bool GapData::hasMinMax() const
@@ -102,6 +103,51 @@ bool GapData::hasMinMax() const
     return (mParameterInfo.minParameter > 0) or (mParameterInfo.maxParameter > 0);
 }
 
+Interpolation::SeriesArrays GapData::parameterArrays() const
+{
+    const int d = duration();
+    Interpolation::SeriesArrays a(d);
+    for(int t=0; t<d; ++t)
+        a.set(t, parameter(t));
+    return a;
+}
+
+Interpolation::SeriesArrays GapData::minimumArrays() const
+{
+    const int d = duration();
+    Interpolation::SeriesArrays a(d);
+    for(int t=0; t<d; ++t)
+        a.set(t, minimum(t));
+    return a;
+}
+
+Interpolation::SeriesArrays GapData::maximumArrays() const
+{
+    const int d = duration();
+    Interpolation::SeriesArrays a(d);
+    for(int t=0; t<d; ++t)
+        a.set(t, maximum(t));
+    return a;
+}
+
+Interpolation::SupportArrays GapData::modelArrays() const
+{
+    const int d = duration();
+    Interpolation::SupportArrays a(d);
+    for(int t=0; t<d; ++t)
+        a.set(t, model(t));
+    return a;
+}
+
+Interpolation::SupportArrays GapData::transformedNeighborArrays(int n)
+{
+    const int d = duration();
+    Interpolation::SupportArrays a(d);
+    for(int t=0; t<d; ++t)
+        a.set(t, transformedNeighbor(n, t));
+    return a;
+}
+
 // ========================================================================
 
 GapDataUU::GapDataUU(const Instrument& i, const TimeRange& timeRange, const ParameterInfo& parameterInfo, GapInterpolationAlgorithm* algo)
@@ -113,12 +159,20 @@ GapDataUU::GapDataUU(const Instrument& i, const TimeRange& timeRange, const Para
 
 Interpolation::SupportData GapDataUU::model(int time) const
 {
-    const float TA = mModelTA.at(time);
     const float mv = mModelData.at(time).original();
-    if( mv >= Interpolation::INVALID_VALUE )
-        return Interpolation::SupportData(Helpers::formulaTD(TA, mv));
-    else
+    if( mv < Interpolation::INVALID_VALUE )
         return Interpolation::SupportData();
+
+    if( mModelTD.empty() ) {
+        // model data do not change, convert the whole series at once
+        const std::size_t n = std::min(mModelData.size(), mModelTA.size());
+        std::vector<float> modelUU(n);
+        for(std::size_t t=0; t<n; ++t)
+            modelUU[t] = mModelData[t].original();
+        mModelTD.resize(n);
+        Helpers::formulaTD(&mModelTA[0], &modelUU[0], &mModelTD[0], n);
+    }
+    return Interpolation::SupportData(mModelTD.at(time));
 }
 
 SeriesData GapDataUU::asValue(const DataUpdates& u, int time) const
@@ -127,8 +181,13 @@ SeriesData GapDataUU::asValue(const DataUpdates& u, int time) const
     DBG(DBG1(TA) << DBG1(time));
     if( TA >= Interpolation::INVALID_VALUE ) {
         const GapUpdate& gu = u.at(time);
+        const PendingTD& p = mPending[series(u)];
+        if( !p.pending.empty() && p.pending[time] ) {
+            const float v = p.TD[time];
+            return SeriesData(v, gu.quality(), gu.usable() and (v > Interpolation::INVALID_VALUE));
+        }
         DBG(DBG1(gu) << DBG1(gu.value()) << DBG1(gu.quality()));
-        const float v = Helpers::formulaTD(TA, gu.value());
+        const float v = dewPoint(u, time, TA, gu.value());
         const bool u = gu.usable() and (v > Interpolation::INVALID_VALUE);
         return SeriesData(v, gu.quality(), u);
     } else {
@@ -136,9 +195,87 @@ SeriesData GapDataUU::asValue(const DataUpdates& u, int time) const
     }
 }
 
+float GapDataUU::dewPoint(const DataUpdates& u, int time, float TA, float UU) const
+{
+    if( &u != &mDataPar )
+        return Helpers::formulaTD(TA, UU);
+
+    if( mCacheTD.empty() ) {
+        const std::size_t n = mDataPar.size();
+        mCacheTA = mDataTA;
+        mCacheUU.resize(n);
+        for(std::size_t t=0; t<n; ++t)
+            mCacheUU[t] = mDataPar[t].value();
+        mCacheTD.resize(n);
+        Helpers::formulaTD(&mCacheTA[0], &mCacheUU[0], &mCacheTD[0], n);
+    }
+    if( mCacheTA[time] != TA or mCacheUU[time] != UU ) {
+        mCacheTA[time] = TA;
+        mCacheUU[time] = UU;
+        mCacheTD[time] = Helpers::formulaTD(TA, UU);
+    }
+    return mCacheTD[time];
+}
+
+GapData::DataUpdates& GapDataUU::updates(int series)
+{
+    return (series == 0) ? mDataPar : ((series == 1) ? mDataMin : mDataMax);
+}
+
+int GapDataUU::series(const DataUpdates& u) const
+{
+    return (&u == &mDataPar) ? 0 : ((&u == &mDataMin) ? 1 : 2);
+}
+
 void GapDataUU::toValue(DataUpdates& u, int time, Interpolation::Quality q, float value)
 {
     const float TA = mDataTA.at(time);
-    if( TA >= Interpolation::INVALID_VALUE )
-        u.at(time).update(q, Helpers::formulaUU(TA, value));
+    if( TA < Interpolation::INVALID_VALUE )
+        return;
+    // the value stays a dew point until finishValues(), see asValue()
+    if( u.at(time).update(q, value) ) {
+        PendingTD& p = mPending[series(u)];
+        if( p.pending.empty() ) {
+            p.pending.resize(u.size(), 0);
+            p.TD.resize(u.size());
+        }
+        if( !p.pending[time] )
+            p.times.push_back(time);
+        p.pending[time] = 1;
+        p.TD[time] = value;
+    }
+}
+
+void GapDataUU::finishValues()
+{
+    for(int s=0; s<3; ++s) {
+        PendingTD& p = mPending[s];
+        const std::size_t n = p.times.size();
+        if( n == 0 )
+            continue;
+        std::vector<float> TA(n), TD(n), UU(n);
+        for(std::size_t i=0; i<n; ++i) {
+            TA[i] = mDataTA[p.times[i]];
+            TD[i] = p.TD[p.times[i]];
+        }
+        Helpers::formulaUU(&TA[0], &TD[0], &UU[0], n);
+
+        DataUpdates& u = updates(s);
+        for(std::size_t i=0; i<n; ++i) {
+            GapUpdate& gu = u.at(p.times[i]);
+            gu.update(gu.quality(), UU[i], true);
+        }
+        if( &u == &mDataPar and not mCacheTD.empty() ) {
+            // keep the dew point cache of asValue() up to date, too
+            std::vector<float> cacheTD(n);
+            Helpers::formulaTD(&TA[0], &UU[0], &cacheTD[0], n);
+            for(std::size_t i=0; i<n; ++i) {
+                const int t = p.times[i];
+                mCacheTA[t] = TA[i];
+                mCacheUU[t] = UU[i];
+                mCacheTD[t] = cacheTD[i];
+            }
+        }
+        p = PendingTD();
+    }
 }
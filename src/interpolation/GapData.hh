@@ -46,8 +46,19 @@ public:
     virtual Interpolation::SeriesData asValue(const DataUpdates&, int) const;
     virtual void toValue(DataUpdates&, int time, Interpolation::Quality q, float value);
 
+    /** Finish values set by toValue() that are converted later; to be called after each interpolation. */
+    virtual void finishValues()
+        { }
+
     bool hasMinMax() const;
 
+    /** Current series as dense arrays, for the templated interpolation engines. */
+    Interpolation::SeriesArrays parameterArrays() const;
+    Interpolation::SeriesArrays minimumArrays() const;
+    Interpolation::SeriesArrays maximumArrays() const;
+    Interpolation::SupportArrays modelArrays() const;
+    Interpolation::SupportArrays transformedNeighborArrays(int n);
+
     const Instrument& mInstrument;
     TimeRange mTimeRange;
     const ParameterInfo& mParameterInfo;
@@ -78,9 +89,34 @@ public:
     virtual Interpolation::SeriesData asValue(const DataUpdates&, int ) const;
     virtual void toValue(DataUpdates&, int time, Interpolation::Quality q, float value);
 
+    /** Convert the dew points set by toValue() to UU, all at once. */
+    virtual void finishValues();
+
 public:
     std::vector<float> mDataTA;
     std::vector<float> mModelTA;
+
+private:
+    float dewPoint(const DataUpdates& u, int time, float TA, float UU) const;
+
+    /** dew points of mDataPar, calculated for the whole series at once
+     *  and recalculated for single values if TA or UU change */
+    mutable std::vector<float> mCacheTA, mCacheUU, mCacheTD;
+
+    /** dew points of mModelData, calculated at the first call to model() */
+    mutable std::vector<float> mModelTD;
+
+    /** dew points set by toValue(), until finishValues() */
+    struct PendingTD {
+        std::vector<int> times;
+        std::vector<char> pending;
+        std::vector<float> TD;
+    };
+    PendingTD mPending[3];
+
+    /** index into mPending: 0 for mDataPar, 1 for mDataMin, 2 for mDataMax */
+    int series(const DataUpdates& u) const;
+    DataUpdates& updates(int series);
 };
 
 // ========================================================================
@@ -33,17 +33,21 @@
 #include "helpers/AlgorithmHelpers.h"
 #include "helpers/FormulaUU.h"
 #include "helpers/mathutil.h"
+#include "helpers/TaskGraph.h"
 #include "helpers/timeutil.h"
 #include "interpolation/InterpolationError.hh"
 #include "interpolation/KvalobsMinMaxData.h"
 #include "interpolation/KvalobsNeighborData.h"
-#include "interpolation/MinMaxInterpolator.h"
-#include "interpolation/MinMaxReconstruction.h"
-#include "interpolation/NeighborInterpolator.h"
+#include "interpolation/MinMaxInterpolator.icc"
+#include "interpolation/MinMaxReconstruction.icc"
+#include "interpolation/NeighborInterpolator.icc"
 #include "foreach.h"
 
 #include <kvalobs/kvDataOperations.h>
 
+#include <boost/bind.hpp>
+
+#include <set>
 
 #include "gdebug.h"
 
@@ -68,6 +72,11 @@ bool isReliableMinMax(const Interpolation::SeriesData& d)
     return d.quality() < Interpolation::FAILED;
 }
 
+// worker database connections are owned by GapInterpolationAlgorithm::run
+void keepWorkerDatabase(DBInterface*)
+{
+}
+
 void discardUpdate(GapUpdate& gu) {
     if( not gu.isNew() ) {
         DBGV(gu);
@@ -104,6 +113,8 @@ bool GapInterpolationAlgorithm::ParamGroupMissingRange::tryExtend(const kvalobs:
 
 GapInterpolationAlgorithm::GapInterpolationAlgorithm()
     : Qc2Algorithm("GapInterpolation")
+    , mThreads(1)
+    , mWorkerDatabase(&keepWorkerDatabase)
 {
 }
 
@@ -116,6 +127,7 @@ void GapInterpolationAlgorithm::configure( const AlgorithmConfig& params )
     tids = params.getMultiParameter<int>("TypeId");
 
     mRAThreshold = params.getParameter("RA_threshold", 50.0f);
+    mThreads = params.getParameter("Threads", 1);
 
     params.getFlagSetCU(missing_flags,  "missing", "ftime=0&fmis=[123]&fhqc=0", "");
     params.getFlagSetCU(mNeighborFlags, "neighbors", "", "U2=0");
@@ -136,43 +148,58 @@ void GapInterpolationAlgorithm::configure( const AlgorithmConfig& params )
 NeighborDataVector GapInterpolationAlgorithm::findNeighborData(int stationid, int paramid, float maxsigma)
 {
     DBG(DBG1(stationid) << DBG1(paramid) << DBG1(maxsigma));
-    return database()->findNeighborData(stationid, paramid, maxsigma); 
+    return mNeighborCorrelations.find(stationid, paramid, maxsigma);
 }
 
 // ------------------------------------------------------------------------
 
-Interpolation::SupportDataList GapInterpolationAlgorithm::getNeighborData(const TimeRange& t, int neighborid, int paramid)
+GapInterpolationAlgorithm::NeighborSupportData GapInterpolationAlgorithm::getNeighborData(const TimeRange& t, const std::vector<int>& neighborids, int paramid)
 {
     DBGL;
-    Interpolation::SupportDataList nd(t.hours() + 1);
-
-    const DataList dl = database()->findDataMaybeTSLOrderObstime(neighborid, paramid,
-                                                                 DBInterface::INVALID_ID, DBInterface::INVALID_ID,
-                                                                 DBInterface::INVALID_ID, t, mNeighborFlags);
+    const std::size_t nTimes = t.hours() + 1, nNeighbors = neighborids.size();
+    NeighborSupportData nd(nNeighbors, Interpolation::SupportDataList(nTimes));
+    if( neighborids.empty() )
+        return nd;
+
+    std::map<int, std::size_t> neighborIndex;
+    for(std::size_t n=0; n<nNeighbors; ++n)
+        neighborIndex.insert(std::make_pair(neighborids[n], n));
+    const DBInterface::StationIDList stationIDs(neighborids.begin(), neighborids.end());
+    const std::vector<int> tids(1, DBInterface::INVALID_ID);
+
+    // values of all neighbors in one array, indexed by neighbor*nTimes + time
+    std::vector<float> values(nNeighbors * nTimes, Interpolation::MISSING_VALUE);
+    std::vector<char> present(values.size(), 0);
+
+    const DataList dl = workerDatabase()->findDataOrderStationObstime(stationIDs, std::vector<int>(1, paramid), tids, t, mNeighborFlags);
+    foreach(const kvalobs::kvData& d, dl) {
+        const std::size_t n = neighborIndex[d.stationID()];
+        const int time = kvtime::hourDiff(d.obstime(), t.t0);
+        values.at(n*nTimes + time) = d.original();
+        present[n*nTimes + time] = 1;
+    }
 
     if( paramid == KVALOBS_PARAMID_UU ) {
-        const DataList dlTA = database()->findDataMaybeTSLOrderObstime(neighborid, KVALOBS_PARAMID_TA,
-                                                                       DBInterface::INVALID_ID, DBInterface::INVALID_ID,
-                                                                       DBInterface::INVALID_ID, t, mDataFlagsUUTA);
-
-        std::vector<float> valueUU(nd.size(), Interpolation::MISSING_VALUE), valueTA(nd.size(), Interpolation::MISSING_VALUE);
-        foreach(const kvalobs::kvData& d, dl) {
-            const int time = kvtime::hourDiff(d.obstime(), t.t0);
-            valueUU.at(time) = d.original();
-        }
+        std::vector<float> valuesTA(values.size(), Interpolation::MISSING_VALUE);
+        const DataList dlTA = workerDatabase()->findDataOrderStationObstime(stationIDs, std::vector<int>(1, KVALOBS_PARAMID_TA), tids, t, mDataFlagsUUTA);
         foreach(const kvalobs::kvData& d, dlTA) {
+            const std::size_t n = neighborIndex[d.stationID()];
             const int time = kvtime::hourDiff(d.obstime(), t.t0);
-            valueTA.at(time) = d.corrected();
+            valuesTA.at(n*nTimes + time) = d.corrected();
         }
-        for(std::size_t t=0; t<nd.size(); ++t) {
-            const float ta = valueTA.at(t), uu = valueUU.at(t);
-            if( ta > Interpolation::INVALID_VALUE and uu > Interpolation::INVALID_VALUE )
-                nd.at(t) = Interpolation::SupportData(Helpers::formulaTD(ta, uu));
-        }
-    } else {
-        foreach(const kvalobs::kvData& d, dl) {
-            const int time = kvtime::hourDiff(d.obstime(), t.t0);
-            nd.at(time) = Interpolation::SupportData(d.original());
+
+        // convert all neighbors to dew point in one pass
+        for(std::size_t i=0; i<values.size(); ++i)
+            present[i] = (valuesTA[i] > Interpolation::INVALID_VALUE and values[i] > Interpolation::INVALID_VALUE);
+        Helpers::formulaTD(&valuesTA[0], &values[0], &values[0], values.size());
+    }
+
+    // a neighbor listed twice gets the series stored for its first entry
+    for(std::size_t n=0; n<nNeighbors; ++n) {
+        const std::size_t first = neighborIndex[neighborids[n]];
+        for(std::size_t time=0; time<nTimes; ++time) {
+            if( present[first*nTimes + time] )
+                nd[n][time] = Interpolation::SupportData(values[first*nTimes + time]);
         }
     }
     return nd;
@@ -215,15 +242,16 @@ void GapInterpolationAlgorithm::makeUpdates(GapData& data)
     makeUpdates(data.mDataPar, data.mParameterInfo, updates);
     makeUpdates(data.mDataMin, data.mParameterInfo, updates);
     makeUpdates(data.mDataMax, data.mParameterInfo, updates);
-    if( not updates.empty() )
+    if( not updates.empty() ) {
+        boost::mutex::scoped_lock lock(mOutputMutex);
         storeData(updates);
+    }
 }
 
 // ------------------------------------------------------------------------
 
 GapInterpolationAlgorithm::InstrumentMissingRanges GapInterpolationAlgorithm::findMissing()
 {
-    const DBInterface::StationIDList stationIDs(1, DBInterface::ALL_STATIONS);
     std::vector<int> pids;
     foreach(const ParameterInfo& pi, mParameterInfos) {
         pids.push_back(pi.parameter);
@@ -233,13 +261,11 @@ GapInterpolationAlgorithm::InstrumentMissingRanges GapInterpolationAlgorithm::fi
             pids.push_back(pi.maxParameter);
     }
     const DBInterface::DataList missingData
-        = database()->findDataOrderStationObstime(stationIDs, pids, tids, TimeRange(UT0, UT1), missing_flags);
+        = database()->findDataOrderStationObstime(StationSet::norwegian(), pids, tids, TimeRange(UT0, UT1), missing_flags);
 
     InstrumentMissingRanges instrumentMissingRanges;
     foreach(const kvalobs::kvData& d, missingData) {
         const Instrument i = getMasterInstrument(d);
-        if (!Helpers::isNorwegianStationId(i.stationid))
-            continue;
         MissingRanges& mr = instrumentMissingRanges[i];
         if( mr.empty() or not mr.back().tryExtend(d) )
             mr.push_back(ParamGroupMissingRange(d));
@@ -264,55 +290,157 @@ Instrument GapInterpolationAlgorithm::getMasterInstrument(const kvalobs::kvData&
 void GapInterpolationAlgorithm::run()
 {
     InstrumentMissingRanges instrumentMissingRanges = findMissing();
+    if( instrumentMissingRanges.empty() )
+        return;
+
+    std::vector<int> paramids;
+    foreach(const ParameterInfo& pi, mParameterInfos)
+        paramids.push_back(pi.parameter);
+    mNeighborCorrelations.refresh(database(), paramids);
+
+    Helpers::TaskGraph tasks;
+    makeTasks(tasks, instrumentMissingRanges);
+
+    // each worker reads through its own connection; storeData is
+    // serialized and uses the algorithm's database()
+    int nWorkers = std::min<int>(mThreads, tasks.size());
+    while( nWorkers > 1 and (int)mWorkerDatabases.size() < nWorkers ) {
+        DBInterface* db = database()->newConnection();
+        if( not db )
+            break;
+        mWorkerDatabases.push_back(std::shared_ptr<DBInterface>(db));
+    }
+    if( mWorkerDatabases.size() < 2 )
+        mWorkerDatabases.clear();
+    nWorkers = std::max<int>(1, mWorkerDatabases.size());
+    DBGV(nWorkers);
+
+    try {
+        tasks.run(nWorkers);
+    } catch(...) {
+        mWorkerDatabases.clear();
+        throw;
+    }
+    mWorkerDatabases.clear();
+}
 
-    foreach(InstrumentMissingRanges::value_type& imr, instrumentMissingRanges)
-        if( imr.first.paramid == KVALOBS_PARAMID_TA )
-            interpolateMissingRange(imr.first, imr.second);
+// ------------------------------------------------------------------------
+
+void GapInterpolationAlgorithm::makeTasks(Helpers::TaskGraph& tasks, const InstrumentMissingRanges& instrumentMissingRanges)
+{
+    typedef std::vector<Helpers::TaskGraph::TaskId> TaskIds;
+    typedef std::map<int, TaskIds> StationTaskIds;
+    StationTaskIds stationTA;
+    std::vector<std::pair<const Instrument*, TaskIds> > uuTasks;
+
+    // TA tasks are added first so that a run with a single worker
+    // proceeds like the old sequential implementation
+    for(int pass=0; pass<2; ++pass) {
+        foreach(const InstrumentMissingRanges::value_type& imr, instrumentMissingRanges) {
+            const bool isTA = (imr.first.paramid == KVALOBS_PARAMID_TA);
+            if( isTA != (pass == 0) )
+                continue;
 
-    foreach(InstrumentMissingRanges::value_type& imr, instrumentMissingRanges)
-        if( imr.first.paramid != KVALOBS_PARAMID_TA )
-            interpolateMissingRange(imr.first, imr.second);
+            // missing ranges of one instrument may overlap after
+            // extending by EXTRA_DATA, so they are run in order
+            TaskIds ids;
+            foreach(const ParamGroupMissingRange& pgmr, imr.second) {
+                const Helpers::TaskGraph::TaskId id
+                    = tasks.add(boost::bind(&GapInterpolationAlgorithm::interpolateMissingRangeTask, this, &imr.first, &pgmr, _1));
+                if( not ids.empty() )
+                    tasks.addDependency(id, ids.back());
+                ids.push_back(id);
+            }
+
+            if( isTA ) {
+                TaskIds& sta = stationTA[imr.first.stationid];
+                sta.insert(sta.end(), ids.begin(), ids.end());
+            } else if( imr.first.paramid == KVALOBS_PARAMID_UU ) {
+                uuTasks.push_back(std::make_pair(&imr.first, ids));
+            }
+        }
+    }
+
+    // UU is interpolated via dew point, using interpolated TA of the
+    // same station and of the neighbors
+    for(std::size_t u=0; u<uuTasks.size(); ++u) {
+        const Instrument& instrument = *uuTasks[u].first;
+        std::set<int> stations;
+        stations.insert(instrument.stationid);
+        const ParameterInfo& pi = findParameterInfo(instrument.paramid);
+        const NeighborDataVector neighbors = mNeighborCorrelations.find(instrument.stationid, instrument.paramid, pi.maxSigma);
+        foreach(const NeighborData& nd, neighbors)
+            stations.insert(nd.neighborid);
+
+        foreach(int stationid, stations) {
+            const StationTaskIds::const_iterator it = stationTA.find(stationid);
+            if( it == stationTA.end() )
+                continue;
+            foreach(Helpers::TaskGraph::TaskId uu, uuTasks[u].second) {
+                foreach(Helpers::TaskGraph::TaskId ta, it->second)
+                    tasks.addDependency(uu, ta);
+            }
+        }
+    }
 }
 
 // ------------------------------------------------------------------------
 
-void GapInterpolationAlgorithm::interpolateMissingRange(const Instrument& instrument, const MissingRanges& mr)
+void GapInterpolationAlgorithm::interpolateMissingRangeTask(const Instrument* instrument, const ParamGroupMissingRange* pgmr, int worker)
+{
+    // interpolated rows no longer match missing_flags, so the next run continues with the rest
+    if( shouldStop() || isStationSkipped(instrument->stationid) )
+        return;
+    if( not mWorkerDatabases.empty() )
+        mWorkerDatabase.reset(mWorkerDatabases.at(worker).get());
+    interpolateMissingRange(*instrument, *pgmr);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface* GapInterpolationAlgorithm::workerDatabase()
+{
+    DBInterface* db = mWorkerDatabase.get();
+    return db ? db : database();
+}
+
+// ------------------------------------------------------------------------
+
+void GapInterpolationAlgorithm::interpolateMissingRange(const Instrument& instrument, const ParamGroupMissingRange& pgmr)
 {
     DBG(DBG1(instrument.stationid) << DBG1(instrument.paramid));
     const ParameterInfo& pi = findParameterInfo(instrument.paramid);
 
-    foreach(const ParamGroupMissingRange& pgmr, mr) {
-        if( not checkTimeRangeLimits(instrument, pgmr) )
-            continue;
+    if( not checkTimeRangeLimits(instrument, pgmr) )
+        return;
 
-        TimeRange missingTime = pgmr.range.extendedByHours(Interpolation::NeighborInterpolator::EXTRA_DATA);
-        DBGV(missingTime);
-        if( missingTime.t0 < UT0 )
-            missingTime.t0 = UT0;
-        if( missingTime.t1 > UT1 )
-            missingTime.t1 = UT1;
-        DBG(DBG1(pgmr.range) << DBG1(missingTime));
+    TimeRange missingTime = pgmr.range.extendedByHours(Interpolation::NeighborInterpolator::EXTRA_DATA);
+    DBGV(missingTime);
+    if( missingTime.t0 < UT0 )
+        missingTime.t0 = UT0;
+    if( missingTime.t1 > UT1 )
+        missingTime.t1 = UT1;
+    DBG(DBG1(pgmr.range) << DBG1(missingTime));
 
-        GapDataPtr data = findSeriesData(instrument, missingTime, pi);
+    GapDataPtr data = findSeriesData(instrument, missingTime, pi);
 
-        if( not data or seriesHasMissingRows(*data) )
-            continue;
+    if( not data or seriesHasMissingRows(*data) )
+        return;
 
-        discardUnreliableMinMax(*data);
+    discardUnreliableMinMax(*data);
 
-        if( instrument.paramid == KVALOBS_PARAMID_RA and hasRADownStep(*data) )
-            continue;
+    if( instrument.paramid == KVALOBS_PARAMID_RA and hasRADownStep(*data) )
+        return;
 
-        replaceFromOtherTypeid(*data);
+    replaceFromOtherTypeid(*data);
 
-        interpolateFromMinMax(*data);
+    interpolateFromMinMax(*data);
 
-        interpolateFromNeighbors(*data);
+    interpolateFromNeighbors(*data);
 
-        reconstructMinMax(*data);
-        
-        makeUpdates(*data);
-    }
+    reconstructMinMax(*data);
+
+    makeUpdates(*data);
 }
 
 // ------------------------------------------------------------------------
@@ -320,9 +448,10 @@ void GapInterpolationAlgorithm::interpolateMissingRange(const Instrument& instru
 bool GapInterpolationAlgorithm::interpolateFromMinMax(GapData& data)
 {
     DBGL;
-    KvalobsMinMaxInterpolatorData mmiData(data);
+    KvalobsMinMaxInterpolatorArrays mmiData(data);
     Interpolation::MinMaxInterpolator mmi;
-    mmi.run(mmiData);
+    mmi.runDirect(mmiData);
+    data.finishValues();
     return false;
 }
 
@@ -331,10 +460,11 @@ bool GapInterpolationAlgorithm::interpolateFromMinMax(GapData& data)
 bool GapInterpolationAlgorithm::interpolateFromNeighbors(GapData& data)
 {
     DBGL;
-    KvalobsNeighborData nData(data);
+    KvalobsNeighborArrays nData(data);
     Interpolation::NeighborInterpolator ni;
     DBGL;
-    ni.run(nData);
+    ni.runDirect(nData);
+    data.finishValues();
     DBGL;
     return false;
 }
@@ -359,6 +489,7 @@ bool GapInterpolationAlgorithm::checkTimeRangeLimits(const Instrument& instrumen
     const TimeRange timeIntervalShrinked = TimeRange(UT0, UT1).extendedByHours(-2);
     DBG(DBG1(pgmr.range) << DBG1(timeIntervalShrinked));
     if( pgmr.range.t0 < timeIntervalShrinked.t0 || pgmr.range.t1 > timeIntervalShrinked.t1 ) {
+        boost::mutex::scoped_lock lock(mOutputMutex);
         info() << "missing range obstime BETWEEN '" << pgmr.range.t0 << "' AND '" << pgmr.range.t1
                << "' AND station=" << instrument.stationid << " AND paramid=" << instrument.paramid
                << " at start/end of time interval, skipping interpolation attempt";
@@ -391,7 +522,7 @@ GapDataPtr GapInterpolationAlgorithm::findSeriesData(const Instrument& instrumen
 
     const FlagSetCU all; // FIXME this sets too few constraints (none); must in any case be weaker than mDataFlagsUUTA
 
-    const DataList series = database()->findDataOrderObstime(instrument.stationid, pids, std::vector<int>(1, instrument.type),
+    const DataList series = workerDatabase()->findDataOrderObstime(instrument.stationid, pids, std::vector<int>(1, instrument.type),
                                                              instrument.sensor, instrument.level, range, all);
 
     foreach(const kvalobs::kvData& d, series) {
@@ -465,6 +596,7 @@ bool GapInterpolationAlgorithm::hasRADownStep(GapData& data)
         const float thisValue = data.parameter(t).value();
         const bool thisUsable = data.parameter(t).usable();
         if( thisUsable && lastUsable && (thisValue < lastValue - mRAThreshold) ) {
+            boost::mutex::scoped_lock lock(mOutputMutex);
             info() << "RA decreasing around " //<< pgmr.range.t0 << " and " << pgmr.range.t1
                    << ", no interpolation attempted";
             return true;
@@ -482,9 +614,10 @@ bool GapInterpolationAlgorithm::hasRADownStep(GapData& data)
 bool GapInterpolationAlgorithm::reconstructMinMax(GapData& data)
 {
     DBGL;
-    KvalobsMinMaxReconstructionData mmrData(data);
+    KvalobsMinMaxReconstructionArrays mmrData(data);
     Interpolation::MinMaxReconstruction mmr;
-    mmr.run(mmrData);
+    mmr.runDirect(mmrData);
+    data.finishValues();
     return false;
 }
 
@@ -527,40 +660,71 @@ void GapInterpolationAlgorithm::discardUnreliableMinMax(GapData& data)
 bool GapInterpolationAlgorithm::replaceFromOtherTypeid(GapData& data)
 {
     DBGL;
-    bool allok = true;
+    std::vector<GapUpdate*> replace;
     const int duration = data.duration();
     for(int t=0; t<duration; ++t) {
         if( data.parameter(t).needsInterpolation() ) {
             DBGV(t);
-            allok &= replaceFromOtherTypeid(data.mDataPar.at(t)/*, data.mParameterInfos.parameter*/);
+            replace.push_back(&data.mDataPar.at(t));
         }
         if( data.hasMinMax() ) {
             if( data.minimum(t).needsInterpolation() ) {
                 DBGV(t);
-                allok &= replaceFromOtherTypeid(data.mDataMin.at(t)/*, data.mParameterInfos.minParameter*/);
+                replace.push_back(&data.mDataMin.at(t));
             }
             if( data.maximum(t).needsInterpolation() ) {
                 DBGV(t);
-                allok &= replaceFromOtherTypeid(data.mDataMax.at(t)/*, data.mParameterInfos.maxParameter*/);
+                replace.push_back(&data.mDataMax.at(t));
             }
         }
     }
+
+    // group by sensor and level, and fetch each group's rows with one query over the whole time range
+    typedef std::map<std::pair<int, int>, std::vector<GapUpdate*> > SensorLevelUpdates;
+    SensorLevelUpdates sensorLevelUpdates;
+    foreach(GapUpdate* gu, replace) {
+        const kvalobs::kvData& d = gu->data();
+        sensorLevelUpdates[std::make_pair(d.sensor(), d.level())].push_back(gu);
+    }
+
+    const FlagSetCU good_flags("", "U2=0");
+    bool allok = true;
+    foreach(const SensorLevelUpdates::value_type& slu, sensorLevelUpdates) {
+        std::set<int> pids;
+        TimeRange time(slu.second.front()->obstime(), slu.second.front()->obstime());
+        foreach(const GapUpdate* gu, slu.second) {
+            pids.insert(gu->data().paramID());
+            if( gu->obstime() < time.t0 )
+                time.t0 = gu->obstime();
+            if( gu->obstime() > time.t1 )
+                time.t1 = gu->obstime();
+        }
+
+        const DataList other = workerDatabase()->findDataOrderObstime(slu.second.front()->data().stationID(), std::vector<int>(pids.begin(), pids.end()),
+                                                                std::vector<int>(1, DBInterface::INVALID_ID),
+                                                                slu.first.first, slu.first.second, time, good_flags);
+
+        typedef std::map<std::pair<int, kvtime::time>, DataList> ParamTimeData;
+        ParamTimeData paramTimeData;
+        foreach(const kvalobs::kvData& od, other)
+            paramTimeData[std::make_pair(od.paramID(), od.obstime())].push_back(od);
+
+        foreach(GapUpdate* gu, slu.second) {
+            const ParamTimeData::const_iterator it = paramTimeData.find(std::make_pair(gu->data().paramID(), gu->obstime()));
+            if( it == paramTimeData.end() )
+                allok = false;
+            else
+                allok &= replaceFromOtherTypeid(*gu, it->second);
+        }
+    }
     DBGV(allok);
     return allok;
 }
 
 // ------------------------------------------------------------------------
 
-bool GapInterpolationAlgorithm::replaceFromOtherTypeid(GapUpdate& data/*, int paramID*/)
+bool GapInterpolationAlgorithm::replaceFromOtherTypeid(GapUpdate& data, const DataList& other)
 {
-    const TimeRange obstime(data.obstime(), data.obstime());
-    const FlagSetCU good_flags("", "U2=0");
-    const kvalobs::kvData& d = data.data();
-    DBGV(d.paramID());
-    const DataList other = database()->findDataMaybeTSLOrderObstime(d.stationID(), d.paramID(), DBInterface::INVALID_ID,
-                                                                    d.sensor(), d.level(), obstime, good_flags);
-    if( other.empty() )
-        return false;
     DBG(DBG1(data) << DBG1(other.size()));
 #ifndef NDEBUG
     foreach(const kvalobs::kvData& od, other)
@@ -34,14 +34,24 @@
 #include "Instrument.h"
 #include "interpolation/ParameterInfo.h"
 #include "KvalobsMinMaxData.h"
+#include "NeighborCorrelationCache.h"
 #include "Qc2Algorithm.h"
 
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+#include <memory>
+
 namespace Interpolation {
 class MinMaxInterpolator;
 class MinMaxReconstruction;
 class NeighborInterpolator;
 } // namespace Interpolation
 
+namespace Helpers {
+class TaskGraph;
+} // namespace Helpers
+
 class GapData;
 class GapUpdate;
 
@@ -52,6 +62,10 @@ public:
     virtual void configure(const AlgorithmConfig& params);
     virtual void run();
 
+    /** UU is calculated from the interpolated TA of neighbors. */
+    virtual bool canSplitStations() const
+        { return false; }
+
 private:
     struct ParamGroupMissingRange {
         TimeRange range;
@@ -67,7 +81,10 @@ private:
     typedef std::map<Instrument, MissingRanges, lt_Instrument> InstrumentMissingRanges;
 
 private:
-    void interpolateMissingRange(const Instrument& instrument, const MissingRanges& mr);
+    void makeTasks(Helpers::TaskGraph& tasks, const InstrumentMissingRanges& instrumentMissingRanges);
+    void interpolateMissingRangeTask(const Instrument* instrument, const ParamGroupMissingRange* pgmr, int worker);
+    void interpolateMissingRange(const Instrument& instrument, const ParamGroupMissingRange& pgmr);
+    DBInterface* workerDatabase();
     GapDataPtr findSeriesData(const Instrument& instrument, const TimeRange& t, const ParameterInfo& pi);
     bool seriesHasMissingRows(GapData& data);
     void discardUnreliableMinMax(GapData& data);
@@ -84,11 +101,12 @@ private:
 
     const ParameterInfo& findParameterInfo(int parameter);
     bool checkTimeRangeLimits(const Instrument& instrument, const ParamGroupMissingRange& pgmr);
-    bool replaceFromOtherTypeid(GapUpdate& data);
+    bool replaceFromOtherTypeid(GapUpdate& data, const DBInterface::DataList& other);
 
 public:
     NeighborDataVector findNeighborData(int stationid, int paramid, float maxsigma);
-    Interpolation::SupportDataList getNeighborData(const TimeRange& t, int neighborid, int paramid);
+    typedef std::vector<Interpolation::SupportDataList> NeighborSupportData;
+    NeighborSupportData getNeighborData(const TimeRange& t, const std::vector<int>& neighborids, int paramid);
 
 private:
     typedef DBInterface::DataList DataList;
@@ -101,6 +119,13 @@ private:
     std::vector<int> tids;
     float mRAThreshold;
 
+    NeighborCorrelationCache mNeighborCorrelations;
+
+    int mThreads;
+    std::vector< std::shared_ptr<DBInterface> > mWorkerDatabases;
+    boost::thread_specific_ptr<DBInterface> mWorkerDatabase;
+    boost::mutex mOutputMutex;
+
     FlagSetCU missing_flags, mNeighborFlags, mDataFlagsUUTA;
     FlagChange missing_flagchange_good, missing_flagchange_bad, missing_flagchange_failed, missing_flagchange_common;
 };
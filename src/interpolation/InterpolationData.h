@@ -123,6 +123,53 @@ private:
 typedef std::vector<SupportData> SupportDataList;
 typedef std::vector<SeriesData> SeriesDataList;
 
+/** Values and usable flags of a support series in contiguous arrays. */
+class SupportArrays {
+public:
+    explicit SupportArrays(int n = 0)
+        : mValue(n, MISSING_VALUE), mUsable(n, 0) { }
+
+    int size() const
+        { return mValue.size(); }
+
+    SupportData at(int t) const
+        { return SupportData(mValue[t], mUsable[t]); }
+
+    void set(int t, const SupportData& s)
+        { mValue[t] = s.value(); mUsable[t] = s.usable(); }
+
+    const std::vector<float>& values() const
+        { return mValue; }
+
+private:
+    std::vector<float> mValue;
+    std::vector<char> mUsable;
+};
+
+/** Values, qualities and usable flags of a series in contiguous arrays. */
+class SeriesArrays {
+public:
+    explicit SeriesArrays(int n = 0)
+        : mValue(n, MISSING_VALUE), mQuality(n, MISSING), mUsable(n, 0) { }
+
+    int size() const
+        { return mValue.size(); }
+
+    SeriesData at(int t) const
+        { return SeriesData(mValue[t], static_cast<Quality>(mQuality[t]), mUsable[t]); }
+
+    void set(int t, const SeriesData& s)
+        { mValue[t] = s.original(); mQuality[t] = s.quality(); mUsable[t] = s.usable(); }
+
+    const std::vector<float>& values() const
+        { return mValue; }
+
+private:
+    std::vector<float> mValue;
+    std::vector<unsigned char> mQuality;
+    std::vector<char> mUsable;
+};
+
 } // namespace Interpolation
 
 std::ostream& operator<<(std::ostream& out, const Interpolation::SupportData& s);
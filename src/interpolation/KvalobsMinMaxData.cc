@@ -45,3 +45,24 @@ float KvalobsMinMaxReconstructionData::fluctuationLevel()
 {
     return mData.mParameterInfo.fluctuationLevel;
 }
+
+// ========================================================================
+
+KvalobsMinMaxReconstructionArrays::KvalobsMinMaxReconstructionArrays(GapData& data)
+    : mData(data)
+    , mParameter(data.duration())
+    , mMinimum(data.minimumArrays())
+    , mMaximum(data.maximumArrays())
+{
+    const int d = mParameter.size();
+    for(int t=0; t<d; ++t) {
+        const SeriesData sd(mData.parameter(t));
+        const int q = sd.quality();
+        mParameter.set(t, SupportData(sd.value(), q < Interpolation::FAILED));
+    }
+}
+
+float KvalobsMinMaxReconstructionArrays::fluctuationLevel() const
+{
+    return mData.mParameterInfo.fluctuationLevel;
+}
@@ -60,6 +60,37 @@ private:
 
 // ========================================================================
 
+/** Dense, non-virtual counterpart of KvalobsMinMaxInterpolatorData for MinMaxInterpolator::runDirect. */
+class KvalobsMinMaxInterpolatorArrays {
+public:
+    KvalobsMinMaxInterpolatorArrays(GapData& data)
+        : mData(data)
+        , mParameter(data.parameterArrays())
+        , mMinimum(data.minimumArrays())
+        , mMaximum(data.maximumArrays()) { }
+
+    int duration() const
+        { return mParameter.size(); }
+
+    Interpolation::SeriesData parameter(int time) const
+        { return mParameter.at(time); }
+
+    void setParameter(int time, Interpolation::Quality q, float value)
+        { mData.setParameter(time, q, value); mParameter.set(time, mData.parameter(time)); }
+
+    Interpolation::SupportData minimum(int time) const
+        { return mMinimum.at(time); }
+
+    Interpolation::SupportData maximum(int time) const
+        { return mMaximum.at(time); }
+
+private:
+    GapData& mData;
+    Interpolation::SeriesArrays mParameter, mMinimum, mMaximum;
+};
+
+// ========================================================================
+
 class KvalobsMinMaxReconstructionData : public Interpolation::MinMaxReconstruction::Data {
 public:
     KvalobsMinMaxReconstructionData(GapData& data)
@@ -89,4 +120,37 @@ private:
     float mFluctuationLevel;
 };
 
+// ========================================================================
+
+/** Dense, non-virtual counterpart of KvalobsMinMaxReconstructionData for MinMaxReconstruction::runDirect. */
+class KvalobsMinMaxReconstructionArrays {
+public:
+    KvalobsMinMaxReconstructionArrays(GapData& data);
+
+    int duration() const
+        { return mParameter.size(); }
+
+    float fluctuationLevel() const;
+
+    Interpolation::SupportData parameter(int time) const
+        { return mParameter.at(time); }
+
+    Interpolation::SeriesData minimum(int time) const
+        { return mMinimum.at(time); }
+
+    Interpolation::SeriesData maximum(int time) const
+        { return mMaximum.at(time); }
+
+    void setMinimum(int time, Interpolation::Quality q, float value)
+        { mData.setMinimum(time, q, value); mMinimum.set(time, mData.minimum(time)); }
+
+    void setMaximum(int time, Interpolation::Quality q, float value)
+        { mData.setMaximum(time, q, value); mMaximum.set(time, mData.maximum(time)); }
+
+private:
+    GapData& mData;
+    Interpolation::SupportArrays mParameter;
+    Interpolation::SeriesArrays mMinimum, mMaximum;
+};
+
 #endif /* KVALOBSMINMAXDATA_H_ */
@@ -83,3 +83,26 @@ float KvalobsNeighborData::neighborWeight(int neighbor)
 {
     return mData.neighborWeight(neighbor);
 }
+
+// ========================================================================
+
+KvalobsNeighborArrays::KvalobsNeighborArrays(GapData& data)
+    : mData(data)
+    , mMaximumOffset(data.mParameterInfo.maxOffset)
+    , mParameter(data.parameterArrays())
+    , mModel(data.modelArrays())
+    , mNeighborsLoaded(false)
+{
+}
+
+void KvalobsNeighborArrays::loadNeighbors() const
+{
+    const int nc = mData.neighborCount();
+    mNeighbors.reserve(nc);
+    mWeights.reserve(nc);
+    for(int n=0; n<nc; ++n) {
+        mNeighbors.push_back(mData.transformedNeighborArrays(n));
+        mWeights.push_back(mData.neighborWeight(n));
+    }
+    mNeighborsLoaded = true;
+}
@@ -33,6 +33,8 @@
 #include "GapData.hh"
 #include "NeighborInterpolator.h"
 
+#include <vector>
+
 class KvalobsNeighborData : public Interpolation::NeighborInterpolator::Data {
 public:
     KvalobsNeighborData(GapData& data);
@@ -52,4 +54,52 @@ private:
     GapData& mData;
 };
 
+// ========================================================================
+
+/**
+ * Dense, non-virtual counterpart of KvalobsNeighborData for
+ * NeighborInterpolator::runDirect. Neighbor series are fetched at
+ * their first use.
+ */
+class KvalobsNeighborArrays {
+public:
+    KvalobsNeighborArrays(GapData& data);
+
+    int duration() const
+        { return mParameter.size(); }
+
+    float maximumOffset() const
+        { return mMaximumOffset; }
+
+    Interpolation::SeriesData parameter(int time) const
+        { return mParameter.at(time); }
+
+    void setParameter(int time, Interpolation::Quality q, float value)
+        { mData.setParameter(time, q, value); mParameter.set(time, mData.parameter(time)); }
+
+    Interpolation::SupportData model(int time) const
+        { return mModel.at(time); }
+
+    int neighborCount() const
+        { return mData.neighborCount(); }
+
+    Interpolation::SupportData transformedNeighbor(int n, int time) const
+        { if( !mNeighborsLoaded ) loadNeighbors(); return mNeighbors[n].at(time); }
+
+    float neighborWeight(int n) const
+        { if( !mNeighborsLoaded ) loadNeighbors(); return mWeights[n]; }
+
+private:
+    void loadNeighbors() const;
+
+private:
+    GapData& mData;
+    float mMaximumOffset;
+    Interpolation::SeriesArrays mParameter;
+    Interpolation::SupportArrays mModel;
+    mutable bool mNeighborsLoaded;
+    mutable std::vector<Interpolation::SupportArrays> mNeighbors;
+    mutable std::vector<float> mWeights;
+};
+
 #endif /* KVALOBSNEIGHBORDATA_H_ */
@@ -44,8 +44,13 @@ public:
 
     Summary run(Data& data);
 
+    /** Same as run(Data&), for data classes with non-virtual accessors; see MinMaxInterpolator.icc. */
+    template<class D>
+    Summary runDirect(D& data);
+
 private:
-    Summary interpolateFromMinMax(Data& data);
+    template<class D>
+    Summary interpolateFromMinMax(D& data);
 };
 
 } // namespace Interpolation
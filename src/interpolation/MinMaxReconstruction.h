@@ -53,9 +53,16 @@ public:
 
     Summary run(Data& data);
 
+    /** Same as run(Data&), for data classes with non-virtual accessors; see MinMaxReconstruction.icc. */
+    template<class D>
+    Summary runDirect(D& data);
+
 private:
-    void failMinMaxIfNeeded(Data& data, int time, Summary& results);
-    Summary reconstructMinMax(Data& data);
+    template<class D>
+    void failMinMaxIfNeeded(D& data, int time, Summary& results);
+
+    template<class D>
+    Summary reconstructMinMax(D& data);
 };
 
 } // namespace Interpolation
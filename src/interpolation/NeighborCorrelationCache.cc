@@ -0,0 +1,73 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "NeighborCorrelationCache.h"
+
+#include <algorithm>
+
+#include "gdebug.h"
+
+NeighborCorrelationCache::NeighborCorrelationCache()
+    : mLoaded(false)
+{
+}
+
+// ------------------------------------------------------------------------
+
+void NeighborCorrelationCache::refresh(DBInterface* db, const std::vector<int>& paramids)
+{
+    std::vector<int> pids(paramids);
+    std::sort(pids.begin(), pids.end());
+    pids.erase(std::unique(pids.begin(), pids.end()), pids.end());
+
+    const std::string version = db->findNeighborDataVersion(pids);
+    if( mLoaded and pids == mParamIds and version == mVersion )
+        return;
+
+    DBG("reloading neighbor correlations, version '" << version << "'");
+    mNeighbors = db->findNeighborData(pids);
+    mParamIds = pids;
+    mVersion = version;
+    mLoaded = true;
+}
+
+// ------------------------------------------------------------------------
+
+NeighborDataVector NeighborCorrelationCache::find(int stationid, int paramid, float maxsigma) const
+{
+    const NeighborDataMap::const_iterator it = mNeighbors.find(std::make_pair(stationid, paramid));
+    if( it == mNeighbors.end() )
+        return NeighborDataVector();
+
+    const NeighborDataVector& all = it->second;
+    NeighborDataVector::const_iterator end = all.begin();
+    while( end != all.end() and end->sigma < maxsigma )
+        ++end;
+    return NeighborDataVector(all.begin(), end);
+}
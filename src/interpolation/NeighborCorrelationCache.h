@@ -1,7 +1,7 @@
 /* -*- c++ -*-
   Kvalobs - Free Quality Control Software for Meteorological Observations
 
-  Copyright (C) 2011 met.no
+  Copyright (C) 2013 met.no
 
   Contact information:
   Norwegian Meteorological Institute
@@ -27,32 +27,37 @@
   51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
 */
 
-#ifndef DAYVALUE_H_
-#define DAYVALUE_H_
+#ifndef NEIGHBORCORRELATIONCACHE_H_
+#define NEIGHBORCORRELATIONCACHE_H_
 
-#include "helpers/timeutil.h"
+#include "DBInterface.h"
 
-class DayValue {
-public:
-    DayValue()
-        : mDay(-1) { }
-
-    DayValue(int day)
-        : mDay(day) { }
+#include <string>
+#include <vector>
 
-    virtual ~DayValue();
+/**
+ * Caches the contents of qc2_interpolation_best_neighbors for a set of
+ * parameters. The table only changes when the offline fit is rerun,
+ * so it is reloaded only when its version text changes.
+ */
+class NeighborCorrelationCache {
+public:
+    NeighborCorrelationCache();
 
-    int day() const
-        { return mDay; }
+    /** Reload the correlations if the parameter set or the table version changed. */
+    void refresh(DBInterface* db, const std::vector<int>& paramids);
 
-    void setDay(int day)
-        { mDay = day; }
+    /** Neighbors of a station with sigma < maxsigma, sorted by increasing sigma. */
+    NeighborDataVector find(int stationid, int paramid, float maxsigma) const;
 
-    int normalisedDayOfYear(const kvtime::date& day0) const;
+    bool isLoaded() const
+        { return mLoaded; }
 
 private:
-    int mDay;
+    bool mLoaded;
+    std::vector<int> mParamIds;
+    std::string mVersion;
+    NeighborDataMap mNeighbors;
 };
-typedef std::shared_ptr<DayValue> DayValueP;
 
-#endif /* DAYVALUE_H_ */
+#endif /* NEIGHBORCORRELATIONCACHE_H_ */
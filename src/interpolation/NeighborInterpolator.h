@@ -54,6 +54,10 @@ public:
 
     Interpolation::Summary run(Data& data);
 
+    /** Same as run(Data&), for data classes with non-virtual accessors; see NeighborInterpolator.icc. */
+    template<class D>
+    Interpolation::Summary runDirect(D& data);
+
 };
 
 } // namespace Interpolation
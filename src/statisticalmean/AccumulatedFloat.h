@@ -30,11 +30,9 @@
 #ifndef ACCUMULATEDFLOAT_H_
 #define ACCUMULATEDFLOAT_H_
 
-#include "AccumulatedValue.h"
-
-struct AccumulatedFloat : public AccumulatedValue {
+struct AccumulatedFloat {
     float value;
-    AccumulatedFloat(float v) : value(v) { }
+    AccumulatedFloat(float v = 0) : value(v) { }
 };
 
 #endif /* ACCUMULATEDFLOAT_H_ */
@@ -30,15 +30,13 @@
 #ifndef ACCUMULATEDQUARTILES_H_
 #define ACCUMULATEDQUARTILES_H_
 
-#include "AccumulatedValue.h"
-
-struct AccumulatedQuartiles : public AccumulatedValue {
+struct AccumulatedQuartiles {
     float q1, q2, q3;
     float q(int i) const { if(i==0) return q1; else if(i==1) return q2; else if(i==2) return q3; else return -9999; }
+    AccumulatedQuartiles()
+        : q1(0), q2(0), q3(0) { }
     AccumulatedQuartiles(float qq1, float qq2, float qq3)
         : q1(qq1), q2(qq2), q3(qq3) { }
 };
 
-typedef std::shared_ptr<AccumulatedQuartiles> AccumulatedQuartilesP;
-
 #endif /* ACCUMULATEDQUARTILES_H_ */
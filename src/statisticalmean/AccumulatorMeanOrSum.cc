@@ -29,27 +29,13 @@
 
 #include "AccumulatorMeanOrSum.h"
 
-#include "AccumulatedFloat.h"
-#include "DayMean.h"
-
-void AccumulatorMeanOrSum::push(DayValueP value)
-{
-    mCountDays += 1;
-    mSum += std::static_pointer_cast<DayMean>(value)->mean();
-}
-
-void AccumulatorMeanOrSum::pop(DayValueP value)
-{
-    mCountDays -= 1;
-    mSum -= std::static_pointer_cast<DayMean>(value)->mean();
-}
-
-AccumulatedValueP AccumulatorMeanOrSum::value()
+bool AccumulatorMeanOrSum::value(Value& accumulated) const
 {
     if( mCountDays<=0 || mCountDays < mDaysRequired )
-        return AccumulatedValueP();
+        return false;
     if( mCalculateMean )
-        return std::make_shared<AccumulatedFloat>(mSum / mCountDays);
+        accumulated = Value(mSum / mCountDays);
     else
-        return std::make_shared<AccumulatedFloat>(mSum * float(mDays) / float(mCountDays));
+        accumulated = Value(mSum * float(mDays) / float(mCountDays));
+    return true;
 }
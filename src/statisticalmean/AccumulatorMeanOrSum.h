@@ -30,16 +30,21 @@
 #ifndef ACCUMULATORMEANORSUM_H_
 #define ACCUMULATORMEANORSUM_H_
 
-#include "Accumulator.h"
+#include "AccumulatedFloat.h"
 
-class AccumulatorMeanOrSum : public Accumulator {
+class AccumulatorMeanOrSum {
 public:
+    typedef AccumulatedFloat Value;
+
     AccumulatorMeanOrSum(bool calculateMean, int days, int daysRequired)
-        : mCalculateMean(calculateMean), mDays(days), mDaysRequired(daysRequired) { }
-    virtual void newStation() { mSum = 0; mCountDays = 0; }
-    virtual void push(DayValueP value);
-    virtual void pop(DayValueP value);
-    virtual AccumulatedValueP value();
+        : mCalculateMean(calculateMean), mDays(days), mDaysRequired(daysRequired), mSum(0), mCountDays(0) { }
+    void newStation() { mSum = 0; mCountDays = 0; }
+    void push(float value)
+        { mCountDays += 1; mSum += value; }
+    void pop(float value)
+        { mCountDays -= 1; mSum -= value; }
+    // returns false if there are too few days
+    bool value(Value& accumulated) const;
 private:
     bool mCalculateMean;
     int mDays, mDaysRequired;
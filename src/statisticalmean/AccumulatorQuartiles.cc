@@ -29,31 +29,14 @@
 
 #include "AccumulatorQuartiles.h"
 
-#include "AccumulatedQuartiles.h"
-#include "DayMean.h"
-#include "helpers/mathutil.h"
-
-void AccumulatorQuartiles::push(DayValueP value)
-{
-    float v = std::static_pointer_cast<DayMean>(value)->mean();
-    mValues.push_back(v);
-}
-
-void AccumulatorQuartiles::pop(DayValueP value)
-{
-    float v = std::static_pointer_cast<DayMean>(value)->mean();
-    std::vector<float>::iterator it = std::find(mValues.begin(), mValues.end(), v);
-    if( it != mValues.end() )
-        mValues.erase(it);
-}
-
-AccumulatedValueP AccumulatorQuartiles::value()
+bool AccumulatorQuartiles::value(Value& accumulated) const
 {
     if( mValues.empty() || (int)mValues.size() < mDaysRequired )
-        return AccumulatedValueP();
+        return false;
 
     double q1, q2, q3;
-    Helpers::quartiles(mValues.begin(), mValues.end(), q1, q2, q3);
+    mValues.quartiles(q1, q2, q3);
 
-    return std::make_shared<AccumulatedQuartiles>(q1, q2, q3);
+    accumulated = Value(q1, q2, q3);
+    return true;
 }
@@ -30,20 +30,25 @@
 #ifndef ACCUMULATORQUARTILES_H_
 #define ACCUMULATORQUARTILES_H_
 
-#include "Accumulator.h"
-#include <vector>
+#include "AccumulatedQuartiles.h"
+#include "helpers/OrderStatistics.h"
 
-class AccumulatorQuartiles : public Accumulator {
+class AccumulatorQuartiles {
 public:
+    typedef AccumulatedQuartiles Value;
+
     AccumulatorQuartiles(int days, int daysRequired)
         : mDays(days), mDaysRequired(daysRequired) { }
-    virtual void newStation() { mValues.clear(); }
-    virtual void push(DayValueP value);
-    virtual void pop(DayValueP value);
-    virtual AccumulatedValueP value();
+    void newStation() { mValues.clear(); }
+    void push(float value)
+        { mValues.insert(value); }
+    void pop(float value)
+        { mValues.erase(value); }
+    // returns false if there are too few days
+    bool value(Value& accumulated) const;
 private:
     int mDays, mDaysRequired;
-    std::vector<float> mValues;
+    Helpers::OrderStatistics mValues;
 };
 
 #endif /* ACCUMULATORQUARTILES_H_ */
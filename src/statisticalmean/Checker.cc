@@ -43,6 +43,3 @@ Message Checker::warning()
 {
     return mStatisticalMean->warning();
 }
-
-Checker::~Checker()
-{ }
@@ -30,30 +30,30 @@
 #ifndef CHECKER_H_
 #define CHECKER_H_
 
-#include "AccumulatedValue.h"
 #include "Notifier.h"
 class StatisticalMean;
 
+/**
+ * Common part of the checkers. Each checker (CheckerMeanOrSum,
+ * CheckerQuartiles) provides, for its accumulated value type V:
+ *
+ * - bool newCenter(int id, int dayOfYear, const V& value):
+ *   indicates new center station; return true if ok, i.e. no
+ *   neighbors need to be checked
+ * - bool checkNeighbor(int nbr, const V& value): return true if
+ *   enough neighbors have been seen
+ * - bool pass(): return true if the center station passes the test
+ */
 class Checker {
 public:
     Checker(StatisticalMean* sm);
 
-    // indicates new center station; return true if ok, i.e. no neighbors need to be checked
-    virtual bool newCenter(int id, int dayOfYear, AccumulatedValueP value) = 0;
-    // return true if enough neighbors have been seen
-    virtual bool checkNeighbor(int nbr, AccumulatedValueP value) = 0;
-    // return true if the center station passes the test
-    virtual bool pass() = 0;
-
     float getReference(int stationid, int day, const std::string& key, bool& valid);
 
     Message warning();
 
-    virtual ~Checker();
 private:
     StatisticalMean* mStatisticalMean;
 };
 
-typedef std::shared_ptr<Checker> CheckerP;
-
 #endif /* CHECKER_H_ */
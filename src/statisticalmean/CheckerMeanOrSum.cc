@@ -30,7 +30,7 @@
 #include "CheckerMeanOrSum.h"
 #include <cmath>
 
-bool CheckerMeanOrSum::newCenter(int id, int dayOfYear, AccumulatedValueP accumulated)
+bool CheckerMeanOrSum::newCenter(int id, int dayOfYear, const AccumulatedFloat& accumulated)
 {
     mCenter = id;
     mDayOfYear = dayOfYear;
@@ -40,17 +40,17 @@ bool CheckerMeanOrSum::newCenter(int id, int dayOfYear, AccumulatedValueP accumu
     const float reference = getReference(id, dayOfYear, "ref_value", referenceValid);
     //bool toleranceValid;
     //const float tolerance = getReference(id, dayOfYear, "tolerance", referenceValid);
-    const float value = std::static_pointer_cast<AccumulatedFloat>(accumulated)->value;
+    const float value = accumulated.value;
     return !referenceValid || std::fabs(value - reference) < mTolerance;
 }
 
 // ------------------------------------------------------------------------
 
-bool CheckerMeanOrSum::checkNeighbor(int nbr, AccumulatedValueP accumulated)
+bool CheckerMeanOrSum::checkNeighbor(int nbr, const AccumulatedFloat& accumulated)
 {
     bool referenceValid;
     const float reference = getReference(nbr, mDayOfYear, "ref_value", referenceValid);
-    const float value = std::static_pointer_cast<AccumulatedFloat>(accumulated)->value;
+    const float value = accumulated.value;
     if( referenceValid && std::fabs(value - reference) < mTolerance )
         mCountNeighborsBelowTolerance += 1;
     return mCountNeighborsBelowTolerance <= 3;
@@ -38,8 +38,8 @@ class CheckerMeanOrSum : public Checker {
 public:
     CheckerMeanOrSum(StatisticalMean* sm, float tolerance)
         : Checker(sm), mTolerance(tolerance) { }
-    bool newCenter(int id, int dayOfYear, AccumulatedValueP accumulated);
-    bool checkNeighbor(int nbr, AccumulatedValueP accumulated);
+    bool newCenter(int id, int dayOfYear, const AccumulatedFloat& accumulated);
+    bool checkNeighbor(int nbr, const AccumulatedFloat& accumulated);
     bool pass();
 private:
     int mDayOfYear, mCenter, mCountNeighborsBelowTolerance;
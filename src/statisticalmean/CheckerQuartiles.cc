@@ -29,8 +29,6 @@
 
 #include "CheckerQuartiles.h"
 
-#include "AccumulatedQuartiles.h"
-#include <boost/format.hpp>
 #include <cmath>
 
 CheckerQuartiles::CheckerQuartiles(StatisticalMean* sm, int days, const std::vector<float>& tolerances)
@@ -39,13 +37,13 @@ CheckerQuartiles::CheckerQuartiles(StatisticalMean* sm, int days, const std::vec
 
 // ------------------------------------------------------------------------
 
-bool CheckerQuartiles::calculateDiffsToReferences(int station, int dOy, float diffs[3], AccumulatedValueP accumulated)
+bool CheckerQuartiles::calculateDiffsToReferences(int station, int dOy, float diffs[3], const AccumulatedQuartiles& accumulated)
 {
-    AccumulatedQuartilesP quartiles = std::static_pointer_cast<AccumulatedQuartiles>(accumulated);
+    static const std::string keys[3] = { "ref_q1", "ref_q2", "ref_q3" };
     bool valid[3] = { false, false, false };
     for(int i=0; i<3; ++i) {
-        const float ref = getReference(station, dOy, (boost::format("ref_q%1$d") % (i+1)).str(), valid[i]);
-        diffs[i] = valid[i] ? std::fabs(quartiles->q(i) - ref) : 0;
+        const float ref = getReference(station, dOy, keys[i], valid[i]);
+        diffs[i] = valid[i] ? std::fabs(accumulated.q(i) - ref) : 0;
     }
     if( !valid[0] || !valid[1] || !valid[2] ) {
         Message w = warning();
@@ -61,7 +59,7 @@ bool CheckerQuartiles::calculateDiffsToReferences(int station, int dOy, float di
 
 // ------------------------------------------------------------------------
 
-bool CheckerQuartiles::newCenter(int id, int dayOfYear, AccumulatedValueP accumulated)
+bool CheckerQuartiles::newCenter(int id, int dayOfYear, const AccumulatedQuartiles& accumulated)
 {
     mCenter = id;
     mDayOfYear = dayOfYear;
@@ -76,7 +74,7 @@ bool CheckerQuartiles::newCenter(int id, int dayOfYear, AccumulatedValueP accumu
 
 // ------------------------------------------------------------------------
 
-bool CheckerQuartiles::checkNeighbor(int nbr, AccumulatedValueP accumulated)
+bool CheckerQuartiles::checkNeighbor(int nbr, const AccumulatedQuartiles& accumulated)
 {
     float nDiffsQ[3];
     if( calculateDiffsToReferences(nbr, mDayOfYear, nDiffsQ, accumulated) ) {
@@ -30,17 +30,18 @@
 #ifndef CHECKERQUARTILES_H_
 #define CHECKERQUARTILES_H_
 
+#include "AccumulatedQuartiles.h"
 #include "Checker.h"
 #include <vector>
 
 class CheckerQuartiles : public Checker {
 public:
     CheckerQuartiles(StatisticalMean* sm, int days, const std::vector<float>& tolerances);
-    bool newCenter(int id, int dayOfYear, AccumulatedValueP accumulated);
-    bool checkNeighbor(int nbr, AccumulatedValueP accumulated);
+    bool newCenter(int id, int dayOfYear, const AccumulatedQuartiles& accumulated);
+    bool checkNeighbor(int nbr, const AccumulatedQuartiles& accumulated);
     bool pass();
 private:
-    bool calculateDiffsToReferences(int station, int dOy, float diffs[3], AccumulatedValueP accumulated);
+    bool calculateDiffsToReferences(int station, int dOy, float diffs[3], const AccumulatedQuartiles& accumulated);
 private:
     int mDays, mDayOfYear, mCenter, mCountNeighborsWithError;
     std::vector<float> mTolerances;
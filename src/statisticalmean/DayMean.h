@@ -30,18 +30,11 @@
 #ifndef DAYMEAN_H_
 #define DAYMEAN_H_
 
-#include "DayValue.h"
-
-class DayMean : public DayValue {
-public:
-    DayMean(float mean)
-        : mMean(mean) { }
-
-    float mean() const
-        { return mMean; }
-
-private:
-    float mMean;
+struct DayMean {
+    int day;
+    float mean;
+    DayMean(int d, float m)
+        : day(d), mean(m) { }
 };
 
 #endif /* DAYMEAN_H_ */
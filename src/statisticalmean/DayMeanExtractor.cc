@@ -33,8 +33,9 @@
 
 DayMeanExtractor::DayMeanExtractor(bool cm, int paramid)
     : mCalculateMean(cm)
-    , mParamid(paramid)
+    , mHourPattern(hourPattern(paramid))
 {
+    newDay();
 }
 
 void DayMeanExtractor::newDay()
@@ -44,9 +45,16 @@ void DayMeanExtractor::newDay()
     mSum = 0;
 }
 
+void DayMeanExtractor::setDay(float sum, int count)
+{
+    mHours = 0;
+    mCountHours = count;
+    mSum = sum;
+}
+
 bool DayMeanExtractor::addObservation(const kvtime::time& obstime, float original)
 {
-    const int h = kvtime::hour(obstime), hBit = (1<<h), hp = hourPattern();
+    const int h = kvtime::hour(obstime), hBit = (1<<h), hp = mHourPattern;
     if( (hp & hBit) == 0 )
         return false;
 
@@ -56,29 +64,29 @@ bool DayMeanExtractor::addObservation(const kvtime::time& obstime, float origina
     return true;
 }
 
-int DayMeanExtractor::hourPattern()
+int DayMeanExtractor::hourPattern(int paramid)
 {
-    if( mParamid == 106 /* RR_1 */ )
+    if( paramid == 106 /* RR_1 */ )
         return (1<<24)-1;
-    if( mParamid == 108 /* RR_6 */ )
+    if( paramid == 108 /* RR_6 */ )
         return (1<<0 | 1<<6 | 1<<12 | 1<<18);
-    if( mParamid == 109 /* RR_12 */ )
+    if( paramid == 109 /* RR_12 */ )
         return (1<<6 | 1<<18);
-    if( mParamid == 110 /* RR_24 */ )
+    if( paramid == 110 /* RR_24 */ )
         return 1<<6;
     // otherwise allow everything
     return (1<<24)-1;
 }
 
-bool DayMeanExtractor::isCompleteDay()
+bool DayMeanExtractor::isCompleteDay() const
 {
     return (!mCalculateMean || mCountHours > 0);
 }
 
-DayValueP DayMeanExtractor::value()
+float DayMeanExtractor::value() const
 {
     float v = mSum;
     if( mCalculateMean )
         v /= mCountHours;
-    return std::make_shared<DayMean>(v);
+    return v;
 }
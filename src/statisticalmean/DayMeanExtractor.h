@@ -30,26 +30,32 @@
 #ifndef DAYMEANEXTRACTOR_H_
 #define DAYMEANEXTRACTOR_H_
 
-#include "DayMean.h"
-#include "DayValueExtractor.h"
+#include "helpers/timeutil.h"
 
-class DayMeanExtractor : public DayValueExtractor {
+class DayMeanExtractor {
 public:
     DayMeanExtractor(bool calculateMean, int paramid);
-    virtual void newDay();
-    virtual bool addObservation(const kvtime::time& obstime, float original);
-    virtual bool isCompleteDay();
-    virtual DayValueP value();
+    void newDay();
+    bool addObservation(const kvtime::time& obstime, float original);
+    bool isCompleteDay() const;
+    float value() const;
+
+    float sum() const
+        { return mSum; }
+    int count() const
+        { return mCountHours; }
+
+    /** Restore sum and count of accepted observations, e.g. from a stored daily aggregate. */
+    void setDay(float sum, int count);
 
 private:
-    int hourPattern();
+    static int hourPattern(int paramid);
 
 private:
     bool mCalculateMean;
-    int mParamid;
+    int mHourPattern;
     int mHours, mCountHours;
     float mSum;
 };
-typedef std::shared_ptr<DayMeanExtractor> DayMeanExtractorP;
 
 #endif /* DAYMEANEXTRACTOR_H_ */
@@ -29,10 +29,18 @@
 
 #include "Factory.h"
 
-Factory::~Factory()
+#include "AlgorithmConfig.h"
+
+Factory::Factory()
+    : mTolerance(10.0f)
+    , mDays(30)
+    , mDaysRequired(int(0.9*mDays + 0.5))
 {
 }
 
-void Factory::configure(StatisticalMean*, const AlgorithmConfig&)
+void Factory::configure(const AlgorithmConfig& params)
 {
+    mTolerance = params.getParameter<float>("tolerance", 10.0f);
+    mDays = params.getParameter<int>("days", 30);
+    mDaysRequired = params.getParameter<int>("days_required", int(0.9*mDays + 0.5));
 }
@@ -30,20 +30,25 @@
 #ifndef FACTORY_H_
 #define FACTORY_H_
 
-#include "Accumulator.h"
-#include "Checker.h"
-#include "DayValueExtractor.h"
+#include "DayMeanExtractor.h"
 class AlgorithmConfig;
 class StatisticalMean;
 
+/**
+ * Common configuration of the factories. Each factory (MeanFactory,
+ * SumFactory, QuartilesFactory) defines the types Accumulator and
+ * Checker, a static appliesTo(paramid) and creates the accumulator,
+ * checker and day value extractor as values, so that StatisticalMean
+ * can choose the implementation at compile time.
+ */
 class Factory {
 public:
-    virtual ~Factory();
-    virtual void configure(StatisticalMean* stm, const AlgorithmConfig& config);
-    virtual bool appliesTo(int paramid) = 0;
-    virtual CheckerP checker(int paramid) = 0;
-    virtual AccumulatorP accumulator(int paramid) = 0;
-    virtual DayValueExtractorP dayValueExtractor(int paramid) = 0;
+    Factory();
+    void configure(const AlgorithmConfig& config);
+
+protected:
+    float mTolerance;
+    int mDays, mDaysRequired;
 };
 
 #endif /* FACTORY_H_ */
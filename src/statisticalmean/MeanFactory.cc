@@ -29,35 +29,22 @@
 
 #include "MeanFactory.h"
 
-#include "AlgorithmConfig.h"
-#include "DayMeanExtractor.h"
-
-void MeanFactory::configure(StatisticalMean* stm, const AlgorithmConfig& params)
-{
-    const float tolerance = params.getParameter<float>("tolerance", 10.0f);
-    const int days = params.getParameter<int>("days", 30);
-    const int daysRequired = params.getParameter<int>("days_required", int(0.9*days + 0.5));
-
-    mAccumulator = std::make_shared<AccumulatorMeanOrSum>(true, days, daysRequired);
-    mChecker = std::make_shared<CheckerMeanOrSum>(stm, tolerance);
-}
-
 bool MeanFactory::appliesTo(int paramid)
 {
     return ( paramid == 178 /* PR */ || paramid == 211 /* TA */ );
 }
 
-CheckerP MeanFactory::checker(int /*paramid*/)
+MeanFactory::Checker MeanFactory::checker(StatisticalMean* stm) const
 {
-    return mChecker;
+    return CheckerMeanOrSum(stm, mTolerance);
 }
 
-AccumulatorP MeanFactory::accumulator(int /*paramid*/)
+MeanFactory::Accumulator MeanFactory::accumulator() const
 {
-    return mAccumulator;
+    return AccumulatorMeanOrSum(true, mDays, mDaysRequired);
 }
 
-DayValueExtractorP MeanFactory::dayValueExtractor(int paramid)
+DayMeanExtractor MeanFactory::dayValueExtractor(int paramid) const
 {
-    return std::make_shared<DayMeanExtractor>(true, paramid);
+    return DayMeanExtractor(true, paramid);
 }
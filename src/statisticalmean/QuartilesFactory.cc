@@ -29,36 +29,23 @@
 
 #include "QuartilesFactory.h"
 
-#include "AlgorithmConfig.h"
-#include "DayMeanExtractor.h"
-
-void QuartilesFactory::configure(StatisticalMean* stm, const AlgorithmConfig& params)
-{
-    const float tolerance = params.getParameter<float>("tolerance", 10.0f);
-    const int days = params.getParameter<int>("days", 30);
-    const int daysRequired = params.getParameter<int>("days_required", int(0.9*days + 0.5));
-
-    mAccumulator = std::make_shared<AccumulatorQuartiles>(days, daysRequired);
-    mChecker = std::make_shared<CheckerQuartiles>(stm, days, std::vector<float>(6, tolerance));
-}
-
 bool QuartilesFactory::appliesTo(int paramid)
 {
     return ( paramid == 262 /* UU */ || paramid == 15 /* NN */ || paramid == 55 /* HL */
             || paramid == 273 /* VV */ || paramid == 200 /* QO */ || paramid == 2070 /* QSI */);
 }
 
-CheckerP QuartilesFactory::checker(int /*paramid*/)
+QuartilesFactory::Checker QuartilesFactory::checker(StatisticalMean* stm) const
 {
-    return mChecker;
+    return CheckerQuartiles(stm, mDays, std::vector<float>(6, mTolerance));
 }
 
-AccumulatorP QuartilesFactory::accumulator(int /*paramid*/)
+QuartilesFactory::Accumulator QuartilesFactory::accumulator() const
 {
-    return mAccumulator;
+    return AccumulatorQuartiles(mDays, mDaysRequired);
 }
 
-DayValueExtractorP QuartilesFactory::dayValueExtractor(int paramid)
+DayMeanExtractor QuartilesFactory::dayValueExtractor(int paramid) const
 {
-    return std::make_shared<DayMeanExtractor>(true, paramid);
+    return DayMeanExtractor(true, paramid);
 }
@@ -36,14 +36,13 @@
 
 class QuartilesFactory : public Factory {
 public:
-    virtual void configure(StatisticalMean* stm, const AlgorithmConfig& config);
-    virtual bool appliesTo(int paramid);
-    virtual CheckerP checker(int paramid);
-    virtual AccumulatorP accumulator(int paramid);
-    virtual DayValueExtractorP dayValueExtractor(int paramid);
-private:
-    std::shared_ptr<AccumulatorQuartiles> mAccumulator;
-    std::shared_ptr<CheckerQuartiles> mChecker;
+    typedef AccumulatorQuartiles Accumulator;
+    typedef CheckerQuartiles Checker;
+
+    static bool appliesTo(int paramid);
+    Checker checker(StatisticalMean* stm) const;
+    Accumulator accumulator() const;
+    DayMeanExtractor dayValueExtractor(int paramid) const;
 };
 
 #endif /* QUARTILESFACTORY_H_ */
@@ -0,0 +1,95 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "ReferenceValueCache.h"
+
+#include "foreach.h"
+
+#include <algorithm>
+
+ReferenceValues::ReferenceValues(const DBInterface::reference_value_map_t& rvm)
+{
+    mStations.reserve(rvm.size());
+    mValues.reserve(rvm.size() * DAYS);
+    foreach(const DBInterface::reference_value_map_t::value_type& s_rv, rvm) {
+        // reference_value_map_t is ordered by station
+        mStations.push_back(s_rv.first);
+        mValues.insert(mValues.end(), s_rv.second.begin(), s_rv.second.begin() + DAYS);
+    }
+}
+
+// ------------------------------------------------------------------------
+
+const float* ReferenceValues::find(int stationid) const
+{
+    const std::vector<int>::const_iterator it = std::lower_bound(mStations.begin(), mStations.end(), stationid);
+    if( it == mStations.end() || *it != stationid )
+        return 0;
+    return values(it - mStations.begin());
+}
+
+// ########################################################################
+
+void ReferenceValueCache::newRun()
+{
+    foreach(Entries::value_type& e, mEntries)
+        e.second.checked = false;
+}
+
+// ------------------------------------------------------------------------
+
+const ReferenceValues* ReferenceValueCache::find(const Key& key) const
+{
+    const Entries::const_iterator it = mEntries.find(key);
+    if( it == mEntries.end() || !it->second.checked )
+        return 0;
+    return &it->second.values;
+}
+
+// ------------------------------------------------------------------------
+
+const ReferenceValues* ReferenceValueCache::validate(const Key& key, const std::string& version)
+{
+    const Entries::iterator it = mEntries.find(key);
+    if( it == mEntries.end() || it->second.version != version )
+        return 0;
+    it->second.checked = true;
+    return &it->second.values;
+}
+
+// ------------------------------------------------------------------------
+
+const ReferenceValues& ReferenceValueCache::store(const Key& key, const std::string& version, const ReferenceValues& values)
+{
+    Entry& e = mEntries[key];
+    e.version = version;
+    e.checked = true;
+    e.values = values;
+    return e.values;
+}
@@ -0,0 +1,107 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef REFERENCEVALUECACHE_H_
+#define REFERENCEVALUECACHE_H_
+
+#include "DBInterface.h"
+
+#include <boost/tuple/tuple.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Reference values for all stations, 365 values per station, stored
+ * in one contiguous buffer with stations in increasing order.
+ */
+class ReferenceValues {
+public:
+    enum { DAYS = 365 };
+
+    ReferenceValues() { }
+    explicit ReferenceValues(const DBInterface::reference_value_map_t& rvm);
+
+    int size() const
+        { return mStations.size(); }
+
+    int station(int i) const
+        { return mStations[i]; }
+
+    const float* values(int i) const
+        { return &mValues[i*DAYS]; }
+
+    float* values(int i)
+        { return &mValues[i*DAYS]; }
+
+    /** Returns DAYS values for the station, or 0 if there are none. */
+    const float* find(int stationid) const;
+
+private:
+    std::vector<int> mStations;
+    std::vector<float> mValues;
+};
+
+// ########################################################################
+
+/**
+ * Keeps reference values from qc2_statistical_reference_values over
+ * several runs. Each entry is checked against the table version once
+ * per run and reloaded only if the version text changed.
+ */
+class ReferenceValueCache {
+public:
+    /** Identifies cached values: paramid, key, days, days_required and missing value. */
+    typedef boost::tuple<int, std::string, int, int, float> Key;
+
+    /** Require a new version check for all entries before they are used again. */
+    void newRun();
+
+    /** Returns the cached values if they have been checked in this run, otherwise 0. */
+    const ReferenceValues* find(const Key& key) const;
+
+    /** Returns the cached values if they have the given version, otherwise 0. */
+    const ReferenceValues* validate(const Key& key, const std::string& version);
+
+    /** Replaces the cached values, returns a reference to the stored copy. */
+    const ReferenceValues& store(const Key& key, const std::string& version, const ReferenceValues& values);
+
+private:
+    struct Entry {
+        std::string version;
+        bool checked;
+        ReferenceValues values;
+        Entry() : checked(false) { }
+    };
+    typedef std::map<Key, Entry> Entries;
+    Entries mEntries;
+};
+
+#endif /* REFERENCEVALUECACHE_H_ */
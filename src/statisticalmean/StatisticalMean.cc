@@ -35,21 +35,36 @@
 #include "algorithms/NeighborsDistance2.h"
 #include "helpers/AlgorithmHelpers.h"
 #include "helpers/timeutil.h"
-#include "AccumulatorQuartiles.h"
 #include "AccumulatorMeanOrSum.h"
-#include "CheckerMeanOrSum.h"
-#include "CheckerQuartiles.h"
-#include "DayMeanExtractor.h"
 #include "MeanFactory.h"
 #include "QuartilesFactory.h"
 #include "SumFactory.h"
 #include "foreach.h"
 
+#include <algorithm>
+
 #ifndef NDEBUG
 #define NDEBUG
 #endif
 #include "debug.h"
 
+namespace {
+
+//! rows with tbtime less than this before an aggregate's computation time are treated as changed, too
+const int CHANGED_MARGIN_MINUTES = 60;
+
+kvtime::time dayStart(const kvtime::date& d)
+{
+    return kvtime::maketime(d.year(), d.month(), d.day(), 0, 0, 0);
+}
+
+kvtime::time dayEnd(const kvtime::date& d)
+{
+    return kvtime::maketime(d.year(), d.month(), d.day(), 23, 59, 59);
+}
+
+} // anonymous namespace
+
 StatisticalMean::StatisticalMean()
     : Qc2Algorithm("StatisticalMean")
     , mNeighbors(new NeighborsDistance2())
@@ -85,6 +100,7 @@ void StatisticalMean::configure(const AlgorithmConfig& config)
     mDays      = config.getParameter<int>("days", 30);
     mDaysRequired = config.getParameter<int>("days_required", int(0.9*mDays + 0.5));
     mMaxBadRatePerDay = config.getParameter<float>("max_bad_rate_per_day", 0.15);
+    mUseDailyAggregates = config.getParameter<bool>("daily_aggregates", false);
     mParamid   = config.getParameter<int>("ParamId");
     mTypeids   = config.getMultiParameter<int>("TypeIds");
 
@@ -92,65 +108,176 @@ void StatisticalMean::configure(const AlgorithmConfig& config)
     kvtime::addDays(mUT0extended, -mDays);
 
     mNeighbors->configure(config);
-    mMeanFactory->configure(this, config);
-    mSumFactory->configure(this, config);
-    mQuartilesFactory->configure(this, config);
+    mMeanFactory->configure(config);
+    mSumFactory->configure(config);
+    mQuartilesFactory->configure(config);
 }
 
 // ------------------------------------------------------------------------
 
-StatisticalMean::smap_t StatisticalMean::fetchData()
+StatisticalMean::smap_t StatisticalMean::fetchData(const TimeRange& time)
 {
     // this fetches all data with this paramid for all stations at
     // once; this might be a lot, but we need all neighbors for each
     // station anyhow
-    const DBInterface::StationIDList stationIDs(1, DBInterface::ALL_STATIONS);
     const std::vector<int> paramid(1, mParamid);
     DBInterface::DataList sdata
-        = database()->findDataOrderStationObstime(stationIDs, paramid, mTypeids, TimeRange(mUT0extended, UT1), ok_flags);
+        = database()->findDataOrderStationObstime(StationSet::norwegian(), paramid, mTypeids, time, ok_flags);
     DBGV(sdata.size());
 
     // sort by station; as sdata is ordered by time, data for each
-    // station will keep this ordering
+    // station will keep this ordering; missing and rejected values are
+    // kept so that aggregateDays can count all rows
     smap_t smap;
-    foreach(const kvalobs::kvData& d, sdata) {
-        if( !Helpers::isMissingOrRejected(d) )
-            smap[Instrument(d)].push_back(d);
-    }
+    foreach(const kvalobs::kvData& d, sdata)
+        smap[Instrument(d)].push_back(d);
     return smap;
 }
 
 // ------------------------------------------------------------------------
 
-StatisticalMean::sdm_t StatisticalMean::findStationDailyMeans(DayValueExtractorP dve)
+DBInterface::DailyAggregateList StatisticalMean::aggregateDays(const TimeRange& time, DayMeanExtractor& dve)
 {
-    const smap_t smap = fetchData();
+    const smap_t smap = fetchData(time);
 
-    const kvtime::date date0 = mUT0extended.date();
-    const int day0 = kvtime::julianDay(date0);
-    sdm_t stationDailyMeans;
-
-    // calculate daily mean values TODO skip for RR_x
+    DBInterface::DailyAggregateList aggregates;
     foreach(const smap_t::value_type& sd, smap) {
         const dlist_t& dl = sd.second;
         for(dlist_t::const_iterator itB = dl.begin(), itE=itB; itB != dl.end(); itB = itE) {
-            dve->newDay();
-            const int day = kvtime::julianDay(itB->obstime().date()) - day0;
-            int obsCount = 0, badCount = 0;
-            for( ; itE != dl.end() && (kvtime::julianDay(itE->obstime().date()) - day0) == day; itE++ ) {
-                obsCount += 1;
-                if( !ok_flags.matches( *itE ) || !dve->addObservation(itE->obstime(), itE->original()) )
+            dve.newDay();
+            const kvtime::date day = itB->obstime().date();
+            int badCount = 0, rowCount = 0;
+            for( ; itE != dl.end() && itE->obstime().date() == day; itE++ ) {
+                rowCount += 1;
+                if( Helpers::isMissingOrRejected(*itE) )
+                    continue;
+                if( !ok_flags.matches( *itE ) || !dve.addObservation(itE->obstime(), itE->original()) )
                     badCount += 1;
             }
-            if( obsCount>0 && badCount/float(obsCount) < mMaxBadRatePerDay && dve->isCompleteDay() ) {
-                DayValueP dv = dve->value();
-                dv->setDay(day);
-                stationDailyMeans[sd.first].push_back(dv);
-            } else {
-                kvtime::date d = date0;
-                kvtime::addDays(d, day);
-                info() << "not enough ok data on " << d << " for statistical checks on " << sd.first;
-            }
+            aggregates.push_back(DailyAggregate(sd.first, day, dve.sum(), dve.count(), badCount, rowCount, mRunStart));
+        }
+    }
+    return aggregates;
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DailyAggregateList StatisticalMean::updateStoredAggregates(const kvtime::date& d0, const kvtime::date& d1, DayMeanExtractor& dve)
+{
+    DBInterface::DailyAggregateList stored = database()->findDailyAggregates(mParamid, mTypeids, d0, d1);
+
+    // for each day, sum up the number of rows and find the oldest
+    // computation time of the stored aggregates
+    const int jd0 = kvtime::julianDay(d0), nDays = kvtime::julianDay(d1) - jd0 + 1;
+    std::vector<int> storedRows(nDays, 0);
+    std::vector<kvtime::time> computed(nDays, mRunStart);
+    kvtime::time oldestComputed = mRunStart;
+    foreach(const DailyAggregate& a, stored) {
+        const int d = kvtime::julianDay(a.day) - jd0;
+        storedRows[d] += a.rowCount;
+        if( a.computed < computed[d] )
+            computed[d] = a.computed;
+        if( a.computed < oldestComputed )
+            oldestComputed = a.computed;
+    }
+
+    // a day must be recalculated if its number of rows differs from
+    // the stored one, i.e. if rows have been inserted or deleted; this
+    // also covers days without stored aggregates but with data
+    const TimeRange time(dayStart(d0), dayEnd(d1));
+    const std::vector<int> paramid(1, mParamid);
+    const DBInterface::DayCountMap rowCounts
+        = database()->countDataPerDay(StationSet::norwegian(), paramid, mTypeids, time, ok_flags);
+    std::vector<char> recalculate(nDays, 0);
+    for(int d = 0; d < nDays; ++d) {
+        kvtime::date day = d0;
+        kvtime::addDays(day, d);
+        const DBInterface::DayCountMap::const_iterator it = rowCounts.find(day);
+        const int rows = (it != rowCounts.end()) ? it->second : 0;
+        recalculate[d] = (rows != storedRows[d]);
+    }
+
+    // a day must also be recalculated if rows were changed after its
+    // aggregates were computed; computation times are run start
+    // times, and the margin catches rows committed with a slightly
+    // older tbtime, e.g. by a transaction started before the run
+    if( !stored.empty() ) {
+        kvtime::time since = oldestComputed;
+        kvtime::addMinutes(since, -CHANGED_MARGIN_MINUTES);
+        const DBInterface::DataList changed = database()->findDataChangedSince(paramid, mTypeids, time, since);
+        foreach(const kvalobs::kvData& d, changed) {
+            const int day = kvtime::julianDay(d.obstime().date()) - jd0;
+            if( kvtime::minDiff(d.tbtime(), computed[day]) > -CHANGED_MARGIN_MINUTES )
+                recalculate[day] = 1;
+        }
+    }
+
+    bool updated = false;
+    for(int b = 0; b < nDays; ) {
+        if( !recalculate[b] ) {
+            b += 1;
+            continue;
+        }
+        int e = b + 1;
+        while( e < nDays && recalculate[e] )
+            e += 1;
+
+        kvtime::date db = d0, de = d0;
+        kvtime::addDays(db, b);
+        kvtime::addDays(de, e - 1);
+        DBGV(db); DBGV(de);
+        const DBInterface::DailyAggregateList fresh = aggregateDays(TimeRange(dayStart(db), dayEnd(de)), dve);
+        database()->storeDailyAggregates(mParamid, mTypeids, db, de, fresh);
+        updated = true;
+        b = e;
+    }
+
+    if( updated )
+        stored = database()->findDailyAggregates(mParamid, mTypeids, d0, d1);
+    return stored;
+}
+
+// ------------------------------------------------------------------------
+
+StatisticalMean::sdm_t StatisticalMean::findStationDailyMeans(DayMeanExtractor& dve)
+{
+    const kvtime::date date0 = mUT0extended.date(), date1 = UT1.date();
+
+    // complete days are taken from the daily aggregate store, partial
+    // days at the ends of the time range from the data table
+    kvtime::date full0 = date0, full1 = date1;
+    if( mUT0extended != dayStart(date0) )
+        kvtime::addDays(full0, 1);
+    if( UT1 != dayEnd(date1) )
+        kvtime::addDays(full1, -1);
+
+    DBInterface::DailyAggregateList aggregates;
+    if( !mUseDailyAggregates || full0 > full1 ) {
+        aggregates = aggregateDays(TimeRange(mUT0extended, UT1), dve);
+    } else {
+        if( full0 != date0 )
+            aggregates = aggregateDays(TimeRange(mUT0extended, dayEnd(date0)), dve);
+        DBInterface::DailyAggregateList stored = updateStoredAggregates(full0, full1, dve);
+        aggregates.splice(aggregates.end(), stored);
+        if( full1 != date1 ) {
+            DBInterface::DailyAggregateList last = aggregateDays(TimeRange(dayStart(date1), UT1), dve);
+            aggregates.splice(aggregates.end(), last);
+        }
+    }
+
+    // calculate daily mean values TODO skip for RR_x
+    const int day0 = kvtime::julianDay(date0);
+    sdm_t stationDailyMeans;
+    foreach(const DailyAggregate& a, aggregates) {
+        const int obsCount = a.count + a.badCount;
+        if( obsCount == 0 )
+            continue; // only missing or rejected values
+        dve.setDay(a.sum, a.count);
+        if( obsCount>0 && a.badCount/float(obsCount) < mMaxBadRatePerDay && dve.isCompleteDay() ) {
+            const int day = kvtime::julianDay(a.day) - day0;
+            stationDailyMeans[a.instrument].push_back(DayMean(day, dve.value()));
+        } else {
+            info() << "not enough ok data on " << a.day << " for statistical checks on " << a.instrument;
         }
     }
 
@@ -159,37 +286,44 @@ StatisticalMean::sdm_t StatisticalMean::findStationDailyMeans(DayValueExtractorP
 
 // ------------------------------------------------------------------------
 
-StatisticalMean::sd2_t StatisticalMean::findStationMeansPerDay(DayValueExtractorP dve, AccumulatorP accumulator)
+template<class A>
+StatisticalMean::sd2_t<typename A::Value> StatisticalMean::findStationMeansPerDay(DayMeanExtractor& dve, A& accumulator)
 {
     const sdm_t stationDailyMeans = findStationDailyMeans(dve);
 
-    sd2_t stationMeansPerDay;
+    sd2_t<typename A::Value> stationMeansPerDay;
 
     const kvtime::date date0 = mUT0extended.date();
     const int day0 = kvtime::julianDay(date0);
 
+    const int d0 = kvtime::julianDay(UT0.date()) - day0, d1 = kvtime::julianDay(UT1.date()) - day0;
     foreach(const sdm_t::value_type& sd, stationDailyMeans) {
-        accumulator->newStation();
+        accumulator.newStation();
         const dm_t& dml = sd.second;
         dm_t::const_iterator tail = dml.begin(), head = tail;
 
-        const int d0 = kvtime::julianDay(UT0.date()) - day0, d1 = kvtime::julianDay(UT1.date()) - day0;
         int accumulatedDays = 0;
         for(int day=d0; day<=d1; ++day) {
             const int dfront = day - mDays;
-            while( head != dml.end() && (*head)->day() <= day ) {
-                accumulator->push(*head);
+            while( head != dml.end() && head->day <= day ) {
+                accumulator.push(head->mean);
                 accumulatedDays += 1;
                 head++;
             }
-            while( tail != head && (*tail)->day() <= dfront ) {
-                accumulator->pop(*tail);
+            while( tail != head && tail->day <= dfront ) {
+                accumulator.pop(tail->mean);
                 accumulatedDays -= 1;
                 tail++;
             }
-            AccumulatedValueP value = accumulator->value();
-            if( accumulatedDays >= mDaysRequired  && value != 0 ) {
-                stationMeansPerDay[sd.first][day] = value;
+            typename A::Value value;
+            if( accumulator.value(value) && accumulatedDays >= mDaysRequired ) {
+                dm2_t<typename A::Value>& means = stationMeansPerDay[sd.first];
+                if( means.values.empty() ) {
+                    means.values.resize(d1 + 1);
+                    means.valid.resize(d1 + 1, 0);
+                }
+                means.values[day] = value;
+                means.valid[day] = 1;
             } else {
                 kvtime::date d0 = date0, d1 = date0;
                 kvtime::addDays(d0, dfront);
@@ -205,51 +339,83 @@ StatisticalMean::sd2_t StatisticalMean::findStationMeansPerDay(DayValueExtractor
 }
 
 namespace {
-struct same_station : public std::unary_function<bool, StatisticalMean::sd2_t::value_type> {
-    bool operator() (const StatisticalMean::sd2_t::value_type& i) const {
-        return i.first.stationid == stationid;
+template<class StationMeans>
+struct station_less : public std::binary_function<StationMeans, int, bool> {
+    bool operator() (const StationMeans& sm, int stationid) const {
+        return sm.first < stationid;
     }
-    int stationid;
-    same_station(int s) : stationid(s) { }
 };
 }
 
 // ------------------------------------------------------------------------
 
-void StatisticalMean::checkAllMeanValues(CheckerP checker, const sd2_t& stationMeansPerDay)
+template<class C, class V>
+void StatisticalMean::checkAllMeanValues(C& checker, const sd2_t<V>& stationMeansPerDay)
 {
+    typedef std::pair<int, const dm2_t<V>*> StationMeans;
+    typedef std::vector<StationMeans> StationMeansList;
+
     const kvtime::date date0 = mUT0extended.date();
 
-    foreach(const sd2_t::value_type& sd, stationMeansPerDay) {
+    // means of the first instrument of each station, sorted by
+    // stationid as stationMeansPerDay is ordered by station first
+    StationMeansList stationMeans;
+    foreach(const typename sd2_t<V>::value_type& sd, stationMeansPerDay) {
+        if( stationMeans.empty() || stationMeans.back().first != sd.first.stationid )
+            stationMeans.push_back(StationMeans(sd.first.stationid, &sd.second));
+    }
+
+    // neighbors having means, looked up once per center station
+    std::map<int, StationMeansList> neighborMeans;
+
+    foreach(const typename sd2_t<V>::value_type& sd, stationMeansPerDay) {
         const Instrument& center = sd.first;
-        if (!Helpers::isNorwegianStationId(center.stationid))
+        if (isStationSkipped(center.stationid))
             continue;
-        foreach(const dm2_t::value_type& dm, sd.second) {
-            const int day = dm.first;
+        if( shouldStop() ) {
+            stoppedBefore(center.stationid);
+            break;
+        }
+        const StationMeansList* neighbors = 0;
+        const dm2_t<V>& means = sd.second;
+        for(int day = 0; day < (int)means.values.size(); ++day) {
+            if( !means.valid[day] )
+                continue;
 
             kvtime::date date(date0);
             kvtime::addDays(date, day);
             if( date < UT0.date() )
                 continue;
 
-            if( checker->newCenter(center.stationid, Helpers::normalisedDayOfYear(date), dm.second) )
+            if( checker.newCenter(center.stationid, Helpers::normalisedDayOfYear(date), means.values[day]) )
                 continue;
 
-            const std::list<int> neighbors = findNeighbors(center.stationid);
-            foreach(int n, neighbors) {
-                sd2_t::const_iterator itN = std::find_if(stationMeansPerDay.begin(), stationMeansPerDay.end(), same_station(n));
-                if( itN == stationMeansPerDay.end() )
-                    continue;
+            if( !neighbors ) {
+                typename std::map<int, StationMeansList>::iterator itN = neighborMeans.find(center.stationid);
+                if( itN == neighborMeans.end() ) {
+                    StationMeansList& nm = neighborMeans[center.stationid];
+                    const std::list<int> neighborIDs = findNeighbors(center.stationid);
+                    foreach(int n, neighborIDs) {
+                        typename StationMeansList::const_iterator it
+                            = std::lower_bound(stationMeans.begin(), stationMeans.end(), n, station_less<StationMeans>());
+                        if( it != stationMeans.end() && it->first == n )
+                            nm.push_back(*it);
+                    }
+                    neighbors = &nm;
+                } else {
+                    neighbors = &itN->second;
+                }
+            }
 
-                const dm2_t& ndata = itN->second;
-                dm2_t::const_iterator itD = ndata.find(day);
-                if( itD == ndata.end() )
+            foreach(const StationMeans& n, *neighbors) {
+                const dm2_t<V>& ndata = *n.second;
+                if( day >= (int)ndata.values.size() || !ndata.valid[day] )
                     continue;
 
-                if( !checker->checkNeighbor(n, itD->second) )
+                if( !checker.checkNeighbor(n.first, ndata.values[day]) )
                     break;
             }
-            if( !checker->pass() ) {
+            if( !checker.pass() ) {
                 warning() << "statistical test triggered for " << center
                           << " for series ending at " << date;
             }
@@ -259,28 +425,84 @@ void StatisticalMean::checkAllMeanValues(CheckerP checker, const sd2_t& stationM
 
 // ------------------------------------------------------------------------
 
+template<class F>
+void StatisticalMean::runChecks(const F& factory)
+{
+    DayMeanExtractor dayValueExtractor = factory.dayValueExtractor(mParamid);
+    typename F::Accumulator accumulator = factory.accumulator();
+    typename F::Checker checker = factory.checker(this);
+
+    const sd2_t<typename F::Accumulator::Value> stationMeansPerDay = findStationMeansPerDay(dayValueExtractor, accumulator);
+
+    checkAllMeanValues(checker, stationMeansPerDay);
+}
+
+// ------------------------------------------------------------------------
+
 void StatisticalMean::run()
 {
-    std::shared_ptr<Factory> factory;
-    if( mMeanFactory->appliesTo(mParamid) ) {
-        factory = mMeanFactory;
-    } else if( mSumFactory->appliesTo(mParamid) ) {
-        factory = mSumFactory;
-    } else if( mQuartilesFactory->appliesTo(mParamid) ) {
-        factory = mQuartilesFactory;
+    // compared with tbtime, so taken from the database clock
+    mRunStart = database()->currentTime();
+    mReferenceValues.newRun();
+
+    if( MeanFactory::appliesTo(mParamid) ) {
+        runChecks(*mMeanFactory);
+    } else if( SumFactory::appliesTo(mParamid) ) {
+        runChecks(*mSumFactory);
+    } else if( QuartilesFactory::appliesTo(mParamid) ) {
+        runChecks(*mQuartilesFactory);
     } else {
         warning() << "Illegal paramid " << mParamid << " in StatisticalMean::run";
         return;
     }
-    AccumulatorP accumulator = factory->accumulator(mParamid);
-    CheckerP checker = factory->checker(mParamid);
-    DayValueExtractorP dayValueExtractor = factory->dayValueExtractor(mParamid);
+}
+
+// ------------------------------------------------------------------------
 
-    const sd2_t stationMeansPerDay = findStationMeansPerDay(dayValueExtractor, accumulator);
+const ReferenceValues& StatisticalMean::findReferenceValues(const std::string& key)
+{
+    const ReferenceValueCache::Key cacheKey(mParamid, key, mDays, mDaysRequired, missing);
+    if( const ReferenceValues* cached = mReferenceValues.find(cacheKey) )
+        return *cached;
 
-    checkAllMeanValues(checker, stationMeansPerDay);
+    const std::string version = database()->findStatisticalReferenceValuesVersion(mParamid, key);
+    if( const ReferenceValues* valid = mReferenceValues.validate(cacheKey, version) )
+        return *valid;
 
-    mReferenceKeys.clear();
+    ReferenceValues rv(database()->findStatisticalReferenceValues(mParamid, key, missing));
+
+    // for TA(211), calculate mean value of the last mDays days here;
+    // for quartiles and PR, nothing like this needs to be done
+    if( mParamid == 211 && key == "ref_value" ) {
+        const int DAYS = ReferenceValues::DAYS;
+        std::vector<float> rvpd(DAYS);
+        AccumulatorMeanOrSum acc(true, mDays, mDaysRequired);
+        for(int s=0; s<rv.size(); ++s) {
+            float* rvpd_mean = rv.values(s);
+            std::copy(rvpd_mean, rvpd_mean + DAYS, rvpd.begin());
+            std::fill(rvpd_mean, rvpd_mean + DAYS, missing);
+
+            acc.newStation();
+            for(int i=DAYS-mDays+1; i<DAYS; ++i) {
+                const float vPush = rvpd[i-1];
+                if( vPush != missing )
+                    acc.push(vPush);
+            }
+            for(int i=1; i<=DAYS; ++i) {
+                const float vPush = rvpd[i-1];
+                if( vPush != missing )
+                    acc.push(vPush);
+                AccumulatedFloat v;
+                if( acc.value(v) )
+                    rvpd_mean[i-1] = v.value;
+                const int iPop = (DAYS+i-mDays-1) % DAYS;
+                const float vPop = rvpd[iPop];
+                if( vPop != missing )
+                    acc.pop(vPop);
+            }
+        }
+    }
+    return mReferenceValues.store(cacheKey, version, rv);
 }
 
 // ------------------------------------------------------------------------
@@ -297,52 +519,12 @@ float StatisticalMean::getReferenceValue(int station, int dayOfYear, const std::
     if( mParamid == 178 ) // PR
         return 1014;
 
-    // for TA(211), calculate mean value of the last mDays days here;
-    // for quartiles and PR, nothing like this needs to be done
-
-    if( mReferenceKeys.find(key) == mReferenceKeys.end() ) {
-        DBInterface::reference_value_map_t rvps = database()->findStatisticalReferenceValues(mParamid, key, missing);
-        if( mParamid == 211 && key == "ref_value" ) {
-            DBInterface::reference_value_map_t rvps_mean;
-            AccumulatorMeanOrSum acc(true, mDays, mDaysRequired);
-            foreach(DBInterface::reference_value_map_t::value_type s_rv, rvps) {
-                const int station = s_rv.first;
-                const DBInterface::reference_values_t& rvpd = s_rv.second;
-                DBInterface::reference_values_t rvpd_mean(365, missing);
-
-                acc.newStation();
-                for(int i=365-mDays+1; i<365; ++i) {
-                    const float vPush = rvpd[i-1];
-                    if( vPush != missing )
-                        acc.push(std::make_shared<DayMean>(vPush));
-                }
-                for(int i=1; i<=365; ++i) {
-                    const float vPush = rvpd[i-1];
-                    if( vPush != missing )
-                        acc.push(std::make_shared<DayMean>(vPush));
-                    AccumulatedValueP v = acc.value();
-                    if( v ) {
-                        float mean = std::static_pointer_cast<AccumulatedFloat>(v)->value;
-                        rvpd_mean[i-1] = mean;
-                    }
-                    const int iPop = (365+i-mDays-1) % 365;
-                    const float vPop = rvpd[iPop];
-                    if( vPop != missing )
-                        acc.pop(std::make_shared<DayMean>(vPop));
-                }
-                rvps_mean[station] = rvpd_mean;
-            }
-            rvps = rvps_mean;
-        }
-        mReferenceKeys[key] = rvps;
-    }
-    DBInterface::reference_value_map_t& sr = mReferenceKeys[key];
-    DBInterface::reference_value_map_t::const_iterator it = sr.find(station);
-    if( it == sr.end() ) {
+    const float* values = findReferenceValues(key).find(station);
+    if( !values ) {
         valid = false;
         return missing;
     }
-    const float value = it->second[dayOfYear-1];
+    const float value = values[dayOfYear-1];
     valid = value != missing;
     return value;
 }
@@ -33,11 +33,11 @@
 #include <boost/version.hpp>
 #if BOOST_VERSION >= 104000
 
-#include "Accumulator.h"
-#include "Checker.h"
-#include "DayValueExtractor.h"
+#include "DayMean.h"
+#include "DayMeanExtractor.h"
 #include "Instrument.h"
 #include "Qc2Algorithm.h"
+#include "ReferenceValueCache.h"
 #include <list>
 #include <map>
 #include <vector>
@@ -59,21 +59,40 @@ public:
 public:
     typedef std::vector<kvalobs::kvData> dlist_t;
     typedef std::map<Instrument, dlist_t, lt_Instrument> smap_t;
-    typedef std::vector<DayValueP> dm_t;
+    typedef std::vector<DayMean> dm_t;
     typedef std::map<Instrument, dm_t, lt_Instrument> sdm_t;
-    typedef std::map<int, AccumulatedValueP> dm2_t;
-    typedef std::map<Instrument, dm2_t, lt_Instrument> sd2_t;
+
+    /** Accumulated values indexed by day; valid[day] is 0 for days without a value. */
+    template<class V>
+    struct dm2_t {
+        std::vector<V> values;
+        std::vector<char> valid;
+    };
+
+    template<class V>
+    using sd2_t = std::map<Instrument, dm2_t<V>, lt_Instrument>;
 
 private:
     std::list<int> findNeighbors(int stationID);
 
-    smap_t fetchData();
+    template<class F>
+    void runChecks(const F& factory);
+
+    const ReferenceValues& findReferenceValues(const std::string& key);
+
+    smap_t fetchData(const TimeRange& time);
+
+    DBInterface::DailyAggregateList aggregateDays(const TimeRange& time, DayMeanExtractor& dve);
+
+    DBInterface::DailyAggregateList updateStoredAggregates(const kvtime::date& d0, const kvtime::date& d1, DayMeanExtractor& dve);
 
-    sdm_t findStationDailyMeans(DayValueExtractorP dve);
+    sdm_t findStationDailyMeans(DayMeanExtractor& dve);
 
-    sd2_t findStationMeansPerDay(DayValueExtractorP dve, AccumulatorP accumulator);
+    template<class A>
+    sd2_t<typename A::Value> findStationMeansPerDay(DayMeanExtractor& dve, A& accumulator);
 
-    void checkAllMeanValues(CheckerP checker, const sd2_t& smpd);
+    template<class C, class V>
+    void checkAllMeanValues(C& checker, const sd2_t<V>& smpd);
 
 private:
     std::shared_ptr<RedistributionNeighbors> mNeighbors;
@@ -86,13 +105,14 @@ private:
     int mDaysRequired;
     int mParamid;
     float mMaxBadRatePerDay;
+    bool mUseDailyAggregates;
     std::vector<int> mTypeids;
     kvtime::time mUT0extended;
+    kvtime::time mRunStart;
 
     FlagSetCU ok_flags;
 
-    typedef std::map<std::string, DBInterface::reference_value_map_t> referenceKeys_t;
-    referenceKeys_t mReferenceKeys;
+    ReferenceValueCache mReferenceValues;
 };
 
 #endif /* BOOST_VERSION >= 104000 */
@@ -29,36 +29,23 @@
 
 #include "SumFactory.h"
 
-#include "AlgorithmConfig.h"
-#include "DayMeanExtractor.h"
-
-void SumFactory::configure(StatisticalMean* stm, const AlgorithmConfig& params)
-{
-    const float tolerance = params.getParameter<float>("tolerance", 10.0f);
-    const int days = params.getParameter<int>("days", 30);
-    const int daysRequired = params.getParameter<int>("days_required", int(0.9*days + 0.5));
-
-    mAccumulator = std::make_shared<AccumulatorMeanOrSum>(false, days, daysRequired);
-    mChecker = std::make_shared<CheckerMeanOrSum>(stm, tolerance);
-}
-
 bool SumFactory::appliesTo(int paramid)
 {
     return ( paramid == 106 /* RR_1 */ || paramid == 108 /* RR_6 */
             || paramid == 109 /* RR_12 */ || paramid == 110 /* RR_24 */ );
 }
 
-CheckerP SumFactory::checker(int /*paramid*/)
+SumFactory::Checker SumFactory::checker(StatisticalMean* stm) const
 {
-    return mChecker;
+    return CheckerMeanOrSum(stm, mTolerance);
 }
 
-AccumulatorP SumFactory::accumulator(int /*paramid*/)
+SumFactory::Accumulator SumFactory::accumulator() const
 {
-    return mAccumulator;
+    return AccumulatorMeanOrSum(false, mDays, mDaysRequired);
 }
 
-DayValueExtractorP SumFactory::dayValueExtractor(int paramid)
+DayMeanExtractor SumFactory::dayValueExtractor(int paramid) const
 {
-    return std::make_shared<DayMeanExtractor>(false, paramid);
+    return DayMeanExtractor(false, paramid);
 }
@@ -36,14 +36,13 @@
 
 class SumFactory : public Factory {
 public:
-    virtual void configure(StatisticalMean* stm, const AlgorithmConfig& config);
-    virtual bool appliesTo(int paramid);
-    virtual CheckerP checker(int paramid);
-    virtual AccumulatorP accumulator(int paramid);
-    virtual DayValueExtractorP dayValueExtractor(int paramid);
-private:
-    std::shared_ptr<AccumulatorMeanOrSum> mAccumulator;
-    std::shared_ptr<CheckerMeanOrSum> mChecker;
+    typedef AccumulatorMeanOrSum Accumulator;
+    typedef CheckerMeanOrSum Checker;
+
+    static bool appliesTo(int paramid);
+    Checker checker(StatisticalMean* stm) const;
+    Accumulator accumulator() const;
+    DayMeanExtractor dayValueExtractor(int paramid) const;
 };
 
 #endif /* SUMFACTORY_H_ */
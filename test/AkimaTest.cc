@@ -82,3 +82,58 @@ TEST(AkimaTest, Distance)
     ASSERT_NEAR(0.5, akima.distance(2.5), 0.0001);
     ASSERT_NEAR(0.2, akima.distance(3.8), 0.0001);
 }
+
+TEST(AkimaTest, Evaluate)
+{
+    const double xp[6] = { 0, 1, 2, 4, 5, 6 };
+    const double yp[6] = { -10.9, -10.4, -7.8, /* -8.75734, */ -8.0, -7.0, -7.5 };
+    Akima akima;
+    for(int i=0; i<6; ++i)
+        akima.add(xp[i], yp[i]);
+
+    std::vector<double> x, y;
+    for(double xx = -1; xx <= 7; xx += 0.125)
+        x.push_back(xx);
+    akima.evaluate(x, y);
+
+    ASSERT_EQ(x.size(), y.size());
+    for(std::size_t i=0; i<x.size(); ++i)
+        ASSERT_EQ(akima.interpolate(x[i]), y[i]) << "x=" << x[i];
+    ASSERT_EQ(Akima::INVALID, y.front());
+    ASSERT_EQ(Akima::INVALID, y.back());
+
+    // positions not sorted
+    x.clear();
+    x.push_back(3);
+    x.push_back(0.5);
+    akima.evaluate(x, y);
+    ASSERT_NEAR(-7.84475, y[0], 0.0001);
+    ASSERT_EQ(akima.interpolate(0.5), y[1]);
+
+    // adding a point recalculates the coefficients
+    akima.add(7, -8);
+    ASSERT_NEAR(-8.0, akima.interpolate(7), 0.0001);
+}
+
+TEST(AkimaTest, EvaluateWindows)
+{
+    const double xp[6] = { 0, 1, 2, 4, 5, 6 };
+    const double yp[6] = { -10.9, -10.4, -7.8, /* -8.75734, */ -8.0, -7.0, -7.5 };
+    Akima akima, reference;
+    for(int i=0; i<6; ++i) {
+        akima.add(xp[i], yp[i]);
+        reference.add(xp[i], yp[i]);
+    }
+
+    // consecutive windows, as in MinMaxReconstruction, and a jump back
+    const int starts[8] = { 0, 1, 2, 3, 4, 5, 1, 4 };
+    std::vector<double> x(3), y;
+    for(int w=0; w<8; ++w) {
+        for(int j=0; j<3; ++j)
+            x[j] = starts[w] + (j+1)/4.0;
+        akima.evaluate(x, y);
+        for(int j=0; j<3; ++j)
+            ASSERT_EQ(reference.interpolate(x[j]), y[j]) << "x=" << x[j];
+        ASSERT_NEAR(reference.distance(x[1]), akima.distance(x[1]), 1e-12) << "x=" << x[1];
+    }
+}
@@ -0,0 +1,96 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <gtest/gtest.h>
+#include "Backfill.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <cstdio>
+
+namespace {
+
+// a file name in the temporary directory that is not used by other tests
+std::string tempFileName()
+{
+    namespace fs = boost::filesystem;
+    return (fs::temp_directory_path() / fs::unique_path("kvqc2d_BackfillTest_%%%%-%%%%-%%%%")).string();
+}
+
+} // anonymous namespace
+
+TEST(BackfillTest, Chunks)
+{
+    const kvtime::time t0 = kvtime::maketime(2012, 1, 1, 6, 0, 0), t1 = kvtime::maketime(2012, 1, 16, 6, 0, 0);
+    const BackfillChunks chunks = makeBackfillChunks(t0, t1, 7);
+    ASSERT_EQ(3u, chunks.size());
+    EXPECT_EQ(t0, chunks[0].UT0);
+    EXPECT_EQ(kvtime::maketime(2012, 1, 8, 5, 59, 0), chunks[0].UT1);
+    EXPECT_EQ(kvtime::maketime(2012, 1, 8, 6, 0, 0), chunks[1].UT0);
+    EXPECT_EQ(kvtime::maketime(2012, 1, 15, 5, 59, 0), chunks[1].UT1);
+    EXPECT_EQ(kvtime::maketime(2012, 1, 15, 6, 0, 0), chunks[2].UT0);
+    EXPECT_EQ(t1, chunks[2].UT1);
+
+    EXPECT_TRUE(makeBackfillChunks(t1, t0, 7).empty());
+
+    const BackfillChunks single = makeBackfillChunks(t0, t0, 7);
+    ASSERT_EQ(1u, single.size());
+    EXPECT_EQ(t0, single[0].UT0);
+    EXPECT_EQ(t0, single[0].UT1);
+}
+
+TEST(BackfillTest, Checkpoint)
+{
+    const std::string stateFile = tempFileName();
+
+    const kvtime::time t0 = kvtime::maketime(2012, 1, 1, 0, 0, 0), t1 = kvtime::maketime(2012, 1, 4, 0, 0, 0);
+    const BackfillChunks chunks = makeBackfillChunks(t0, t1, 1);
+    ASSERT_EQ(3u, chunks.size());
+    {
+        BackfillCheckpoint cp(stateFile, "plu.cfg2", t0, t1, 1);
+        EXPECT_FALSE(cp.isDone(chunks[0]));
+        cp.markDone(chunks[0]);
+        cp.markDone(chunks[2]);
+    }
+    {
+        BackfillCheckpoint cp(stateFile, "plu.cfg2", t0, t1, 1);
+        EXPECT_TRUE(cp.isDone(chunks[0]));
+        EXPECT_FALSE(cp.isDone(chunks[1]));
+        EXPECT_TRUE(cp.isDone(chunks[2]));
+    }
+    {
+        // a different backfill starts again
+        BackfillCheckpoint cp(stateFile, "plu.cfg2", t0, t1, 2);
+        EXPECT_FALSE(cp.isDone(chunks[0]));
+    }
+    {
+        BackfillCheckpoint cp(stateFile, "plu.cfg2", t0, t1, 1);
+        EXPECT_FALSE(cp.isDone(chunks[0]));
+    }
+    std::remove(stateFile.c_str());
+}
@@ -0,0 +1,147 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <gtest/gtest.h>
+#include "helpers/ConnectionPool.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread.hpp>
+
+namespace {
+
+struct FakeConnection {
+    FakeConnection(int i)
+        : id(i), connected(true) { }
+    int id;
+    bool connected;
+};
+
+class FakePool : public Helpers::ConnectionPool<FakeConnection> {
+public:
+    FakePool()
+        : connects(0), releases(0), blockConnect(false), connecting(false) { }
+
+    ~FakePool()
+        { releaseIdle(); }
+
+    /** Let a blocked connect() return. */
+    void unblock()
+        { boost::mutex::scoped_lock lock(mutex); blockConnect = false; cond.notify_all(); }
+
+    /** Wait until connect() is blocked. */
+    void waitConnecting()
+        { boost::mutex::scoped_lock lock(mutex); while( !connecting ) cond.wait(lock); }
+
+    int connects, releases;
+    bool blockConnect, connecting;
+
+protected:
+    FakeConnection* connect()
+        {
+            boost::mutex::scoped_lock lock(mutex);
+            connecting = true;
+            cond.notify_all();
+            while( blockConnect )
+                cond.wait(lock);
+            connecting = false;
+            return new FakeConnection(++connects);
+        }
+
+    bool isConnected(FakeConnection* c)
+        { return c->connected; }
+
+    void release(FakeConnection* c)
+        { releases += 1; delete c; }
+
+private:
+    boost::mutex mutex;
+    boost::condition_variable cond;
+};
+
+void checkoutAndKeep(FakePool* pool, FakeConnection** c)
+{
+    *c = pool->checkout();
+}
+
+} // anonymous namespace
+
+TEST(ConnectionPoolTest, Reuse)
+{
+    FakePool pool;
+    pool.warmUp(2);
+    EXPECT_EQ(2, pool.connects);
+
+    FakeConnection* c1 = pool.checkout();
+    FakeConnection* c2 = pool.checkout();
+    FakeConnection* c3 = pool.checkout();
+    EXPECT_EQ(1, c1->id);
+    EXPECT_EQ(2, c2->id);
+    EXPECT_EQ(3, c3->id);
+
+    pool.checkin(c1);
+    pool.checkin(c2, false);
+    EXPECT_EQ(1, pool.releases);
+    EXPECT_EQ(c1, pool.checkout());
+
+    // broken connections are replaced
+    c1->connected = false;
+    pool.checkin(c1);
+    pool.checkin(c3);
+    FakeConnection* c = pool.checkout();
+    EXPECT_EQ(c3, c);
+    EXPECT_EQ(2, pool.releases);
+    pool.checkin(c);
+    EXPECT_EQ(3, pool.connects);
+}
+
+TEST(ConnectionPoolTest, ConnectDoesNotBlock)
+{
+    FakePool pool;
+    pool.warmUp(1);
+    FakeConnection* c1 = pool.checkout();
+
+    // another thread waits for a new connection
+    pool.blockConnect = true;
+    FakeConnection* c2 = 0;
+    boost::thread t(boost::bind(checkoutAndKeep, &pool, &c2));
+    pool.waitConnecting();
+
+    // meanwhile, connections are returned and handed out again
+    pool.checkin(c1);
+    EXPECT_EQ(c1, pool.checkout());
+    EXPECT_EQ(0, c2);
+
+    pool.unblock();
+    t.join();
+    ASSERT_TRUE(c2 != 0);
+    EXPECT_EQ(2, c2->id);
+    pool.checkin(c1);
+    pool.checkin(c2);
+}
@@ -0,0 +1,59 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <gtest/gtest.h>
+#include "Findings.h"
+
+#include <cmath>
+
+TEST(FindingsTest, Format)
+{
+    const kvtime::time t0 = kvtime::maketime(2012, 5, 1, 6, 0, 0), t1 = kvtime::maketime(2012, 5, 2, 6, 0, 0);
+    Finding f("QC2-redist-hqc-errors", 180, 110, 302, t1);
+    f.from(t0).value("original", 12.5f).text("accumulation with \"errors\"");
+
+    EXPECT_EQ("{\"schema\":1,\"algorithm\":\"Redistribution\",\"check\":\"QC2-redist-hqc-errors\","
+              "\"station\":180,\"param\":110,\"type\":302,"
+              "\"from\":\"2012-05-01 06:00:00\",\"to\":\"2012-05-02 06:00:00\","
+              "\"values\":{\"original\":12.5},\"message\":\"accumulation with \\\"errors\\\"\"}",
+              JsonLinesFindingsWriter::format("Redistribution", f));
+}
+
+TEST(FindingsTest, FormatNonFinite)
+{
+    const kvtime::time t = kvtime::maketime(2012, 5, 1, 6, 0, 0);
+    Finding f("QC2h-1-highsingle", 180, 105, 4, t);
+    f.value("sum", NAN).value("fw", 3);
+
+    EXPECT_EQ("{\"schema\":1,\"algorithm\":\"Plumatic\",\"check\":\"QC2h-1-highsingle\","
+              "\"station\":180,\"param\":105,\"type\":4,"
+              "\"from\":\"2012-05-01 06:00:00\",\"to\":\"2012-05-01 06:00:00\","
+              "\"values\":{\"sum\":null,\"fw\":3},\"message\":\"\"}",
+              JsonLinesFindingsWriter::format("Plumatic", f));
+}
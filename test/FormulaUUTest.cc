@@ -57,3 +57,25 @@ TEST(FormulaUUTest, TestTD)
     EXPECT_TD(10, 8);
     EXPECT_TD(10, 9);
 }
+
+TEST(FormulaUUTest, TestArrays)
+{
+    const int N = 9;
+    const float TA[N] = { 20,  20,   10, -5.5, -12,  -32767, 3,    4,  0 };
+    const float UU[N] = { 90, 100, 80.5,   70, -32767, 80, 0, 99.9, 50 };
+    float TD[N], UU2[N];
+
+    Helpers::formulaTD(TA, UU, TD, N);
+    for(int i=0; i<N; ++i)
+        EXPECT_EQ(Helpers::formulaTD(TA[i], UU[i]), TD[i]) << "i=" << i;
+
+    Helpers::formulaUU(TA, TD, UU2, N);
+    for(int i=0; i<N; ++i)
+        EXPECT_EQ(Helpers::formulaUU(TA[i], TD[i]), UU2[i]) << "i=" << i;
+
+    EXPECT_EQ(Helpers::UU_INVALID, TD[1]);
+    EXPECT_EQ(Helpers::UU_INVALID, TD[5]);
+    EXPECT_EQ(Helpers::UU_INVALID, UU2[1]);
+    EXPECT_EQ(Helpers::UU_INVALID, UU2[5]);
+    EXPECT_FLOAT_EQ(90, UU2[0]);
+}
@@ -30,9 +30,13 @@
 #include <gtest/gtest.h>
 #include "helpers/Helpers.h"
 #include "helpers/mathutil.h"
+#include "helpers/OrderStatistics.h"
 #include "helpers/stringutil.h"
 #include "helpers/timeutil.h"
 
+#include <deque>
+#include <vector>
+
 TEST(HelpersTest, testMapFromList)
 {
     std::map<int, float> map;
@@ -158,6 +162,34 @@ TEST(HelpersTest, Quartiles)
     EXPECT_DOUBLE_EQ(27, q3);
 }
 
+TEST(HelpersTest, OrderStatisticsQuartiles)
+{
+    // sliding window with many equal values, compared to Helpers::quartiles
+    std::deque<float> window;
+    Helpers::OrderStatistics os;
+    unsigned int seed = 4711;
+    for(int i=0; i<400; ++i) {
+        seed = seed*1103515245 + 12345;
+        const float v = ((seed >> 16) % 50) / 4.0f - 3;
+        window.push_back(v);
+        os.insert(v);
+        if( window.size() > 31 - (i % 3) ) {
+            ASSERT_TRUE(os.erase(window.front()));
+            window.pop_front();
+        }
+        ASSERT_EQ(window.size(), os.size());
+
+        std::vector<float> values(window.begin(), window.end());
+        double q1, q2, q3, e1, e2, e3;
+        Helpers::quartiles(values.begin(), values.end(), e1, e2, e3);
+        os.quartiles(q1, q2, q3);
+        ASSERT_EQ(e1, q1) << "i=" << i;
+        ASSERT_EQ(e2, q2) << "i=" << i;
+        ASSERT_EQ(e3, q3) << "i=" << i;
+    }
+    EXPECT_FALSE(os.erase(1000));
+}
+
 TEST(HelpersTest, DataText)
 {
     const kvalobs::kvData d(18700, kvtime::maketime("2012-03-01 06:00:00"), 12.0, 211, kvtime::maketime("2012-03-01 07:00:00"), 302, 0, 0, 12.0,
@@ -0,0 +1,285 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <gtest/gtest.h>
+#include "AggregatingNotifier.h"
+#include "AsyncNotifier.h"
+#include "Notifier.h"
+#include "Notifier.icc"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/thread/thread.hpp>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+// a file name in the temporary directory that is not used by other tests
+std::string tempFileName()
+{
+    namespace fs = boost::filesystem;
+    return (fs::temp_directory_path() / fs::unique_path("kvqc2d_NotifierTest_%%%%-%%%%-%%%%")).string();
+}
+
+class RecordingNotifier : public Notifier {
+public:
+    std::vector<Message::Level> levels;
+    std::vector<std::string> texts;
+    void sendText(Message::Level level, const std::string& message)
+        { levels.push_back(level); texts.push_back(message); }
+};
+
+// blocks in sendText until opened, to fill the queue of an AsyncNotifier
+class GatedNotifier : public RecordingNotifier {
+public:
+    std::atomic<bool> entered, open;
+    GatedNotifier() : entered(false), open(false) { }
+    void sendText(Message::Level level, const std::string& message) {
+        entered.store(true);
+        while( !open.load() )
+            boost::this_thread::yield();
+        RecordingNotifier::sendText(level, message);
+    }
+};
+
+// copies what it recorded when deleted by its owner
+class KeepingNotifier : public GatedNotifier {
+public:
+    KeepingNotifier(RecordingNotifier& keep) : mKeep(keep) { }
+    ~KeepingNotifier()
+        { mKeep.levels = levels; mKeep.texts = texts; }
+private:
+    RecordingNotifier& mKeep;
+};
+
+} // anonymous namespace
+
+TEST(NotifierTest, LongMessage)
+{
+    RecordingNotifier n;
+    const std::string word = "0123456789";
+    {
+        Message m(Message::INFO, &n, "test");
+        for(int i=0; i<100; ++i)
+            m << word;
+        m << 42;
+    }
+    std::string expected = "test: ";
+    for(int i=0; i<100; ++i)
+        expected += word;
+    expected += "42";
+    ASSERT_EQ(1u, n.texts.size());
+    EXPECT_EQ(expected, n.texts[0]);
+}
+
+TEST(NotifierTest, LevelGate)
+{
+    RecordingNotifier n;
+    n.setLevel(Message::WARNING);
+    EXPECT_FALSE(n.isEnabled(Message::INFO));
+    EXPECT_TRUE(n.isEnabled(Message::ERROR));
+    {
+        Message m(Message::INFO, &n, "test");
+        EXPECT_FALSE(m.enabled());
+        m << "dropped";
+    }
+    Message(Message::WARNING, &n, "test") << "kept";
+    ASSERT_EQ(1u, n.texts.size());
+    EXPECT_EQ("test: kept", n.texts[0]);
+}
+
+TEST(NotifierTest, MoveAndReset)
+{
+    RecordingNotifier n;
+    {
+        Message m(Message::INFO, &n, "test");
+        m << "moved";
+        Message moved(std::move(m));
+        moved << " text";
+        Message empty(Message::INFO, &n, "test");
+        empty << "reset";
+        empty.reset();
+    }
+    ASSERT_EQ(1u, n.texts.size());
+    EXPECT_EQ("test: moved text", n.texts[0]);
+}
+
+TEST(NotifierTest, AsyncFlush)
+{
+    RecordingNotifier* n = new RecordingNotifier;
+    n->setLevel(Message::INFO);
+    AsyncNotifier a(n);
+    EXPECT_FALSE(a.isEnabled(Message::DEBUG));
+
+    for(int i=0; i<100; ++i)
+        Message(Message::INFO, &a, "test") << i;
+    a.flush();
+    ASSERT_EQ(100u, n->texts.size());
+    EXPECT_EQ("test: 0", n->texts[0]);
+    EXPECT_EQ("test: 99", n->texts[99]);
+    EXPECT_EQ(0u, a.dropped());
+}
+
+TEST(NotifierTest, AsyncDropped)
+{
+    GatedNotifier* n = new GatedNotifier;
+    AsyncNotifier a(n, 4);
+
+    Message(Message::INFO, &a, "test") << "first";
+    while( !n->entered.load() )
+        boost::this_thread::yield();
+    for(int i=0; i<10; ++i)
+        Message(Message::INFO, &a, "test") << i;
+    EXPECT_EQ(6u, a.dropped());
+
+    n->open.store(true);
+    a.flush();
+    ASSERT_EQ(6u, n->texts.size());
+    EXPECT_EQ("test: first", n->texts[0]);
+    EXPECT_EQ("test: 3", n->texts[4]);
+    EXPECT_EQ("message queue full, dropped 6 messages: 6 INFO", n->texts[5]);
+    EXPECT_EQ(Message::WARNING, n->levels[5]);
+}
+
+TEST(NotifierTest, AsyncDroppedAtShutdown)
+{
+    RecordingNotifier kept;
+    {
+        KeepingNotifier* n = new KeepingNotifier(kept);
+        AsyncNotifier a(n, 2);
+        Message(Message::INFO, &a, "test") << "first";
+        while( !n->entered.load() )
+            boost::this_thread::yield();
+        for(int i=0; i<3; ++i)
+            Message(Message::WARNING, &a, "test") << i;
+        Message(Message::INFO, &a, "test") << "last";
+        EXPECT_EQ(2u, a.dropped());
+        n->open.store(true);
+    }
+    ASSERT_EQ(4u, kept.texts.size());
+    EXPECT_EQ("message queue full, dropped 2 messages: 1 WARNING 1 INFO", kept.texts[3]);
+    EXPECT_EQ(Message::ERROR, kept.levels[3]);
+}
+
+TEST(NotifierTest, AggregateFingerprint)
+{
+    const std::string a = AggregatingNotifier::fingerprint(Message::WARNING,
+            "Plumatic: QC2h-1-aggregation-3 triggered for [stationid=180 AND obstime='2012-05-01 06:00:00']");
+    const std::string b = AggregatingNotifier::fingerprint(Message::WARNING,
+            "Plumatic: QC2h-1-aggregation-7 triggered for [stationid=180 AND obstime='2012-05-03 17:00:00']");
+    const std::string c = AggregatingNotifier::fingerprint(Message::WARNING,
+            "Plumatic: QC2h-1-aggregation-3 triggered for [stationid=18700 AND obstime='2012-05-01 06:00:00']");
+    const std::string d = AggregatingNotifier::fingerprint(Message::INFO,
+            "Plumatic: QC2h-1-aggregation-3 triggered for [stationid=180 AND obstime='2012-05-01 06:00:00']");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_NE(a, d);
+}
+
+TEST(NotifierTest, AggregateFingerprintHQC)
+{
+    // Redistribution's HQC messages have "station=" and no '['
+    const std::string a = AggregatingNotifier::fingerprint(Message::WARNING,
+            "Redistribution: HQC: station=180 date_to=2012-05-01 06:00:00 message: accumulation without missing rows");
+    const std::string b = AggregatingNotifier::fingerprint(Message::WARNING,
+            "Redistribution: HQC: station=180 date_to=2012-05-03 06:00:00 message: accumulation without missing rows");
+    const std::string c = AggregatingNotifier::fingerprint(Message::WARNING,
+            "Redistribution: HQC: station=18700 date_to=2012-05-01 06:00:00 message: accumulation without missing rows");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+
+    RecordingNotifier* n = new RecordingNotifier;
+    AggregatingNotifier agg(n, 1);
+    agg.beginRun("test");
+    const int stations[] = { 180, 4200, 18700, 99910, -1 };
+    for(int s=0; stations[s]>0; ++s) {
+        Message(Message::WARNING, &agg, "Redistribution") << "HQC: station=" << stations[s]
+            << " date_to=2012-05-01 06:00:00 message: accumulation without missing rows";
+    }
+    EXPECT_EQ(4u, n->texts.size());
+    agg.endRun();
+}
+
+TEST(NotifierTest, AggregateRepeats)
+{
+    RecordingNotifier* n = new RecordingNotifier;
+    AggregatingNotifier a(n, 2);
+
+    a.beginRun("test");
+    for(int i=0; i<5; ++i)
+        Message(Message::WARNING, &a, "test") << "found only " << i << " neighbors for [stationid=180]";
+    Message(Message::WARNING, &a, "test") << "found only 1 neighbors for [stationid=18700]";
+    for(int i=0; i<3; ++i)
+        Message(Message::ERROR, &a, "test") << "error " << i;
+    ASSERT_EQ(6u, n->texts.size());
+
+    a.endRun();
+    ASSERT_EQ(7u, n->texts.size());
+    EXPECT_EQ("3 more messages like 'test: found only 0 neighbors for [stationid=180]' suppressed", n->texts[6]);
+
+    // counts start again in the next run
+    a.beginRun("test");
+    Message(Message::WARNING, &a, "test") << "found only 9 neighbors for [stationid=180]";
+    a.endRun();
+    ASSERT_EQ(8u, n->texts.size());
+}
+
+TEST(NotifierTest, AggregateUnchanged)
+{
+    const std::string stateFile = tempFileName();
+
+    RecordingNotifier* n = new RecordingNotifier;
+    {
+        AggregatingNotifier a(n, 0, stateFile);
+        a.beginRun("one.cfg");
+        Message(Message::WARNING, &a, "test") << "same";
+        Message(Message::WARNING, &a, "test") << "changed 1";
+        a.endRun();
+        ASSERT_EQ(2u, n->texts.size());
+    }
+
+    n = new RecordingNotifier;
+    AggregatingNotifier a(n, 0, stateFile);
+    a.beginRun("other.cfg");
+    Message(Message::WARNING, &a, "test") << "same";
+    a.endRun();
+    ASSERT_EQ(1u, n->texts.size());
+
+    a.beginRun("one.cfg");
+    Message(Message::WARNING, &a, "test") << "same";
+    Message(Message::WARNING, &a, "test") << "changed 2";
+    a.endRun();
+    ASSERT_EQ(3u, n->texts.size());
+    EXPECT_EQ("test: changed 2", n->texts[1]);
+    EXPECT_EQ("1 messages unchanged since the previous run of 'one.cfg' not repeated", n->texts[2]);
+
+    std::remove(stateFile.c_str());
+}
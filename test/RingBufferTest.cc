@@ -0,0 +1,94 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <gtest/gtest.h>
+#include "helpers/RingBuffer.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <vector>
+
+TEST(RingBufferTest, SingleThread)
+{
+    Helpers::RingBuffer<int> rb(3);
+    ASSERT_EQ(4u, rb.capacity());
+
+    int v;
+    EXPECT_FALSE(rb.pop(v));
+    for(int i=0; i<4; ++i) {
+        v = i;
+        EXPECT_TRUE(rb.push(v));
+    }
+    v = 4;
+    EXPECT_FALSE(rb.push(v));
+
+    for(int round=0; round<10; ++round) {
+        ASSERT_TRUE(rb.pop(v));
+        EXPECT_EQ(round, v);
+        v = round + 4;
+        EXPECT_TRUE(rb.push(v));
+    }
+}
+
+namespace {
+void produce(Helpers::RingBuffer<int>* rb, int producer, int count)
+{
+    for(int i=0; i<count; ++i) {
+        int v = producer*count + i;
+        while( !rb->push(v) )
+            boost::this_thread::yield();
+    }
+}
+} // anonymous namespace
+
+TEST(RingBufferTest, ManyProducers)
+{
+    const int N_PRODUCERS = 4, COUNT = 10000;
+    Helpers::RingBuffer<int> rb(64);
+
+    boost::thread_group producers;
+    for(int p=0; p<N_PRODUCERS; ++p)
+        producers.create_thread(boost::bind(produce, &rb, p, COUNT));
+
+    // values from each producer must arrive complete and in order
+    std::vector<int> next(N_PRODUCERS, 0);
+    int received = 0, v;
+    while( received < N_PRODUCERS*COUNT ) {
+        if( !rb.pop(v) ) {
+            boost::this_thread::yield();
+            continue;
+        }
+        const int p = v / COUNT;
+        ASSERT_EQ(next[p], v % COUNT);
+        next[p] += 1;
+        received += 1;
+    }
+    producers.join_all();
+    EXPECT_FALSE(rb.pop(v));
+}
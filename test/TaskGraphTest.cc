@@ -0,0 +1,117 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include <gtest/gtest.h>
+#include "helpers/TaskGraph.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct Recorder {
+    boost::mutex mutex;
+    std::vector<int> order;
+
+    void record(int task, int /*worker*/)
+        { boost::mutex::scoped_lock lock(mutex); order.push_back(task); }
+
+    void fail(int, int)
+        { throw std::runtime_error("task failed"); }
+
+    int position(int task) const
+        { return std::find(order.begin(), order.end(), task) - order.begin(); }
+};
+
+} // anonymous namespace
+
+TEST(TaskGraphTest, Sequential)
+{
+    Recorder r;
+    Helpers::TaskGraph tasks;
+    for(int i=0; i<4; ++i)
+        tasks.add(boost::bind(&Recorder::record, &r, i, _1));
+    tasks.addDependency(0, 3);
+
+    tasks.run(1);
+    ASSERT_EQ(4u, r.order.size());
+    EXPECT_EQ(1, r.order[0]);
+    EXPECT_EQ(2, r.order[1]);
+    EXPECT_EQ(3, r.order[2]);
+    EXPECT_EQ(0, r.order[3]);
+}
+
+TEST(TaskGraphTest, Dependencies)
+{
+    Recorder r;
+    Helpers::TaskGraph tasks;
+    const int N = 200;
+    for(int i=0; i<N; ++i) {
+        tasks.add(boost::bind(&Recorder::record, &r, i, _1));
+        if( i >= 10 )
+            tasks.addDependency(i, i/10 - 1);
+    }
+
+    tasks.run(4);
+    ASSERT_EQ(N, (int)r.order.size());
+    for(int i=10; i<N; ++i)
+        EXPECT_LT(r.position(i/10 - 1), r.position(i)) << "task " << i;
+}
+
+TEST(TaskGraphTest, Exception)
+{
+    Recorder r;
+    Helpers::TaskGraph tasks;
+    tasks.add(boost::bind(&Recorder::fail, &r, 0, _1));
+    tasks.add(boost::bind(&Recorder::record, &r, 1, _1));
+    tasks.addDependency(1, 0);
+
+    EXPECT_THROW(tasks.run(3), std::runtime_error);
+    EXPECT_TRUE(r.order.empty());
+}
+
+TEST(TaskGraphTest, Cycle)
+{
+    Recorder r;
+    Helpers::TaskGraph tasks;
+    tasks.add(boost::bind(&Recorder::record, &r, 0, _1));
+    tasks.add(boost::bind(&Recorder::record, &r, 1, _1));
+    tasks.add(boost::bind(&Recorder::record, &r, 2, _1));
+    tasks.addDependency(1, 2);
+    tasks.addDependency(2, 1);
+
+    EXPECT_THROW(tasks.run(2), std::logic_error);
+    ASSERT_EQ(1u, r.order.size());
+    EXPECT_EQ(0, r.order[0]);
+}
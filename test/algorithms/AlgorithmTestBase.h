@@ -98,6 +98,7 @@ inline ::testing::AssertionResult AssertStationObsControlCorrected(const char* e
         logs->clear();                                                  \
         BROADCASTER->clear();                                           \
         ALGO->run();                                                    \
+        ALGO->flushWrites();                                            \
         if( BROADCASTER->count() != COUNT ) {                           \
             logs->dump();                                               \
             FAIL() << "Expected " << COUNT << ", but got " << BROADCASTER->count() << " updates."; \
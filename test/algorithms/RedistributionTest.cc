@@ -29,8 +29,10 @@
 
 #include "AlgorithmTestBase.h"
 #include "algorithms/RedistributionAlgorithm.h"
+#include "Backfill.h"
 #include "helpers/mathutil.h"
 #include "foreach.h"
+#include "RunControl.h"
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <algorithm>
@@ -43,6 +45,27 @@
 #define END_FD "7"
 #endif
 
+namespace {
+bool alwaysCancelled()
+{
+    return true;
+}
+
+std::vector<std::string> updateTexts(const TestBroadcaster* bc)
+{
+    std::vector<std::string> updates;
+    for(int i=0; i<bc->count(); ++i) {
+        const kvalobs::kvData& d = bc->update(i);
+        std::ostringstream u;
+        u << d.stationID() << ' ' << kvtime::iso(d.obstime()) << ' ' << d.corrected()
+          << ' ' << d.controlinfo().flagstring() << ' ' << d.cfailed();
+        updates.push_back(u.str());
+    }
+    std::sort(updates.begin(), updates.end());
+    return updates;
+}
+} // anonymous namespace
+
 class RedistributionTest : public AlgorithmTestBase {
 public:
     void SetUp();
@@ -398,6 +421,112 @@ TEST_F(RedistributionTest, TwoSeries)
 
 // ------------------------------------------------------------------------
 
+TEST_F(RedistributionTest, StopAndResume)
+{
+   DataList data(83880, 110, 302);
+   data.add("2011-10-10 06:00:00",   16.9, "0140004000002000", "QC1-2-72.b12,QC1-7-110")
+       .add("2011-10-11 06:00:00",     -1, "0110000000001000", "")
+       .add("2011-10-12 06:00:00",    0.3, "0140000000001000", "QC1-2-72.b12")
+       .add("2011-10-13 06:00:00", -32767, "0000003000002000", "QC1-7-110")
+       .add("2011-10-14 06:00:00",   12.8, "0140004000002000", "QC1-2-72.b12,QC1-7-110")
+        .setStation(83520)
+       .add("2011-10-12 06:00:00",    0.1, "0110000000001000", "")
+       .add("2011-10-13 06:00:00",    2.5, "0110000000001000", "")
+       .add("2011-10-14 06:00:00",    2.6, "0110000000001000", "")
+        .setStation(84190)
+       .add("2011-10-12 06:00:00",     -1, "0110000000001000", "")
+       .add("2011-10-13 06:00:00",    4.5, "0110000000001000", "")
+       .add("2011-10-14 06:00:00",    0.1, "0110000000001000", "")
+        .setStation(84070)
+       .add("2011-10-12 06:00:00",     -1, "0110000000001000", "")
+       .add("2011-10-13 06:00:00",    2.1, "0110000000001000", "")
+       .add("2011-10-14 06:00:00",    0.6, "0110000000001000", "");
+    ASSERT_NO_THROW(data.insert(db));
+
+    AlgorithmConfig params;
+    Configure(params, 11, 18);
+    ASSERT_CONFIGURE(algo, params);
+
+    // cancelled before the first station with an endpoint
+    RunControl cancelled;
+    cancelled.setCancelled(&alwaysCancelled);
+    algo->setRunControl(&cancelled);
+    ASSERT_RUN(algo, bc, 0);
+    EXPECT_TRUE(cancelled.stopped());
+    EXPECT_EQ(83880, cancelled.stoppedStation());
+
+    // a previous run finished all stations before 83881
+    RunControl skip;
+    skip.setResumeStation(83881);
+    algo->setRunControl(&skip);
+    ASSERT_RUN(algo, bc, 0);
+    EXPECT_FALSE(skip.stopped());
+
+    // a skipped station is not recorded as stopped, even if cancelled
+    RunControl skipCancelled;
+    skipCancelled.setResumeStation(83881);
+    skipCancelled.setCancelled(&alwaysCancelled);
+    algo->setRunControl(&skipCancelled);
+    ASSERT_RUN(algo, bc, 0);
+    EXPECT_EQ(-1, skipCancelled.stoppedStation());
+
+    RunControl resume;
+    resume.setResumeStation(cancelled.stoppedStation());
+    algo->setRunControl(&resume);
+    ASSERT_RUN(algo, bc, 2);
+    EXPECT_FALSE(resume.stopped());
+    EXPECT_EQ(-1, resume.stoppedStation());
+    algo->setRunControl(0);
+}
+
+// ------------------------------------------------------------------------
+
+TEST_F(RedistributionTest, BackfillChunks)
+{
+    // the accumulation for 2011-10-14 starts on 2011-10-12, in the first chunk
+   DataList data(83880, 110, 302);
+   data.add("2011-10-10 06:00:00",   16.9, "0140004000002000", "QC1-2-72.b12,QC1-7-110")
+       .add("2011-10-11 06:00:00",     -1, "0110000000001000", "")
+       .add("2011-10-12 06:00:00", -32767, "0000003000002000", "QC1-7-110")
+       .add("2011-10-13 06:00:00", -32767, "0000003000002000", "QC1-7-110")
+       .add("2011-10-14 06:00:00",   12.8, "0140004000002000", "QC1-2-72.b12,QC1-7-110")
+        .setStation(83520)
+       .add("2011-10-12 06:00:00",    0.1, "0110000000001000", "")
+       .add("2011-10-13 06:00:00",    2.5, "0110000000001000", "")
+       .add("2011-10-14 06:00:00",    2.6, "0110000000001000", "")
+        .setStation(84190)
+       .add("2011-10-12 06:00:00",     -1, "0110000000001000", "")
+       .add("2011-10-13 06:00:00",    4.5, "0110000000001000", "")
+       .add("2011-10-14 06:00:00",    0.1, "0110000000001000", "")
+        .setStation(84070)
+       .add("2011-10-12 06:00:00",     -1, "0110000000001000", "")
+       .add("2011-10-13 06:00:00",    2.1, "0110000000001000", "")
+       .add("2011-10-14 06:00:00",    0.6, "0110000000001000", "");
+    ASSERT_NO_THROW(data.insert(db));
+    ASSERT_NO_THROW(db->exec("CREATE TABLE data_before AS SELECT * FROM data;"));
+
+    AlgorithmConfig params;
+    Configure(params, 11, 18);
+    ASSERT_CONFIGURE(algo, params);
+    ASSERT_RUN(algo, bc, 3);
+    const std::vector<std::string> oneRun = updateTexts(bc);
+
+    // same data again, in chunks of 2 days like a backfill
+    ASSERT_NO_THROW(db->exec("DELETE FROM data; INSERT INTO data SELECT * FROM data_before;"));
+    const BackfillChunks chunks = makeBackfillChunks(params.UT0, params.UT1, 2);
+    ASSERT_EQ(4u, chunks.size());
+    bc->clear();
+    foreach(const BackfillChunk& c, chunks) {
+        params.UT0 = c.UT0;
+        params.UT1 = c.UT1;
+        ASSERT_CONFIGURE(algo, params);
+        ASSERT_NO_THROW(algo->run(); algo->flushWrites());
+    }
+    EXPECT_EQ(oneRun, updateTexts(bc));
+}
+
+// ------------------------------------------------------------------------
+
 TEST_F(RedistributionTest, MissingRows)
 {
     // redistribute also if station has missing rows
@@ -0,0 +1,136 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <gtest/gtest.h>
+#include "FlagPatterns.h"
+#include "TestData.h"
+#include "TestDB.h"
+#include "StationSet.h"
+#include "foreach.h"
+
+#include <set>
+#include <sstream>
+
+namespace {
+
+const TimeRange ALL_DAY(kvtime::maketime("2012-03-01 00:00:00"), kvtime::maketime("2012-03-01 23:00:00"));
+
+std::set<int> findStations(SqliteTestDB& db, const StationSet& stations)
+{
+    const DBInterface::DataList data = db.findDataOrderStationObstime(stations, std::vector<int>(1, 110),
+                                                                      std::vector<int>(1, DBInterface::INVALID_ID), ALL_DAY, FlagSetCU());
+    std::set<int> found;
+    foreach(const kvalobs::kvData& d, data)
+        found.insert(d.stationID());
+    return found;
+}
+
+void insertStations(SqliteTestDB& db)
+{
+    std::ostringstream sql;
+    sql << "INSERT INTO station VALUES(    50, 59.0, 10.0,  10.0,  0.0, 'TEST', NULL,    50, NULL, NULL, NULL, 8, 't', '2001-07-01 00:00:00');"
+        << "INSERT INTO station VALUES(   180, 60.0, 11.0, 100.0,  0.0, 'TEST', NULL,   180, NULL, NULL, NULL, 8, 't', '2001-07-01 00:00:00');"
+        << "INSERT INTO station VALUES(  1000, 61.0,  4.0,   0.0, 10.0, 'SHIP', NULL,  1000, NULL, NULL, NULL, 8, 't', '2001-07-01 00:00:00');"
+        << "INSERT INTO station VALUES( 90800, 70.0, 20.0,  10.0,  0.0, 'TEST', NULL, 90800, NULL, NULL, NULL, 8, 't', '2001-07-01 00:00:00');"
+        << "INSERT INTO station VALUES(100500, 55.0, 12.0,  10.0,  0.0, 'TEST', NULL,100500, NULL, NULL, NULL, 8, 't', '2001-07-01 00:00:00');";
+    ASSERT_NO_THROW(db.exec(sql.str()));
+
+    DataList data(50, 110, 302);
+    data.add("2012-03-01 06:00:00", 1, "0110000000001000", "");
+    data.setStation(180)
+        .add("2012-03-01 06:00:00", 2, "0110000000001000", "");
+    data.setStation(1000)
+        .add("2012-03-01 06:00:00", 3, "0110000000001000", "");
+    data.setStation(90800)
+        .add("2012-03-01 06:00:00", 4, "0110000000001000", "");
+    data.setStation(100500)
+        .add("2012-03-01 06:00:00", 5, "0110000000001000", "");
+    ASSERT_NO_THROW(data.insert(&db));
+}
+
+} // anonymous namespace
+
+TEST(StationSetTest, MayContain)
+{
+    const StationSet norwegian = StationSet::norwegian();
+    EXPECT_FALSE(norwegian.mayContain(50));
+    EXPECT_TRUE (norwegian.mayContain(180));
+    EXPECT_TRUE (norwegian.mayContain(99999));
+    EXPECT_FALSE(norwegian.mayContain(100000));
+
+    const StationSet all(DBInterface::StationIDList(1, DBInterface::ALL_STATIONS));
+    EXPECT_FALSE(all.isList());
+    EXPECT_TRUE (all.isFixedOnly());
+    EXPECT_FALSE(all.mayContain(100500));
+
+    DBInterface::StationIDList ids;
+    ids.push_back(180);
+    ids.push_back(90800);
+    StationSet listed(ids);
+    EXPECT_TRUE (listed.mayContain(90800));
+    EXPECT_FALSE(listed.mayContain(1000));
+    listed.range(0, 1000);
+    EXPECT_FALSE(listed.mayContain(90800));
+}
+
+TEST(StationSetTest, Query)
+{
+    SqliteTestDB db;
+    insertStations(db);
+
+    std::set<int> expected;
+    expected.insert(180);
+    expected.insert(90800);
+    EXPECT_EQ(expected, findStations(db, StationSet::norwegian()));
+    EXPECT_EQ(expected, findStations(db, DBInterface::StationIDList(1, DBInterface::ALL_STATIONS)));
+
+    expected.insert(50);
+    expected.insert(100500);
+    EXPECT_EQ(expected, findStations(db, StationSet::fixed()));
+
+    expected.insert(1000);
+    EXPECT_EQ(expected, findStations(db, StationSet()));
+
+    expected.clear();
+    expected.insert(180);
+    expected.insert(1000);
+    EXPECT_EQ(expected, findStations(db, StationSet().range(100, 1000)));
+
+    expected.erase(1000);
+    EXPECT_EQ(expected, findStations(db, StationSet::fixed().range(100, 1000)));
+
+    DBInterface::StationIDList ids;
+    ids.push_back(1000);
+    ids.push_back(100500);
+    expected.clear();
+    expected.insert(1000);
+    expected.insert(100500);
+    EXPECT_EQ(expected, findStations(db, ids));
+    EXPECT_TRUE(findStations(db, DBInterface::StationIDList()).empty());
+}
@@ -307,10 +307,9 @@ TEST_F(StatisticalMeanTest, FakeDeviation_PR)
 // in generated file algorithms/StatisticalMean_n212.cc
 void prepare_daymeans_212(SqliteTestDB* db);
 
-TEST_F(StatisticalMeanTest, FakeDeviation_TA)
+namespace {
+void insertFakeDeviation_TA(SqliteTestDB* db, int ctr)
 {
-    prepare_daymeans_212(db);
-    const int ctr = 7010;
     DataList data(ctr, 211, 330);
     kvtime::time date = kvtime::maketime("2012-01-01 06:00:00"), dateEnd = kvtime::maketime("2012-02-29 06:00:00");
     for(; date <= dateEnd; kvtime::addDays(date, 1)) {
@@ -330,20 +329,39 @@ TEST_F(StatisticalMeanTest, FakeDeviation_TA)
             .add(date, -0.9, "0100000000000010");
     }
     ASSERT_NO_THROW(data.insert(db));
+}
 
-    std::stringstream config;
-    config << "Start_YYYY = 2012\n"
-           << "Start_MM   =    2\n"
-           << "Start_DD   =    1\n"
-           << "Start_hh   =   06\n"
-           << "End_YYYY   = 2012\n"
-           << "End_MM     =    2\n"
-           << "End_DD     =    7\n"
-           << "days       =   30\n"
-           << "tolerance  =   0.2\n"
-           << "ParamId    =  211\n"
-           << "TypeIds    =  330\n"
-           << "InterpolationDistance = 5000.0\n";
+float aggregateSum(const DBInterface::DailyAggregateList& aggregates, int stationid, const kvtime::date& day)
+{
+    foreach(const DailyAggregate& a, aggregates) {
+        if( a.instrument.stationid == stationid && a.day == day )
+            return a.sum;
+    }
+    return -32767;
+}
+
+const char config_FakeDeviation_TA[] =
+    "Start_YYYY = 2012\n"
+    "Start_MM   =    2\n"
+    "Start_DD   =    1\n"
+    "Start_hh   =   06\n"
+    "End_YYYY   = 2012\n"
+    "End_MM     =    2\n"
+    "End_DD     =    7\n"
+    "days       =   30\n"
+    "tolerance  =   0.2\n"
+    "ParamId    =  211\n"
+    "TypeIds    =  330\n"
+    "InterpolationDistance = 5000.0\n";
+} // anonymous namespace
+
+TEST_F(StatisticalMeanTest, FakeDeviation_TA)
+{
+    prepare_daymeans_212(db);
+    const int ctr = 7010;
+    insertFakeDeviation_TA(db, ctr);
+
+    std::stringstream config(config_FakeDeviation_TA);
     AlgorithmConfig params;
     params.Parse(config);
 
@@ -359,6 +377,72 @@ TEST_F(StatisticalMeanTest, FakeDeviation_TA)
 
 // ------------------------------------------------------------------------
 
+TEST_F(StatisticalMeanTest, DailyAggregatesReused)
+{
+    prepare_daymeans_212(db);
+    const int ctr = 7010;
+    insertFakeDeviation_TA(db, ctr);
+
+    std::stringstream config;
+    config << config_FakeDeviation_TA << "daily_aggregates = 1\n";
+    AlgorithmConfig params;
+    params.Parse(config);
+
+    ASSERT_CONFIGURE(algo, params);
+    ASSERT_RUN(algo, bc, 0);
+    ASSERT_EQ(5, logs->count(Message::WARNING));
+
+    const std::vector<int> tids(1, 330);
+    const kvtime::date d0 = kvtime::makedate(2012, 1, 3), d1 = kvtime::makedate(2012, 2, 6), d20 = kvtime::makedate(2012, 1, 20);
+    const DBInterface::DailyAggregateList stored = db->findDailyAggregates(211, tids, d0, d1);
+    ASSERT_EQ(4u*34, stored.size()); // no data on 2012-01-15
+    EXPECT_FLOAT_EQ(-11.2, aggregateSum(stored, ctr, d20));
+
+    // complete days are not read from the data table again unless they change
+    ASSERT_NO_THROW(db->exec("UPDATE data SET original = original + 100, corrected = corrected + 100"
+                             " WHERE obstime BETWEEN '2012-01-03 00:00:00' AND '2012-02-06 23:59:59';"));
+    ASSERT_RUN(algo, bc, 0);
+    ASSERT_EQ(5, logs->count(Message::WARNING));
+    EXPECT_FLOAT_EQ(-11.2, aggregateSum(db->findDailyAggregates(211, tids, d0, d1), ctr, d20));
+
+    // a row with a new tbtime makes its day be recalculated
+    ASSERT_NO_THROW(db->exec("UPDATE data SET tbtime = '2030-01-01 00:00:00' WHERE stationid = 7010 AND obstime = '2012-01-20 06:00:00';"));
+    ASSERT_RUN(algo, bc, 0);
+    EXPECT_FLOAT_EQ(88.8, aggregateSum(db->findDailyAggregates(211, tids, d0, d1), ctr, d20));
+
+    // a deleted row makes its day be recalculated, too
+    ASSERT_NO_THROW(db->exec("DELETE FROM data WHERE stationid = 7010 AND obstime = '2012-01-21 06:00:00';"));
+    ASSERT_RUN(algo, bc, 0);
+    EXPECT_EQ(4u*34 - 1, db->findDailyAggregates(211, tids, d0, d1).size());
+}
+
+// ------------------------------------------------------------------------
+
+TEST_F(StatisticalMeanTest, ReferenceValuesReloaded)
+{
+    prepare_daymeans_212(db);
+    const int ctr = 7010;
+    insertFakeDeviation_TA(db, ctr);
+
+    std::stringstream config(config_FakeDeviation_TA);
+    AlgorithmConfig params;
+    params.Parse(config);
+
+    ASSERT_CONFIGURE(algo, params);
+    ASSERT_RUN(algo, bc, 0);
+    ASSERT_EQ(5, logs->count(Message::WARNING));
+
+    ASSERT_RUN(algo, bc, 0);
+    ASSERT_EQ(5, logs->count(Message::WARNING));
+
+    // without reference values for the center, the test cannot trigger
+    ASSERT_NO_THROW(db->exec("DELETE FROM qc2_statistical_reference_values WHERE stationid = 7010;"));
+    ASSERT_RUN(algo, bc, 0);
+    ASSERT_EQ(0, logs->count(Message::WARNING));
+}
+
+// ------------------------------------------------------------------------
+
 TEST_F(StatisticalMeanTest, FakeDeviation_VV)
 {
     // sight (synsvidde), completely arbitrary observation and
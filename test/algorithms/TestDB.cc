@@ -30,8 +30,12 @@
 #include "TestDB.h"
 
 SqliteTestDB::SqliteTestDB()
+    : mOwnsDb(true)
+    , mShareConnections(false)
+    , mConnectionsCreated(0)
 {
-    if( sqlite3_open("", &db) )
+    // serialized, so that connections from newConnection() may be used in several threads
+    if( sqlite3_open_v2("", &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX, 0) )
         throw std::runtime_error("could not create db");
 
     exec("CREATE TABLE data ("
@@ -84,6 +88,19 @@ SqliteTestDB::SqliteTestDB()
         "key         TEXT NOT NULL, "
         "value       FLOAT NOT NULL);");
 
+    exec("CREATE TABLE qc2_statistical_daily_aggregates ("
+        "stationid   INTEGER NOT NULL, "
+        "paramid     INTEGER NOT NULL, "
+        "typeid      INTEGER NOT NULL, "
+        "sensor      CHAR(1) DEFAULT '0', "
+        "level       INTEGER DEFAULT 0, "
+        "obsdate     DATE NOT NULL, "
+        "value_sum   FLOAT NOT NULL, "
+        "value_count INTEGER NOT NULL, "
+        "bad_count   INTEGER NOT NULL, "
+        "row_count   INTEGER NOT NULL, "
+        "computed    TIMESTAMP NOT NULL);");
+
     exec("CREATE TABLE qc2_interpolation_best_neighbors ("
          "stationid        INTEGER NOT NULL, "
          "neighborid       INTEGER NOT NULL, "
@@ -100,13 +117,43 @@ SqliteTestDB::SqliteTestDB()
          "level     INTEGER   NOT NULL, "
          "modelid   INTEGER   NOT NULL, "
          "original  DOUBLE);");
+
+    exec("CREATE TABLE qc2_work_leases ("
+         "work     TEXT      NOT NULL, "
+         "item     TEXT      NOT NULL, "
+         "owner    TEXT      NOT NULL, "
+         "expires  TIMESTAMP NOT NULL, "
+         "done     INTEGER   NOT NULL, "
+         "attempts INTEGER   NOT NULL, "
+         "PRIMARY KEY (work, item));");
+}
+
+// ------------------------------------------------------------------------
+
+SqliteTestDB::SqliteTestDB(sqlite3* shared)
+    : db(shared)
+    , mOwnsDb(false)
+    , mShareConnections(false)
+    , mConnectionsCreated(0)
+{
 }
 
 // ------------------------------------------------------------------------
 
 SqliteTestDB::~SqliteTestDB()
 {
-    sqlite3_close(db);
+    if( mOwnsDb )
+        sqlite3_close(db);
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface* SqliteTestDB::newConnection()
+{
+    if( !mShareConnections )
+        return 0;
+    mConnectionsCreated += 1;
+    return new SqliteTestDB(db);
 }
 
 // ------------------------------------------------------------------------
@@ -281,6 +328,47 @@ DBInterface::reference_value_map_t SqliteTestDB::extractStatisticalReferenceValu
 
 // ------------------------------------------------------------------------
 
+DBInterface::DailyAggregateList SqliteTestDB::extractDailyAggregates(const std::string& sql) throw (DBException)
+{
+    DailyAggregateList aggregates;
+    sqlite3_stmt *stmt = prepare_statement(sql);
+    int step;
+    while( (step = sqlite3_step(stmt)) == SQLITE_ROW ) {
+        int col = 0;
+        const int stationid = sqlite3_column_int(stmt, col++);
+        const int paramid   = sqlite3_column_int(stmt, col++);
+        const int type      = sqlite3_column_int(stmt, col++);
+        const int sensor    = sqlite3_column_int(stmt, col++);
+        const int level     = sqlite3_column_int(stmt, col++);
+        const kvtime::date day = kvtime::makedate(sqlite3_column_string(stmt, col++));
+        const float sum     = sqlite3_column_double(stmt, col++);
+        const int count     = sqlite3_column_int(stmt, col++);
+        const int badCount  = sqlite3_column_int(stmt, col++);
+        const int rowCount  = sqlite3_column_int(stmt, col++);
+        const kvtime::time computed = kvtime::maketime(sqlite3_column_string(stmt, col++));
+        aggregates.push_back(DailyAggregate(Instrument(stationid, paramid, sensor, type, level), day, sum, count, badCount, rowCount, computed));
+    }
+    finalize_statement(stmt, step);
+    return aggregates;
+}
+
+// ------------------------------------------------------------------------
+
+DBInterface::DayCountMap SqliteTestDB::extractDayCounts(const std::string& sql) throw (DBException)
+{
+    DayCountMap counts;
+    sqlite3_stmt *stmt = prepare_statement(sql);
+    int step;
+    while( (step = sqlite3_step(stmt)) == SQLITE_ROW ) {
+        const kvtime::date day = kvtime::makedate(sqlite3_column_string(stmt, 0));
+        counts[day] = sqlite3_column_int(stmt, 1);
+    }
+    finalize_statement(stmt, step);
+    return counts;
+}
+
+// ------------------------------------------------------------------------
+
 NeighborDataVector SqliteTestDB::extractNeighborData(const std::string& sql) throw (DBException)
 {
     NeighborDataVector neighbors;
@@ -300,6 +388,48 @@ NeighborDataVector SqliteTestDB::extractNeighborData(const std::string& sql) thr
 
 // ------------------------------------------------------------------------
 
+NeighborDataMap SqliteTestDB::extractNeighborDataMap(const std::string& sql) throw (DBException)
+{
+    NeighborDataMap neighbors;
+    sqlite3_stmt *stmt = prepare_statement(sql);
+    int step;
+    while( (step = sqlite3_step(stmt)) == SQLITE_ROW ) {
+        int col = 0;
+        const int stationid  = sqlite3_column_int(stmt, col++);
+        const int paramid    = sqlite3_column_int(stmt, col++);
+        const int neighborid = sqlite3_column_int(stmt, col++);
+        const float offset   = sqlite3_column_double(stmt, col++);
+        const float slope    = sqlite3_column_double(stmt, col++);
+        const float sigma    = sqlite3_column_double(stmt, col++);
+        neighbors[std::make_pair(stationid, paramid)].push_back(NeighborData(neighborid, offset, slope, sigma));
+    }
+    finalize_statement(stmt, step);
+    return neighbors;
+}
+
+// ------------------------------------------------------------------------
+
+std::string SqliteTestDB::extractText(const std::string& sql) throw (DBException)
+{
+    std::string text;
+    sqlite3_stmt *stmt = prepare_statement(sql);
+    int step;
+    while( (step = sqlite3_step(stmt)) == SQLITE_ROW ) {
+        const int ncol = sqlite3_column_count(stmt);
+        for(int col = 0; col < ncol; ++col) {
+            if( !text.empty() )
+                text += ' ';
+            const unsigned char* t = sqlite3_column_text(stmt, col);
+            if( t )
+                text += (const char*)t;
+        }
+    }
+    finalize_statement(stmt, step);
+    return text;
+}
+
+// ------------------------------------------------------------------------
+
 DBInterface::ModelDataList SqliteTestDB::extractModelData(const std::string& sql) throw (DBException)
 {
     ModelDataList modelData;
@@ -334,11 +464,7 @@ void SqliteTestDB::execSQLUpdate(const std::string& sql) throw (DBException)
 
 // ------------------------------------------------------------------------
 
-void SqliteTestDB::formatStationIDList(std::ostream& sql, const StationIDList& stationIDs)
+void SqliteTestDB::formatTimeFromNow(std::ostream& sql, int seconds)
 {
-    if( stationIDs.size() == 1 and stationIDs.front() == ALL_STATIONS ) {
-        sql << "stationid IN (SELECT stationid FROM station WHERE stationid BETWEEN 60 AND 99999 AND maxspeed = 0)";
-    } else {
-        SQLDataAccess::formatStationIDList(sql, stationIDs);
-    }
+    sql << "datetime('now', '" << (seconds >= 0 ? "+" : "") << seconds << " seconds')";
 }
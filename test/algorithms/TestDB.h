@@ -39,28 +39,45 @@ public:
     SqliteTestDB();
     ~SqliteTestDB();
 
+    /** Let newConnection() return connections sharing this database, e.g. for worker threads. */
+    void setShareConnections(bool share)
+        { mShareConnections = share; }
+
+    int connectionsCreated() const
+        { return mConnectionsCreated; }
+
+    virtual DBInterface* newConnection();
+
 public:
     virtual StationList extractStations(const std::string& sql) throw (DBException);
     virtual StationIDList extractStationIDs(const std::string& sql) throw (DBException);
     virtual StationParamList extractStationParams(const std::string& sql) throw (DBException);
     virtual DataList extractData(const std::string& sql) throw (DBException);
     virtual reference_value_map_t extractStatisticalReferenceValues(const std::string& sql, float missingValue) throw (DBException);
+    virtual DailyAggregateList extractDailyAggregates(const std::string& sql) throw (DBException);
+    virtual DayCountMap extractDayCounts(const std::string& sql) throw (DBException);
     virtual NeighborDataVector extractNeighborData(const std::string& sql) throw (DBException);
+    virtual NeighborDataMap extractNeighborDataMap(const std::string& sql) throw (DBException);
+    virtual std::string extractText(const std::string& sql) throw (DBException);
     virtual ModelDataList extractModelData(const std::string& sql) throw (DBException);
     virtual void execSQLUpdate(const std::string& sql) throw (DBException);
-
-    virtual void formatStationIDList(std::ostream& sql, const StationIDList& stationIDs);
+    virtual void formatTimeFromNow(std::ostream& sql, int seconds);
 
     // test helpers
     void exec(const std::string& statements) throw (DBException)
         { execSQLUpdate(statements); }
 
 private:
+    SqliteTestDB(sqlite3* shared);
+
     sqlite3_stmt* prepare_statement(const std::string& sql);
     void finalize_statement(sqlite3_stmt* stmt, int lastStep);
 
 private:
     sqlite3 *db;
+    bool mOwnsDb;
+    bool mShareConnections;
+    int mConnectionsCreated;
 };
 
 #endif /* MEMORYTESTDB_H */
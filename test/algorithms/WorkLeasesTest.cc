@@ -0,0 +1,174 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <gtest/gtest.h>
+#include "LeasedBackfillWork.h"
+#include "RunControl.h"
+#include "TestDB.h"
+
+namespace {
+const std::string WORK = "plu.cfg2";
+
+std::vector<std::string> threeItems()
+{
+    std::vector<std::string> items;
+    items.push_back("a");
+    items.push_back("b");
+    items.push_back("c");
+    return items;
+}
+} // anonymous namespace
+
+TEST(WorkLeasesTest, ClaimAndFinish)
+{
+    SqliteTestDB db;
+    const int lease = 300;
+
+    db.addWorkItems(WORK, threeItems());
+    db.addWorkItems(WORK, threeItems());
+    ASSERT_EQ(3, db.countOpenWorkItems(WORK));
+
+    EXPECT_EQ("a", db.claimWorkItem(WORK, "p1", lease, 3));
+    EXPECT_EQ("b", db.claimWorkItem(WORK, "p2", lease, 3));
+    EXPECT_EQ("c", db.claimWorkItem(WORK, "p3", lease, 3));
+    EXPECT_EQ("",  db.claimWorkItem(WORK, "p4", lease, 3));
+
+    db.finishWorkItem(WORK, "a", "p1", true);
+    db.finishWorkItem(WORK, "b", "p2", false);
+    db.finishWorkItem(WORK, "c", "p1", true); // not the owner
+    EXPECT_EQ(2, db.countOpenWorkItems(WORK));
+
+    // b has been given up, c is still leased by p3
+    EXPECT_EQ("b", db.claimWorkItem(WORK, "p4", lease, 3));
+    EXPECT_EQ("",  db.claimWorkItem(WORK, "p5", lease, 3));
+
+    // other work is independent
+    db.addWorkItems("other.cfg2", threeItems());
+    EXPECT_EQ(3, db.countOpenWorkItems("other.cfg2"));
+}
+
+TEST(WorkLeasesTest, Expiry)
+{
+    SqliteTestDB db;
+    const int lease = 300;
+    // leases are compared with the database clock; let them expire by moving them back in time
+    const std::string expire = "UPDATE qc2_work_leases SET expires = '2000-01-01 00:00:00';";
+
+    db.addWorkItems(WORK, std::vector<std::string>(1, "a"));
+    EXPECT_EQ("a", db.claimWorkItem(WORK, "p1", lease, 3));
+    EXPECT_EQ("",  db.claimWorkItem(WORK, "p2", lease, 3));
+
+    // renewed by the heartbeat of p1
+    db.exec(expire);
+    db.renewWorkItem(WORK, "a", "p1", lease);
+    EXPECT_EQ("",  db.claimWorkItem(WORK, "p2", lease, 3));
+
+    // a lease ending in the past has expired
+    db.renewWorkItem(WORK, "a", "p1", -lease);
+    EXPECT_EQ("a", db.claimWorkItem(WORK, "p2", lease, 3));
+    db.finishWorkItem(WORK, "a", "p1", true);
+    EXPECT_EQ(1, db.countOpenWorkItems(WORK));
+    db.finishWorkItem(WORK, "a", "p2", true);
+    EXPECT_EQ(0, db.countOpenWorkItems(WORK));
+}
+
+TEST(WorkLeasesTest, Attempts)
+{
+    SqliteTestDB db;
+    const int lease = 300;
+
+    db.addWorkItems(WORK, std::vector<std::string>(1, "a"));
+    EXPECT_EQ("a", db.claimWorkItem(WORK, "p1", lease, 2));
+    db.finishWorkItem(WORK, "a", "p1", false);
+    EXPECT_EQ(1, db.countOpenWorkItems(WORK));
+
+    // the second attempt crashes, its lease expires
+    EXPECT_EQ("a", db.claimWorkItem(WORK, "p2", lease, 2));
+    db.renewWorkItem(WORK, "a", "p2", -lease);
+
+    EXPECT_EQ("",  db.claimWorkItem(WORK, "p3", lease, 2));
+    EXPECT_EQ(0, db.countOpenWorkItems(WORK));
+
+    // failed items are not started again
+    db.addWorkItems(WORK, std::vector<std::string>(1, "a"));
+    EXPECT_EQ("",  db.claimWorkItem(WORK, "p4", lease, 2));
+}
+
+TEST(WorkLeasesTest, LeasedBackfillWork)
+{
+    SqliteTestDB db;
+    const kvtime::time t0 = kvtime::maketime(2012, 1, 1, 0, 0, 0), t1 = kvtime::maketime(2012, 1, 3, 0, 0, 0);
+    const BackfillChunks chunks = makeBackfillChunks(t0, t1, 1);
+
+    LeasedBackfillWork work(&db, WORK, chunks, 2, 60, boost::function<bool()>());
+    BackfillItem item;
+    int nItems = 0;
+    while( work.next(item) ) {
+        EXPECT_EQ(2, item.nShards);
+        work.finished(item, true);
+        nItems += 1;
+    }
+    EXPECT_EQ(4, nItems);
+
+    LeasedBackfillWork again(&db, WORK, chunks, 2, 60, boost::function<bool()>());
+    EXPECT_FALSE(again.next(item));
+}
+
+TEST(WorkLeasesTest, AlwaysFailing)
+{
+    SqliteTestDB db;
+    const kvtime::time t0 = kvtime::maketime(2012, 1, 1, 0, 0, 0), t1 = kvtime::maketime(2012, 1, 2, 0, 0, 0);
+    const BackfillChunks chunks = makeBackfillChunks(t0, t1, 1);
+    ASSERT_EQ(1u, chunks.size());
+
+    LeasedBackfillWork work(&db, WORK, chunks, 1, 60, boost::function<bool()>());
+    BackfillItem item;
+    int nAttempts = 0;
+    while( work.next(item) && nAttempts < 10 ) {
+        work.finished(item, false);
+        nAttempts += 1;
+    }
+    EXPECT_EQ(int(LeasedBackfillWork::MAX_ATTEMPTS), nAttempts);
+    EXPECT_EQ(0, db.countOpenWorkItems(WORK));
+}
+
+TEST(WorkLeasesTest, Shards)
+{
+    RunControl control;
+    EXPECT_FALSE(control.skipsStation(180));
+
+    control.setShard(1, 4);
+    EXPECT_TRUE(control.skipsStation(180));
+    EXPECT_FALSE(control.skipsStation(181));
+    EXPECT_TRUE(control.skipsStation(182));
+
+    control.setResumeStation(200);
+    EXPECT_TRUE(control.skipsStation(181));
+    EXPECT_FALSE(control.skipsStation(201));
+}
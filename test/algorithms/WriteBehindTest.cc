@@ -0,0 +1,222 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <gtest/gtest.h>
+#include "TestBroadcaster.h"
+#include "TestData.h"
+#include "TestDB.h"
+#include "WriteBehindDB.h"
+#include "foreach.h"
+
+#include <boost/ref.hpp>
+
+namespace {
+
+class FailingDB : public SqliteTestDB {
+public:
+    FailingDB() : failures(0), badStation(0) { }
+
+    virtual void storeData(const DataList& toUpdate, const DataList& toInsert) throw (DBException)
+    {
+        if( failures > 0 ) {
+            failures -= 1;
+            throw DBException("test failure");
+        }
+        foreach(const kvalobs::kvData& d, toUpdate) {
+            if( d.stationID() == badStation )
+                throw DBException("bad row");
+        }
+        SqliteTestDB::storeData(toUpdate, toInsert);
+    }
+
+    int failures;
+    int badStation; // rows for this station are refused
+};
+
+struct CountWritten {
+    CountWritten() : updated(0) { }
+    void operator()(const DBInterface::DataList& u, const DBInterface::DataList&)
+        { updated += u.size(); }
+    std::size_t updated;
+};
+
+DBInterface::DataList corrected(const DBInterface::DataList& data, float c)
+{
+    DBInterface::DataList updates;
+    foreach(kvalobs::kvData d, data) {
+        d.corrected(c);
+        updates.push_back(d);
+    }
+    return updates;
+}
+
+const TimeRange ALL_DAY(kvtime::maketime("2012-03-01 00:00:00"), kvtime::maketime("2012-03-01 23:00:00"));
+
+} // anonymous namespace
+
+TEST(WriteBehindTest, Batch)
+{
+    FailingDB db;
+    TestBroadcaster bc;
+    DataList data(180, 110, 302);
+    data.add("2012-03-01 06:00:00", 1, "0110000000001000", "")
+        .add("2012-03-01 07:00:00", 2, "0110000000001000", "");
+    data.setStation(90800)
+        .add("2012-03-01 06:00:00", 3, "0110000000001000", "");
+    ASSERT_NO_THROW(data.insert(&db));
+
+    WriteBehindDB wb;
+    wb.setDatabase(&db);
+    wb.setBroadcaster(&bc);
+    wb.setLimits(10, 60000);
+
+    const DBInterface::DataList updates = corrected(db.findDataOrderObstime(180, 110, ALL_DAY), 5);
+    ASSERT_EQ(2u, updates.size());
+    foreach(const kvalobs::kvData& u, updates)
+        wb.storeData(DBInterface::DataList(1, u), DBInterface::DataList());
+    EXPECT_EQ(2u, wb.queued());
+    EXPECT_EQ(0, bc.count());
+    EXPECT_FLOAT_EQ(1, db.findDataOrderObstime(180, 110, ALL_DAY).front().corrected());
+
+    // reading another station does not write
+    wb.findDataOrderObstime(90800, 110, ALL_DAY);
+    EXPECT_EQ(2u, wb.queued());
+
+    // reading the same instrument writes both rows in one transaction
+    const DBInterface::DataList after = wb.findDataOrderObstime(180, 110, ALL_DAY);
+    EXPECT_EQ(0u, wb.queued());
+    EXPECT_EQ(1, wb.transactions());
+    EXPECT_EQ(2, bc.count());
+    ASSERT_EQ(2u, after.size());
+    EXPECT_FLOAT_EQ(5, after.front().corrected());
+    EXPECT_FLOAT_EQ(5, after.back().corrected());
+
+    // maxRows
+    wb.setLimits(2, 60000);
+    wb.storeData(corrected(db.findDataOrderObstime(90800, 110, ALL_DAY), 6), DBInterface::DataList());
+    EXPECT_EQ(1u, wb.queued());
+    wb.storeData(corrected(after, 7), DBInterface::DataList());
+    EXPECT_EQ(0u, wb.queued());
+    EXPECT_EQ(2, wb.transactions());
+    EXPECT_EQ(5, bc.count());
+}
+
+TEST(WriteBehindTest, Failure)
+{
+    FailingDB db;
+    TestBroadcaster bc;
+    DataList data(180, 110, 302);
+    data.add("2012-03-01 06:00:00", 1, "0110000000001000", "");
+    ASSERT_NO_THROW(data.insert(&db));
+
+    WriteBehindDB wb;
+    wb.setDatabase(&db);
+    wb.setBroadcaster(&bc);
+    wb.setLimits(10, 60000);
+    wb.storeData(corrected(db.findDataOrderObstime(180, 110, ALL_DAY), 5), DBInterface::DataList());
+
+    // one failure is retried at once
+    db.failures = 1;
+    ASSERT_NO_THROW(wb.flush());
+    EXPECT_EQ(0u, wb.queued());
+    EXPECT_EQ(1, bc.count());
+
+    // after two failures, the storeData() call is written alone
+    wb.storeData(corrected(db.findDataOrderObstime(180, 110, ALL_DAY), 6), DBInterface::DataList());
+    db.failures = 2;
+    ASSERT_NO_THROW(wb.flush());
+    EXPECT_EQ(0u, wb.queued());
+    EXPECT_EQ(2, bc.count());
+    EXPECT_FLOAT_EQ(6, db.findDataOrderObstime(180, 110, ALL_DAY).front().corrected());
+
+    wb.storeData(corrected(db.findDataOrderObstime(180, 110, ALL_DAY), 7), DBInterface::DataList());
+    EXPECT_EQ(1u, wb.discard());
+    EXPECT_EQ(0u, wb.queued());
+}
+
+TEST(WriteBehindTest, BadRow)
+{
+    FailingDB db;
+    TestBroadcaster bc;
+    DataList data(180, 110, 302);
+    data.add("2012-03-01 06:00:00", 1, "0110000000001000", "")
+        .add("2012-03-01 07:00:00", 2, "0110000000001000", "");
+    data.setStation(90800)
+        .add("2012-03-01 06:00:00", 3, "0110000000001000", "");
+    ASSERT_NO_THROW(data.insert(&db));
+
+    CountWritten count;
+    WriteBehindDB wb;
+    wb.setDatabase(&db);
+    wb.setBroadcaster(&bc);
+    wb.setWrittenCallback(boost::ref(count));
+    wb.setLimits(10, 60000);
+
+    const DBInterface::DataList d180 = db.findDataOrderObstime(180, 110, ALL_DAY);
+    ASSERT_EQ(2u, d180.size());
+    DBInterface::DataList mixed = corrected(db.findDataOrderObstime(90800, 110, ALL_DAY), 8);
+    mixed.push_back(corrected(d180, 8).back());
+    wb.storeData(corrected(DBInterface::DataList(1, d180.front()), 8), DBInterface::DataList());
+    wb.storeData(mixed, DBInterface::DataList());
+    EXPECT_EQ(3u, wb.queued());
+    EXPECT_EQ(0u, count.updated);
+
+    // the batch and the second storeData() call fail; only the row for 90800 stays queued
+    db.badStation = 90800;
+    EXPECT_THROW(wb.flush(), DBException);
+    EXPECT_EQ(1u, wb.queued());
+    EXPECT_EQ(2, bc.count());
+    EXPECT_EQ(2u, count.updated);
+    EXPECT_EQ(2, wb.transactions());
+    const DBInterface::DataList after = db.findDataOrderObstime(180, 110, ALL_DAY);
+    ASSERT_EQ(2u, after.size());
+    EXPECT_FLOAT_EQ(8, after.front().corrected());
+    EXPECT_FLOAT_EQ(8, after.back().corrected());
+    EXPECT_FLOAT_EQ(3, db.findDataOrderObstime(90800, 110, ALL_DAY).front().corrected());
+
+    // it is written by the next flush that works
+    db.badStation = 0;
+    ASSERT_NO_THROW(wb.flush());
+    EXPECT_EQ(0u, wb.queued());
+    EXPECT_EQ(3u, count.updated);
+    EXPECT_FLOAT_EQ(8, db.findDataOrderObstime(90800, 110, ALL_DAY).front().corrected());
+    EXPECT_EQ(0u, wb.discard());
+
+    // a row that is always refused is given up after MAX_ROW_ATTEMPTS flushes
+    wb.storeData(corrected(db.findDataOrderObstime(90800, 110, ALL_DAY), 9), DBInterface::DataList());
+    db.badStation = 90800;
+    for(int i=1; i<=WriteBehindDB::MAX_ROW_ATTEMPTS; ++i) {
+        EXPECT_THROW(wb.flush(), DBException);
+        EXPECT_EQ((i < WriteBehindDB::MAX_ROW_ATTEMPTS) ? 1u : 0u, wb.queued());
+    }
+    ASSERT_NO_THROW(wb.flush());
+    EXPECT_EQ(3u, count.updated);
+    EXPECT_EQ(1u, wb.discard());
+    EXPECT_EQ(0u, wb.discard());
+}
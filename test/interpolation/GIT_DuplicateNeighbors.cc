@@ -0,0 +1,49 @@
+
+#include "GapInterpolationTestBase.hh"
+
+#include "interpolation/GapInterpolationAlgorithm.h"
+
+TEST_F(GapInterpolationTest, DuplicateNeighbors)
+{
+    DataList data(18210, 211, 330);
+    data.add("2012-11-05 08:00:00",       1.5, "0111000000100010", "")
+        .add("2012-11-05 09:00:00",       2.5, "0111000000100010", "")
+        .add("2012-11-05 10:00:00",       3.5, "0111000000100010", "");
+    data.setStation(18230);
+    data.add("2012-11-05 08:00:00",       4.5, "0111000000100010", "")
+        .add("2012-11-05 10:00:00",       5.5, "0111000000100010", "");
+    ASSERT_NO_THROW(data.insert(db));
+
+    std::stringstream config;
+    config << "Start_YYYY = 2012\n"
+           << "Start_MM   =   11\n"
+           << "Start_DD   =   05\n"
+           << "Start_hh   =   08\n"
+           << "End_YYYY   = 2012\n"
+           << "End_MM     =   11\n"
+           << "End_DD     =   05\n"
+           << "End_hh     =   10\n"
+           << "TypeId     =  330\n"
+           << "Parameter  = par=211,minPar=213,maxPar=215,minVal=-80,maxVal=80,offsetCorrectionLimit=15,fluctuationLevel=0.2\n";
+    AlgorithmConfig params;
+    ASSERT_PARSE_CONFIG(params, config);
+    ASSERT_CONFIGURE(algo, params);
+
+    std::vector<int> neighborids;
+    neighborids.push_back(18210);
+    neighborids.push_back(18230);
+    neighborids.push_back(18210);
+
+    GapInterpolationAlgorithm* gia = static_cast<GapInterpolationAlgorithm*>(algo);
+    const TimeRange t(kvtime::maketime("2012-11-05 08:00:00"), kvtime::maketime("2012-11-05 10:00:00"));
+    const GapInterpolationAlgorithm::NeighborSupportData nd = gia->getNeighborData(t, neighborids, 211);
+    ASSERT_EQ(3u, nd.size());
+    for(int time=0; time<3; ++time) {
+        ASSERT_TRUE(nd[0][time].usable());
+        ASSERT_TRUE(nd[2][time].usable());
+        EXPECT_FLOAT_EQ(nd[0][time].value(), nd[2][time].value());
+    }
+    EXPECT_FLOAT_EQ(2.5, nd[2][1].value());
+    EXPECT_FALSE(nd[1][1].usable());
+    EXPECT_FLOAT_EQ(5.5, nd[1][2].value());
+}
@@ -0,0 +1,44 @@
+#include "GapInterpolationTestBase.hh"
+
+#include "interpolation/NeighborCorrelationCache.h"
+
+TEST_F(GapInterpolationTest, NeighborCorrelationCache)
+{
+    std::vector<int> pids;
+    pids.push_back(211);
+    pids.push_back(262);
+
+    NeighborCorrelationCache cache;
+    ASSERT_FALSE(cache.isLoaded());
+    ASSERT_NO_THROW(cache.refresh(db, pids));
+    ASSERT_TRUE(cache.isLoaded());
+
+    EXPECT_EQ(10, cache.find(18700, 211, 2.7).size());
+    EXPECT_EQ(10, cache.find(18700, 262, 2.7).size());
+    EXPECT_EQ( 0, cache.find(18700, 178, 2.7).size());
+    EXPECT_EQ( 0, cache.find(18700, 211, 0.5).size());
+
+    std::ostringstream sql;
+    INSERT_NEIGHBOR(sql, 18700, 211, 1380, 0, 1, 0.5);
+    INSERT_NEIGHBOR(sql, 18700, 211, 4460, 0, 1, 3.0);
+    ASSERT_NO_THROW_X(db->exec(sql.str()));
+
+    // not reloaded before refresh
+    EXPECT_EQ(10, cache.find(18700, 211, 2.7).size());
+
+    ASSERT_NO_THROW(cache.refresh(db, pids));
+    const NeighborDataVector n = cache.find(18700, 211, 2.7);
+    ASSERT_EQ(11, n.size());
+    EXPECT_EQ(1380, n.front().neighborid);
+    EXPECT_FLOAT_EQ(8, n.front().weight);
+    EXPECT_FLOAT_EQ(1, n.back().weight);
+
+    EXPECT_EQ(12, cache.find(18700, 211, 5).size());
+
+    // moving a row to another station keeps count and plain sums
+    ASSERT_NO_THROW_X(db->exec("UPDATE qc2_interpolation_best_neighbors SET stationid = 18701"
+                               " WHERE stationid = 18700 AND paramid = 211 AND neighborid = 1380 AND fit_sigma = 0.5;"));
+    ASSERT_NO_THROW(cache.refresh(db, pids));
+    EXPECT_EQ(10, cache.find(18700, 211, 2.7).size());
+    EXPECT_EQ( 1, cache.find(18701, 211, 2.7).size());
+}
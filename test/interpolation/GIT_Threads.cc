@@ -0,0 +1,124 @@
+
+#include "GapInterpolationTestBase.hh"
+
+#include <algorithm>
+
+namespace {
+
+std::vector<std::string> sortedUpdates(const TestBroadcaster* bc)
+{
+    std::vector<std::string> updates;
+    for(int i=0; i<bc->count(); ++i) {
+        const kvalobs::kvData& d = bc->update(i);
+        std::ostringstream u;
+        u << d.stationID() << ' ' << d.paramID() << ' ' << kvtime::iso(d.obstime())
+          << ' ' << d.corrected() << ' ' << d.controlinfo().flagstring();
+        updates.push_back(u.str());
+    }
+    std::sort(updates.begin(), updates.end());
+    return updates;
+}
+
+} // anonymous namespace
+
+TEST_F(GapInterpolationTest, Threads)
+{
+    // TA gaps at three neighbors of 18700, and a UU gap at 18700
+    // that depends on their interpolated TA
+    DataList data(4200, 211, 342);
+    data.add("2012-03-25 18:00:00",      10.4,      10.4, "0111000000100010", "")
+        .add("2012-03-25 19:00:00",       9.1,       9.1, "0111000000100010", "")
+        .add("2012-03-25 20:00:00",       8.6,       8.6, "0111000000100010", "")
+        .add("2012-03-25 21:00:00",  -32767.0,  -32767.0, "0000003000000000", "")
+        .add("2012-03-25 22:00:00",       2.9,       2.9, "0111000000100010", "")
+        .add("2012-03-25 23:00:00",       2.0,       2.0, "0111000000100010", "")
+        .add("2012-03-26 00:00:00",       1.6,       1.6, "0111000000100010", "")
+        .add("2012-03-26 01:00:00",       0.1,       0.1, "0111000000100010", "");
+    data.setStation(17150).setType(342)
+        .add("2012-03-25 18:00:00",      10.2,      10.2, "0111000000100010", "")
+        .add("2012-03-25 19:00:00",       9.1,       9.1, "0111000000100010", "")
+        .add("2012-03-25 20:00:00",  -32767.0,  -32767.0, "0000003000000000", "")
+        .add("2012-03-25 21:00:00",       7.4,       7.4, "0111000000100010", "")
+        .add("2012-03-25 22:00:00",       6.8,       6.8, "0111000000100010", "")
+        .add("2012-03-25 23:00:00",       4.8,       4.8, "0111000000100010", "")
+        .add("2012-03-26 00:00:00",       4.1,       4.1, "0111000000100010", "")
+        .add("2012-03-26 01:00:00",       2.4,       2.4, "0111000000100010", "");
+    data.setStation(18700).setType(330)
+        .add("2012-03-25 18:00:00",      11.5,      11.5, "0111000000100010", "")
+        .add("2012-03-25 19:00:00",      10.1,      10.1, "0111000000100010", "")
+        .add("2012-03-25 20:00:00",       7.4,       7.4, "0111000000100010", "")
+        .add("2012-03-25 21:00:00",       6.1,       6.1, "0111000000100010", "")
+        .add("2012-03-25 22:00:00",       5.7,       5.7, "0111000000100010", "")
+        .add("2012-03-25 23:00:00",       5.3,       5.3, "0110000000100010", "")
+        .add("2012-03-26 00:00:00",       4.6,       4.6, "0111000000100010", "")
+        .add("2012-03-26 01:00:00",       4.0,       4.0, "0111000000100010", "");
+    data.setStation(20301).setType(330)
+        .add("2012-03-25 18:00:00",      11.7,      11.7, "0111000000100010", "")
+        .add("2012-03-25 19:00:00",       9.1,       9.1, "0111000000100010", "")
+        .add("2012-03-25 20:00:00",       7.0,       7.0, "0111000000100010", "")
+        .add("2012-03-25 21:00:00",       5.2,       5.2, "0111000000100010", "")
+        .add("2012-03-25 22:00:00",       4.4,       4.4, "0111000000100010", "")
+        .add("2012-03-25 23:00:00",  -32767.0,  -32767.0, "0000003000000000", "")
+        .add("2012-03-26 00:00:00",       3.3,       3.3, "0111000000100010", "")
+        .add("2012-03-26 01:00:00",       2.8,       2.8, "0111000000100010", "");
+    data.setParam(262);
+    data.setStation(4200).setType(342)
+        .add("2012-03-25 18:00:00",      63.0,      63.0, "0101000000000010", "")
+        .add("2012-03-25 19:00:00",      65.0,      65.0, "0101000000000010", "")
+        .add("2012-03-25 20:00:00",      67.0,      67.0, "0101000000000010", "")
+        .add("2012-03-25 21:00:00",      83.0,      83.0, "0101000000000010", "")
+        .add("2012-03-25 22:00:00",      91.0,      91.0, "0101000000000010", "")
+        .add("2012-03-25 23:00:00",      89.0,      89.0, "0101000000000010", "")
+        .add("2012-03-26 00:00:00",      94.0,      94.0, "0101000000000010", "")
+        .add("2012-03-26 01:00:00",      96.0,      96.0, "0101000000000010", "");
+    data.setStation(18700).setType(330)
+        .add("2012-03-25 18:00:00",      53.0,      53.0, "0101000000000010", "")
+        .add("2012-03-25 19:00:00",      57.0,      57.0, "0101000000000010", "")
+        .add("2012-03-25 20:00:00",      69.0,      69.0, "0101000000000010", "")
+        .add("2012-03-25 21:00:00",      74.0,      74.0, "0101000000000010", "")
+        .add("2012-03-25 22:00:00",  -32767.0,  -32767.0, "0000003000000000", "")
+        .add("2012-03-25 23:00:00",      79.0,      79.0, "0100000000000010", "")
+        .add("2012-03-26 00:00:00",      80.0,      80.0, "0101000000000010", "")
+        .add("2012-03-26 01:00:00",      82.0,      82.0, "0101000000000010", "");
+    ASSERT_NO_THROW(data.insert(db));
+    ASSERT_NO_THROW_X(db->exec("CREATE TABLE data_before AS SELECT * FROM data;"));
+
+    std::stringstream config;
+    config << "Start_YYYY = 2012\n"
+           << "Start_MM   =   03\n"
+           << "Start_DD   =   25\n"
+           << "Start_hh   =   18\n"
+           << "End_YYYY   = 2012\n"
+           << "End_MM     =   03\n"
+           << "End_DD     =   26\n"
+           << "End_hh     =   01\n"
+           << "TypeId     =  330\n"
+           << "TypeId     =  342\n"
+           << "Parameter  =  par=211,minPar=213,maxPar=215,offsetCorrectionLimit=15,fluctuationLevel=0.5\n"
+           << "Parameter  =  par=262,minPar=264,maxPar=265,minVal=0,maxVal=100,offsetCorrectionLimit=5,fluctuationLevel=2\n";
+    AlgorithmConfig params;
+    params.Parse(config);
+
+    ASSERT_CONFIGURE(algo, params);
+    logs->clear();
+    bc->clear();
+    ASSERT_NO_THROW_X(algo->run(); algo->flushWrites());
+    const std::vector<std::string> sequential = sortedUpdates(bc);
+    ASSERT_LT(0u, sequential.size());
+    EXPECT_EQ(0, db->connectionsCreated());
+
+    // same data again, now with worker threads reading through their own connections
+    ASSERT_NO_THROW_X(db->exec("DELETE FROM data; INSERT INTO data SELECT * FROM data_before;"));
+    db->setShareConnections(true);
+    std::stringstream configThreads;
+    configThreads << config.str() << "Threads = 4\n";
+    AlgorithmConfig paramsThreads;
+    paramsThreads.Parse(configThreads);
+
+    ASSERT_CONFIGURE(algo, paramsThreads);
+    logs->clear();
+    bc->clear();
+    ASSERT_NO_THROW_X(algo->run(); algo->flushWrites());
+    EXPECT_LE(2, db->connectionsCreated());
+    EXPECT_EQ(sequential, sortedUpdates(bc));
+}
@@ -0,0 +1,260 @@
+/* -*- c++ -*-
+  Kvalobs - Free Quality Control Software for Meteorological Observations
+
+  Copyright (C) 2013 met.no
+
+  Contact information:
+  Norwegian Meteorological Institute
+  Postboks 43 Blindern
+  N-0313 OSLO
+  NORWAY
+  email: kvalobs-dev@met.no
+
+  This file is part of KVALOBS
+
+  KVALOBS is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License as
+  published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  KVALOBS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  General Public License for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with KVALOBS; if not, write to the Free Software Foundation Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <gtest/gtest.h>
+
+#include "helpers/Akima.h"
+#include "helpers/mathutil.h"
+#include "interpolation/MinMaxReconstruction.h"
+#include "interpolation/MinMaxReconstruction.icc"
+
+#include <vector>
+
+using namespace Interpolation;
+
+namespace {
+
+class MemoryMinMaxData : public MinMaxReconstruction::Data {
+public:
+    MemoryMinMaxData(int duration)
+        : mParameter(duration), mMinimum(duration), mMaximum(duration) { }
+
+    virtual int duration()
+        { return mParameter.size(); }
+    virtual float fluctuationLevel()
+        { return 0.5; }
+
+    virtual SupportData parameter(int time)
+        { return mParameter.at(time); }
+
+    virtual SeriesData minimum(int t)
+        { return mMinimum.at(t); }
+    virtual SeriesData maximum(int t)
+        { return mMaximum.at(t); }
+    virtual void setMinimum(int time, Quality q, float value)
+        { mMinimum.at(time) = SeriesData(value, q, q < FAILED); }
+    virtual void setMaximum(int time, Quality q, float value)
+        { mMaximum.at(time) = SeriesData(value, q, q < FAILED); }
+
+    std::vector<SupportData> mParameter;
+    std::vector<SeriesData> mMinimum, mMaximum;
+};
+
+// ------------------------------------------------------------------------
+
+// same data as MemoryMinMaxData, in dense arrays with non-virtual access
+class DenseMinMaxData {
+public:
+    DenseMinMaxData(MemoryMinMaxData& data)
+        : mParameter(data.duration()), mMinimum(data.duration()), mMaximum(data.duration())
+    {
+        for(int t=0; t<data.duration(); ++t) {
+            mParameter.set(t, data.parameter(t));
+            mMinimum.set(t, data.minimum(t));
+            mMaximum.set(t, data.maximum(t));
+        }
+    }
+
+    int duration() const
+        { return mParameter.size(); }
+    float fluctuationLevel() const
+        { return 0.5; }
+
+    SupportData parameter(int time) const
+        { return mParameter.at(time); }
+
+    SeriesData minimum(int t) const
+        { return mMinimum.at(t); }
+    SeriesData maximum(int t) const
+        { return mMaximum.at(t); }
+    void setMinimum(int time, Quality q, float value)
+        { mMinimum.set(time, SeriesData(value, q, q < FAILED)); }
+    void setMaximum(int time, Quality q, float value)
+        { mMaximum.set(time, SeriesData(value, q, q < FAILED)); }
+
+    SupportArrays mParameter;
+    SeriesArrays mMinimum, mMaximum;
+};
+
+// ------------------------------------------------------------------------
+
+// deterministic test series: hourly temperature with a daily cycle,
+// some unusable observations and minimum/maximum missing most of the time
+void makeSeries(MemoryMinMaxData& data)
+{
+    unsigned int seed = 12345;
+    const int duration = data.duration();
+    for(int t=0; t<duration; ++t) {
+        seed = seed*1103515245 + 12345;
+        const float noise = ((seed >> 16) % 100) / 100.0f;
+        const float value = Helpers::round1(5 + 4*std::sin(t*2*M_PI/24) + noise);
+        data.mParameter[t] = SupportData(value, (t % 7) != 3);
+        if( (t % 5) == 0 ) {
+            data.mMinimum[t] = SeriesData(value - 0.3f - noise, OBSERVATION, true);
+            data.mMaximum[t] = SeriesData(value + 0.2f + noise, OBSERVATION, true);
+        } else {
+            data.mMinimum[t] = SeriesData(MISSING_VALUE, MISSING, false);
+            data.mMaximum[t] = SeriesData(MISSING_VALUE, MISSING, false);
+        }
+    }
+}
+
+// ------------------------------------------------------------------------
+
+void referenceFailMinMaxIfNeeded(MinMaxReconstruction::Data& data, int time)
+{
+    if(data.minimum(time).needsInterpolation())
+        data.setMinimum(time, FAILED, MISSING_VALUE);
+    if(data.maximum(time).needsInterpolation())
+        data.setMaximum(time, FAILED, MISSING_VALUE);
+}
+
+// quadratic reference implementation, as MinMaxReconstruction was
+// before it calculated diff_min and diff_max from prefix/suffix minima
+void referenceReconstructMinMax(MinMaxReconstruction::Data& data)
+{
+    const int duration = data.duration();
+
+    Akima akima, akimaMin, akimaMax;
+    for(int t=0; t<duration; ++t) {
+        const SupportData i = data.parameter(t);
+        if( i.usable() )
+            akima.add(t, i.value());
+        const SeriesData smin = data.minimum(t), smax = data.maximum(t);
+        if (smin.usable() and not smin.needsInterpolation())
+            akimaMin.add(t, smin.value());
+        if (smax.usable() and not smax.needsInterpolation())
+            akimaMax.add(t, smax.value());
+    }
+
+    referenceFailMinMaxIfNeeded(data, 0);
+
+    for(int t=1; t<duration; ++t) {
+        const bool minNeeded = data.minimum(t).needsInterpolation();
+        const bool maxNeeded = data.maximum(t).needsInterpolation();
+        if( !minNeeded && !maxNeeded )
+            continue;
+
+        float diff_min = 1.5e6, diff_max = 1.5e6;
+        for(int t_other = 0; t_other < duration; ++t_other) {
+            if( t_other == t )
+                continue;
+            const SupportData d = data.parameter(t_other);
+            if( d.usable() )
+                continue;
+            const SeriesData smin = data.minimum(t_other), smax = data.maximum(t_other);
+            if( !smin.needsInterpolation() )
+                Helpers::minimize(diff_min, d.value() - smin.value());
+            if( !smax.needsInterpolation() )
+                Helpers::minimize(diff_max, smax.value() - d.value());
+        }
+        if( diff_min >= 1e6 )
+            diff_min = 0;
+        if( diff_max >= 1e6 )
+            diff_max = 0;
+
+        const SupportData i0 = data.parameter(t-1), i1 = data.parameter(t);
+        const bool canUseAkima = (akima.distance(t+0.5) < 1.5);
+        if (not (i0.usable() and i1.usable() and canUseAkima)) {
+            referenceFailMinMaxIfNeeded(data, t);
+            continue;
+        }
+
+        float mini = std::min(i0.value(), i1.value());
+        float maxi = std::max(i0.value(), i1.value());
+        if (data.minimum(t).quality() == DISCARDED)
+            Helpers::minimize(mini, data.minimum(t).original());
+        if (data.maximum(t).quality() == DISCARDED)
+            Helpers::maximize(maxi, data.maximum(t).original());
+
+        const int Nbetween = 20;
+        for(int j=1; j<Nbetween; ++j) {
+            const float x = t-1 + j/float(Nbetween);
+            const float value = akima.interpolate(x);
+            Helpers::minimize(mini, value-diff_min);
+            Helpers::maximize(maxi, value+diff_max);
+        }
+        if( akimaMin.distance(t) < 1.5 )
+            Helpers::minimize(mini, static_cast<float>(akimaMin.interpolate(t)));
+        if( akimaMax.distance(t) < 1.5 )
+            Helpers::maximize(maxi, static_cast<float>(akimaMax.interpolate(t)));
+        if( minNeeded )
+            data.setMinimum(t, BAD, mini);
+        if( maxNeeded )
+            data.setMaximum(t, BAD, maxi);
+    }
+}
+
+} // anonymous namespace
+
+// ------------------------------------------------------------------------
+
+TEST(MinMaxReconstructionTest, LongGapSameAsReference)
+{
+    const int duration = 30*24 + 1;
+    MemoryMinMaxData data(duration), reference(duration);
+    makeSeries(data);
+    makeSeries(reference);
+
+    referenceReconstructMinMax(reference);
+
+    MinMaxReconstruction mmr;
+    const Summary s = mmr.run(data);
+
+    EXPECT_LT(0, s.nOk());
+    for(int t=0; t<duration; ++t) {
+        ASSERT_EQ(reference.mMinimum[t].quality(), data.mMinimum[t].quality()) << "t=" << t;
+        ASSERT_EQ(reference.mMinimum[t].original(), data.mMinimum[t].original()) << "t=" << t;
+        ASSERT_EQ(reference.mMaximum[t].quality(), data.mMaximum[t].quality()) << "t=" << t;
+        ASSERT_EQ(reference.mMaximum[t].original(), data.mMaximum[t].original()) << "t=" << t;
+    }
+}
+
+// ------------------------------------------------------------------------
+
+TEST(MinMaxReconstructionTest, DirectSameAsVirtual)
+{
+    const int duration = 30*24 + 1;
+    MemoryMinMaxData data(duration);
+    makeSeries(data);
+    DenseMinMaxData dense(data);
+
+    MinMaxReconstruction mmr;
+    const Summary s = mmr.run(data);
+    const Summary sd = mmr.runDirect(dense);
+
+    EXPECT_EQ(s.nOk(), sd.nOk());
+    EXPECT_EQ(s.nFailed(), sd.nFailed());
+    for(int t=0; t<duration; ++t) {
+        ASSERT_EQ(data.mMinimum[t].quality(), dense.minimum(t).quality()) << "t=" << t;
+        ASSERT_EQ(data.mMinimum[t].original(), dense.minimum(t).original()) << "t=" << t;
+        ASSERT_EQ(data.mMaximum[t].quality(), dense.maximum(t).quality()) << "t=" << t;
+        ASSERT_EQ(data.mMaximum[t].original(), dense.maximum(t).original()) << "t=" << t;
+    }
+}